@@ -15,7 +15,7 @@ echo -e "\nTesting Disastros...\n"
 
 echo -e "Ran with $cores cores $quantum for quantum\n" >>"$output_file"
 
-time {
+{
     # Crea un array per salvare i file temporanei per ogni scheduler
     declare -a temp_files
 
@@ -29,8 +29,11 @@ time {
         {
             echo -e "Scheduler: $N" > "$temp_output"
 
-            # Esegui il programma e stampa le statistiche temporali (real, user, sys) nel terminale e nel file
-            { time ./disastros "$cores" "$N" "$quantum" traces | grep "Total\|Turnaround\|Waiting\|Response\|Throughput\|CPU Used" | sed 's/\x1B\[[0-9;]*m//g'; } 2>&1 >> "$temp_output"
+            # Esegui il programma con l'output strutturato
+            # le statistiche vengono lette dal csv invece di filtrare il testo colorato
+            ./disastros --quiet --format csv --output "$temp_output.csv" "$cores" "$N" "$quantum" traces > /dev/null
+            grep "^statistics,\(total_time\|throughput\|cpu_used\|turnaround\.mean\|waiting\.mean\|response\.mean\)," "$temp_output.csv" >> "$temp_output"
+            rm -f "$temp_output.csv" "$temp_output.csv.processes.csv"
             echo -e "Scheduler: $N\n"
             # Stampa un separatore nel terminale e nel file temporaneo
             echo -e "" >> "$temp_output"
@@ -48,10 +51,27 @@ time {
     done
 
 }
-echo -e "Total Time\n"
+
+# Le prestazioni vengono misurate dal macro-benchmark e confrontate con la baseline della macchina
+# di riferimento, che non e' nel repository: crearla su quella macchina con
+# ./scheduler/bench/macro_bench --save scheduler/bench/baseline.txt
+# Una regressione fa fallire lo script, dopo la pulizia
+baseline="scheduler/bench/baseline.txt"
+bench_status=0
+make macrobench
+echo -e "\nBenchmarking Disastros...\n"
+if [ ! -f "$baseline" ]; then
+    echo -e "No $baseline on this host, benchmark not compared (create it with macro_bench --save $baseline)"
+    ./scheduler/bench/macro_bench
+elif ! ./scheduler/bench/macro_bench --baseline "$baseline"; then
+    echo -e "\nPerformance regression against $baseline"
+    bench_status=1
+fi
+make bench_clean
 
 # Cancella i file oggetto e l'eseguibile
 make clean
 
 # Stampa un messaggio di completamento
 echo -e "\nDone. Output stored in $output_file.\n"
+exit $bench_status
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <stdint.h>
+
+// xoshiro256** generator, every process gets its own stream derived from (seed, stream id)
+// so the generated trace doesn't depend on the order (or the thread) the processes are made in
+typedef struct {
+    uint64_t s[4];
+} Rng;
+
+void Rng_seed(Rng *rng, uint64_t seed, uint64_t stream);
+uint64_t Rng_next(Rng *rng);
+double Rng_uniform(Rng *rng);
+int Rng_range(Rng *rng, int n);
@@ -1,6 +1,10 @@
 #pragma once
 
+#include <stdint.h>
+
 #include "linked_list.h"
+#include "rng.h"
+#include "trace_stream.h"
 
 typedef enum processPriority
 {
@@ -15,16 +19,25 @@ typedef enum processPriority
 
 
 typedef struct {
-    int burst_time; 
+    int64_t burst_time;     // ns
     float probability;
 } BurstDist;
 
+// Walker/Vose alias table: draws an index of the histogram in O(1)
+typedef struct {
+    int size;
+    float *prob;    // probability of keeping the column instead of jumping to its alias
+    int *alias;     // alias index of each column
+} AliasTable;
+
 typedef struct {
     ListItem list;
     int cpu_size;
     int io_size;
     BurstDist *cpu_hist;
     BurstDist *io_hist;
+    AliasTable cpu_alias;
+    AliasTable io_alias;
     char *source_type;
 } BurstProfile;
 
@@ -32,10 +45,21 @@ typedef struct {
     int num_processes;
     const char *histogram_folder;
     int burst_per_process;
+    uint64_t seed;
     ListHead burst_profiles;
+    BurstProfile **profiles;   // burst_profiles sorted by source type, for O(1) random access
 } TraceGen;
 
-void TraceGen_init(TraceGen *tg, int num_processes, int burst_per_process, const char *histogram_folder);
-void createEventProc(BurstProfile *bf, int proc_id, int bursts_per_process, const char *dest_folder);
+void TraceGen_init(TraceGen *tg, int num_processes, int burst_per_process, const char *histogram_folder, uint64_t seed);
+void TraceGen_loadHistograms(TraceGen *tg);
+void TraceGen_writeTraces(TraceGen *tg, const char *dest_folder, int num_threads);
+void TraceGen_destroy(TraceGen *tg);
+void TraceGen_generateProc(TraceGen *tg, int proc_id, TraceProc *proc);
+void createEventProc(TraceGen *tg, int proc_id, const char *dest_folder);
 BurstProfile *BurstProfile_loadHistogram(const char *filename);
-int getBurstDuration(BurstDist *hist, int size, int num_samples);
\ No newline at end of file
+void BurstProfile_destroy(BurstProfile *bf);
+void AliasTable_build(AliasTable *at, BurstDist *hist, int size);
+void AliasTable_destroy(AliasTable *at);
+int AliasTable_sample(AliasTable *at, Rng *rng);
+int64_t getBurstDuration(BurstDist *hist, AliasTable *at, Rng *rng);
+void getBurstDurations(BurstDist *hist, AliasTable *at, Rng *rng, int64_t *bursts, int num_samples);
\ No newline at end of file
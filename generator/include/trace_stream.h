@@ -0,0 +1,65 @@
+#pragma once
+
+#include <stdint.h>
+
+// This header doesn't depend on the generator list types, so the simulator
+// can include it next to its own linked_list.h
+
+#define ARRIVAL_WINDOW 100 // arrivals of a window of processes are spread on this many ms
+#define NS_PER_MS 1000000LL
+
+// The times of the traces and of the histograms are in ns. In the text files a time is a number
+// with an optional unit, ns, us, ms or s, e.g. 250us or 1.5ms; without the unit it is in ms,
+// as in the first traces, and the writers only add the unit to the times of a fraction of a ms
+
+typedef enum {
+    TRACE_CPU = 0,
+    TRACE_IO = 1
+} TraceBurstType;
+
+typedef struct {
+    TraceBurstType type;
+    int64_t duration;   // ns
+} TraceBurst;
+
+// A generated process, the in-memory equivalent of a trace file
+typedef struct {
+    int proc_id;
+    int priority;
+    int64_t arrival;    // ns
+    const char *source_type;   // owned by the profile, valid until the stream is closed
+    int num_bursts;
+    TraceBurst *bursts;
+} TraceProc;
+
+typedef struct TraceStream TraceStream;
+
+// Histograms loaded once and shared (read only) by many streams, e.g. one per thread
+typedef struct TraceHistograms TraceHistograms;
+
+// Everything needed to reopen a stream where it was: the generation parameters and the position
+typedef struct {
+    const char *histogram_folder;
+    int num_processes;
+    int burst_per_process;
+    uint64_t seed;
+    int window_procs;
+    int window;
+    int pos;
+} TraceStreamState;
+
+TraceHistograms *TraceHistograms_load(const char *histogram_folder);
+void TraceHistograms_destroy(TraceHistograms *th);
+
+TraceStream *TraceStream_open(const char *histogram_folder, int num_processes, int burst_per_process,
+                              uint64_t seed, int window_procs);
+TraceStream *TraceStream_openShared(const TraceHistograms *th, int num_processes, int burst_per_process,
+                                    uint64_t seed, int window_procs);
+int64_t TraceStream_peekArrival(TraceStream *ts);
+TraceProc *TraceStream_next(TraceStream *ts);
+void TraceStream_close(TraceStream *ts);
+void TraceStream_getState(TraceStream *ts, TraceStreamState *state);
+TraceStream *TraceStream_restore(const TraceStreamState *state);
+
+int64_t TraceTime_parse(const char *str, char **end);
+int TraceTime_format(char *buf, int size, int64_t ns);
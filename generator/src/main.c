@@ -4,40 +4,64 @@
 #include <assert.h>
 #include <dirent.h>
 #include <time.h>
+#include <getopt.h>
+#include <unistd.h>
 #include <sys/stat.h>
 
 #include "../include/trace_generator.h"
 
-char usage_buffer[1024] = "Usage: %s <num_process> <num_burst_per_process> <histogram_folder> <dest_folder> \n\
+char usage_buffer[1024] = "Usage: %s [--seed <seed>] [--threads <num_threads>] <num_process> <num_burst_per_process> <histogram_folder> <dest_folder> \n\
 \n\
 <num_process>: Number of processes to create and simulate. \n\
 <burst_per_process>: Number of burst per process. \n\
 <histogram_folder>: The path to the folder containing the histogram data. \n\
 <dest_folder>: The path to the folder where the traces will be saved. NOTE! all the files in the folder will be deleted. if the folder does not exist it will be created. \n\
+--seed <seed>: Seed of the generation, the same seed gives the same traces. Default: current time. \n\
+--threads <num_threads>: Number of threads generating the traces. Default: number of online cpus. \n\
 \n";
 
 
 int main(int argc, char **argv)
 {
     TraceGen        tg;
-    DIR             *dir;
-    struct dirent   *ent;
+    int             opt;
+    uint64_t        seed = (uint64_t)time(NULL);
+    long            num_threads = sysconf(_SC_NPROCESSORS_ONLN);
 
+    static struct option long_options[] = {
+        {"seed", required_argument, 0, 's'},
+        {"threads", required_argument, 0, 't'},
+        {0, 0, 0, 0}
+    };
 
-    if (argc != 5)
+    while ((opt = getopt_long(argc, argv, "s:t:", long_options, NULL)) != -1)
+    {
+        switch (opt)
+        {
+        case 's':
+            seed = strtoull(optarg, NULL, 10);
+            break;
+        case 't':
+            num_threads = atoi(optarg);
+            break;
+        default:
+            printf(usage_buffer, argv[0]);
+            return 1;
+        }
+    }
+
+    if (argc - optind != 4)
     {
         printf(usage_buffer, argv[0]);
         return 1;
     }
 
-    srand(time(NULL));
+    int num_processes = atoi(argv[optind]);
+    int burst_per_process = atoi(argv[optind + 1]);
+    const char *histogram_folder = argv[optind + 2];
+    const char *dest_folder = argv[optind + 3];
 
-    int num_processes = atoi(argv[1]);
-    int burst_per_process = atoi(argv[2]);
-    const char *histogram_folder = argv[3];
-    const char *dest_folder = argv[4];
-
-    if (num_processes < 1 || burst_per_process < 1)
+    if (num_processes < 1 || burst_per_process < 1 || num_threads < 1)
     {
         printf(usage_buffer, argv[0]);
         return 1;
@@ -48,52 +72,39 @@ int main(int argc, char **argv)
     if (stat(dest_folder, &st) == -1)
     {
         mkdir(dest_folder, 0700);
-    } 
+    }
     // Delete all the files in the folder
     else
     {
-        char cmd[256];
-        sprintf(cmd, "rm -f %s/*", dest_folder);
-        system(cmd);
-    }
-
-    TraceGen_init(&tg, num_processes, burst_per_process, histogram_folder);
+        DIR *dir;
+        struct dirent *ent;
 
-    // Open the histogram folder and load the histograms into the burst_profiles list
-    if ((dir = opendir(histogram_folder)) == NULL)
-        assert(0 && "Could not open histogram folder");
-
-    while ((ent = readdir(dir)) != NULL)
-    {
-        if (ent->d_type == DT_REG)
+        if ((dir = opendir(dest_folder)) == NULL)
+            assert(0 && "Could not open destination folder");
+        while ((ent = readdir(dir)) != NULL)
         {
-            char filename[256];
-            sprintf(filename, "%s/%s", histogram_folder, ent->d_name);
-            BurstProfile *bf = BurstProfile_loadHistogram(filename);
-            List_pushBack(&tg.burst_profiles, &bf->list);
+            if (ent->d_type == DT_REG)
+            {
+                char filename[512];
+                snprintf(filename, sizeof(filename), "%s/%s", dest_folder, ent->d_name);
+                unlink(filename);
+            }
         }
+        closedir(dir);
     }
-    closedir(dir);
 
-    // Create the processes events based on the loaded histograms 
+    TraceGen_init(&tg, num_processes, burst_per_process, histogram_folder, seed);
+
+    // Load the histograms into the burst_profiles list
+    TraceGen_loadHistograms(&tg);
+
+    // Create the processes events based on the loaded histograms
     // and save them in a file
-    for (int i = 0; i < num_processes; i++)
-    {
-        int profile_index = rand() % tg.burst_profiles.size;
-        BurstProfile *bf = (BurstProfile *)List_getAt(&tg.burst_profiles, profile_index);
-        createEventProc(bf, i, burst_per_process, dest_folder);
-    }
+    printf("Generating %d processes with seed %llu on %ld threads\n", num_processes, (unsigned long long)seed, num_threads);
+    TraceGen_writeTraces(&tg, dest_folder, num_threads);
 
     // Free the memory allocated for the histograms
-    ListItem *aux;
-    while ((aux = List_popFront(&tg.burst_profiles)) != NULL)
-    {
-        BurstProfile *bf = (BurstProfile *)aux;
-        free(bf->cpu_hist);
-        free(bf->io_hist);
-        free(bf->source_type);
-        free(bf);
-    }
+    TraceGen_destroy(&tg);
 
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,86 @@
+#include <assert.h>
+
+#include "../include/rng.h"
+
+/**
+ * @brief splitmix64 step, used to expand a seed into the xoshiro state
+ *
+ * @param x state of the splitmix generator, advanced by the call
+ * @return uint64_t
+ */
+static uint64_t splitmix64(uint64_t *x)
+{
+    uint64_t z = (*x += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static inline uint64_t rotl(const uint64_t x, int k)
+{
+    return (x << k) | (x >> (64 - k));
+}
+
+/**
+ * @brief Seed an independent stream: the stream id is hashed together with the seed,
+ *        so close ids (consecutive pids) still get uncorrelated states
+ *
+ * @param rng generator to seed
+ * @param seed global seed of the run
+ * @param stream id of the stream (the process id)
+ */
+void Rng_seed(Rng *rng, uint64_t seed, uint64_t stream)
+{
+    uint64_t x = seed;
+    uint64_t y = stream;
+
+    x = splitmix64(&x) ^ splitmix64(&y);
+    for (int i = 0; i < 4; i++)
+        rng->s[i] = splitmix64(&x);
+}
+
+/**
+ * @brief Next 64 random bits of the stream
+ *
+ * @param rng
+ * @return uint64_t
+ */
+uint64_t Rng_next(Rng *rng)
+{
+    uint64_t *s = rng->s;
+    const uint64_t result = rotl(s[1] * 5, 7) * 9;
+    const uint64_t t = s[1] << 17;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 45);
+
+    return result;
+}
+
+/**
+ * @brief Uniform double in [0, 1) built from the top 53 bits
+ *
+ * @param rng
+ * @return double
+ */
+double Rng_uniform(Rng *rng)
+{
+    return (Rng_next(rng) >> 11) * 0x1.0p-53;
+}
+
+/**
+ * @brief Uniform integer in [0, n)
+ *
+ * @param rng
+ * @param n upper bound (excluded)
+ * @return int
+ */
+int Rng_range(Rng *rng, int n)
+{
+    assert(n > 0 && "empty range");
+    return (int)(((Rng_next(rng) >> 32) * (uint64_t)n) >> 32);
+}
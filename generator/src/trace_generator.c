@@ -5,150 +5,271 @@
 #include <dirent.h>
 #include <time.h>
 #include <sys/stat.h>
+#include <pthread.h>
 
 #include "../include/trace_generator.h"
 
 /**
- * @brief Normalize the probabilities of the histogram
+ * @brief Build the Walker/Vose alias table of a histogram, so that every later draw costs O(1).
+ *        The probabilities don't need to sum to 1, they are normalized here once.
  *
- * @param probabilities array of probabilities generated by the histogram
+ * @param at alias table to fill
+ * @param hist array of burst histograms
  * @param size size of the array
  */
-void normalize(float *probabilities, int size)
+void AliasTable_build(AliasTable *at, BurstDist *hist, int size)
 {
-	float sum = 0.0;
-	for (int i = 0; i < size; i++)
-	{
-		sum += probabilities[i];
-	}
-	for (int i = 0; i < size; i++)
-	{
-		probabilities[i] /= sum;
-	}
+    assert(size > 0 && "empty histogram");
+
+    double sum = 0.0;
+    double scaled[size];
+    int small[size], large[size];
+    int num_small = 0, num_large = 0;
+
+    at->size = size;
+    if ((at->prob = (float *)malloc(size * sizeof(float))) == NULL)
+        assert(0 && "malloc failed");
+    if ((at->alias = (int *)malloc(size * sizeof(int))) == NULL)
+        assert(0 && "malloc failed");
+
+    for (int i = 0; i < size; i++)
+        sum += hist[i].probability;
+    assert(sum > 0 && "histogram without probability mass");
+
+    // Scale the probabilities so that the average column height is 1
+    // and split the columns in the ones under and over the average
+    for (int i = 0; i < size; i++)
+    {
+        scaled[i] = hist[i].probability * size / sum;
+        if (scaled[i] < 1.0)
+            small[num_small++] = i;
+        else
+            large[num_large++] = i;
+    }
+
+    // Fill every small column with the excess of a large one
+    while (num_small > 0 && num_large > 0)
+    {
+        int s = small[--num_small];
+        int l = large[--num_large];
+
+        at->prob[s] = scaled[s];
+        at->alias[s] = l;
+
+        scaled[l] = (scaled[l] + scaled[s]) - 1.0;
+        if (scaled[l] < 1.0)
+            small[num_small++] = l;
+        else
+            large[num_large++] = l;
+    }
+
+    // The remaining columns are full (the small ones only because of rounding errors)
+    while (num_large > 0)
+    {
+        int l = large[--num_large];
+        at->prob[l] = 1.0;
+        at->alias[l] = l;
+    }
+    while (num_small > 0)
+    {
+        int s = small[--num_small];
+        at->prob[s] = 1.0;
+        at->alias[s] = s;
+    }
 }
 
 /**
- * @brief uniform sampling algorithm which generates num_desired_samples samples and stores them in sampled_indices
- *        depending on the probabilities of the histogram
+ * @brief Free the memory of an alias table
  *
- * @param sampled_indices array to store the sampled indices
- * @param probabilities array of probabilities generated by the histogram
- * @param num_probabilities number of probabilities in the array
- * @param num_desired_samples number of samples to generate
+ * @param at alias table to destroy
  */
-void uniformSample(int *sampled_indices, float *probabilities, int num_probabilities, int num_desired_samples)
+void AliasTable_destroy(AliasTable *at)
 {
-	// Normalizzazione delle probabilità
-	normalize(probabilities, num_probabilities);
-
-	// Passo per le y(i)
-	float step = 1.0 / num_desired_samples;
-
-	// Seleziona un valore y(0) casuale tra 0 e 1/num_desired_samples
-	float y0 = (float)rand() / RAND_MAX * step;
-	float yi = y0;
+    free(at->prob);
+    free(at->alias);
+    at->prob = 0;
+    at->alias = 0;
+    at->size = 0;
+}
 
-	// Variabili cumulative
-	float cumulative = 0.0;
-	int sample_index = 0;
+/**
+ * @brief Draw an index of the histogram with two random numbers: one picks the column,
+ *        the other decides between the column and its alias
+ *
+ * @param at alias table of the histogram
+ * @param rng random stream to draw from
+ * @return int the sampled index
+ */
+int AliasTable_sample(AliasTable *at, Rng *rng)
+{
+    int column = Rng_range(rng, at->size);
+    double coin = Rng_uniform(rng);
 
-	// Esegui il campionamento
-	for (int prob_index = 0; prob_index < num_probabilities; prob_index++)
-	{
-		cumulative += probabilities[prob_index];
+    return (coin < at->prob[column]) ? column : at->alias[column];
+}
 
-		// Riempie con l'indice della probabilità corrente
-		while (cumulative > yi && sample_index < num_desired_samples)
-		{
-			sampled_indices[sample_index] = prob_index;
-			sample_index++;
-			yi += step;
-		}
-	}
+/**
+ * @brief get a burst (CPU or I/O) duration sampling the histogram through its alias table
+ *
+ * @param hist array of burst histograms
+ * @param at alias table built on hist
+ * @param rng random stream to draw from
+ * @return int64_t the duration in ns
+ */
+int64_t getBurstDuration(BurstDist *hist, AliasTable *at, Rng *rng)
+{
+	return hist[AliasTable_sample(at, rng)].burst_time;
 }
 
 /**
- * @brief get a burst (CPU or I/O) duration based on uniform sampling
+ * @brief fill an array with num_samples burst durations sampled from the same histogram
  *
  * @param hist array of burst histograms
- * @param size size of the array
+ * @param at alias table built on hist
+ * @param rng random stream to draw from
+ * @param bursts array to store the burst durations
  * @param num_samples number of samples to generate
- * @return int
  */
-int getBurstDuration(BurstDist *hist, int size, int num_samples)
+void getBurstDurations(BurstDist *hist, AliasTable *at, Rng *rng, int64_t *bursts, int num_samples)
 {
-	int sampled_index[num_samples];
-	float probabilities[size];
-
-	// Copy probabilities into the probabilities array
-	for (int i = 0; i < size; i++)
-	{
-		probabilities[i] = hist[i].probability;
-	}
-
-	// Apply the uniform sampling algorithm and save the indices in sampled_index
-	uniformSample(sampled_index, probabilities, size, num_samples);
-
-	// Return the burst duration corresponding to the first sample
-	return hist[sampled_index[0]].burst_time;
+	for (int i = 0; i < num_samples; i++)
+		bursts[i] = hist[AliasTable_sample(at, rng)].burst_time;
 }
 
 /**
- * @brief Create a process and put it in the list of processes to be created
+ * @brief Generate a process in memory. Every random choice comes from the stream of (tg->seed, proc_id),
+ *        so the process only depends on the seed and on the process id
  *
- * @param os The fake OS instance
- * @param proc_num The process number to create
+ * @param tg The TraceGen instance with the loaded histograms
+ * @param proc_id The process number to create
+ * @param proc The process to fill, proc->bursts must have room for tg->burst_per_process bursts
  */
-void createEventProc(BurstProfile *bf, int proc_id, int bursts_per_process, const char *dest_folder)
+void TraceGen_generateProc(TraceGen *tg, int proc_id, TraceProc *proc)
 {
-    // create file for the process events
-    char filename[256], burst_type[8];
-    FILE *file;
-    int burst_time, priority, arrival;
-
-    
-    sprintf(filename, "%s/process_%d.txt", dest_folder, proc_id);
-    if((file = fopen(filename, "w")) == NULL)
-        assert(file && "Could not open file");
-
-
-    // write the process id to the file and the number of bursts
-    priority = rand() % MAX_PRIORITY;
-    arrival = rand() % 100;
-    if (fprintf(file, "# Proc: %-3d Burst_num: %-3d From: %s\n", proc_id, bursts_per_process, bf->source_type) < 0)
-        assert(0 && "fprintf failed");
+    BurstProfile *bf;
+    Rng rng;
 
-    if (fprintf(file, "Priority %d\nArrival %d\n", priority, arrival) < 0)
-        assert(0 && "fprintf failed");
+    Rng_seed(&rng, tg->seed, proc_id);
 
+    bf = tg->profiles[Rng_range(&rng, tg->burst_profiles.size)];
+    proc->proc_id = proc_id;
+    proc->priority = Rng_range(&rng, MAX_PRIORITY);
+    proc->arrival = Rng_range(&rng, ARRIVAL_WINDOW) * NS_PER_MS;
+    proc->source_type = bf->source_type;
+    proc->num_bursts = tg->burst_per_process;
 
 	// Create a number of bursts for the process based on the number of bursts per process
 	// and the histograms for CPU and I/O burst
 	// The process will have alternating CPU and I/O bursts
-	for (int i = 0; i < bursts_per_process; i++)
+	for (int i = 0; i < tg->burst_per_process; i++)
 	{
 		// Generate a random number to decide if the next burst is a CPU or I/O burst
-		double random_val = (double)rand() / RAND_MAX;
+		double random_val = Rng_uniform(&rng);
 
 		if (random_val < 0.5)
 		{
 			// Generate a random burst duration based on the CPU burst histogram
-            burst_time = getBurstDuration(bf->cpu_hist, bf->cpu_size, 1);
-            strcpy(burst_type, "CPU");
+            proc->bursts[i].type = TRACE_CPU;
+            proc->bursts[i].duration = getBurstDuration(bf->cpu_hist, &bf->cpu_alias, &rng);
 		} else {
 			// Generate a random burst duration based on the I/O burst histogram
-            burst_time = getBurstDuration(bf->io_hist, bf->io_size, 1);
-            strcpy(burst_type, "IO");
+            proc->bursts[i].type = TRACE_IO;
+            proc->bursts[i].duration = getBurstDuration(bf->io_hist, &bf->io_alias, &rng);
 		}
+	}
+}
+
+/**
+ * @brief Generate the events of a process and save them in dest_folder/process_<proc_id>.txt
+ *
+ * @param tg The TraceGen instance with the loaded histograms
+ * @param proc_id The process number to create
+ * @param dest_folder The folder where the trace is saved
+ */
+void createEventProc(TraceGen *tg, int proc_id, const char *dest_folder)
+{
+    // create file for the process events
+    char filename[256];
+    char time[32];
+    FILE *file;
+    TraceBurst bursts[tg->burst_per_process];
+    TraceProc proc = { .bursts = bursts };
+
+    TraceGen_generateProc(tg, proc_id, &proc);
+
+    sprintf(filename, "%s/process_%d.txt", dest_folder, proc_id);
+    if((file = fopen(filename, "w")) == NULL)
+        assert(file && "Could not open file");
+
+    // write the process id to the file and the number of bursts
+    if (fprintf(file, "# Proc: %-3d Burst_num: %-3d From: %s\n", proc_id, proc.num_bursts, proc.source_type) < 0)
+        assert(0 && "fprintf failed");
+
+    TraceTime_format(time, sizeof(time), proc.arrival);
+    if (fprintf(file, "Priority %d\nArrival %s\n", proc.priority, time) < 0)
+        assert(0 && "fprintf failed");
+
+    for (int i = 0; i < proc.num_bursts; i++)
+    {
         // Write the event to the file
-        if ((fprintf(file, "%-3s %4d\n", burst_type, burst_time)) < 0)
+        TraceTime_format(time, sizeof(time), bursts[i].duration);
+        if ((fprintf(file, "%-3s %4s\n", (bursts[i].type == TRACE_CPU) ? "CPU" : "IO", time)) < 0)
             assert(0 && "fprintf failed");
-	}
+    }
     
     fclose(file);
     return;
 }
 
+typedef struct {
+    TraceGen *tg;
+    const char *dest_folder;
+    int next_proc;      // next process id to hand out, shared by the workers
+} TraceWork;
+
+// processes taken by a worker at a time, big enough to keep the shared counter cold
+#define TRACE_CHUNK 64
+
+static void *traceWorker(void *arg)
+{
+    TraceWork *work = (TraceWork *)arg;
+    int start;
+
+    while ((start = __atomic_fetch_add(&work->next_proc, TRACE_CHUNK, __ATOMIC_RELAXED)) < work->tg->num_processes)
+    {
+        int end = start + TRACE_CHUNK;
+        if (end > work->tg->num_processes)
+            end = work->tg->num_processes;
+        for (int i = start; i < end; i++)
+            createEventProc(work->tg, i, work->dest_folder);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Generate the traces of all the processes on a pool of num_threads workers.
+ *        The output is the same for any number of threads, since every process has its own random stream
+ *
+ * @param tg The TraceGen instance with the loaded histograms
+ * @param dest_folder The folder where the traces are saved
+ * @param num_threads Number of worker threads
+ */
+void TraceGen_writeTraces(TraceGen *tg, const char *dest_folder, int num_threads)
+{
+    TraceWork work = { tg, dest_folder, 0 };
+    pthread_t threads[num_threads];
+
+    assert(tg->profiles && "histograms not loaded");
+
+    for (int i = 0; i < num_threads; i++)
+    {
+        if (pthread_create(&threads[i], NULL, traceWorker, &work) != 0)
+            assert(0 && "pthread_create failed");
+    }
+    for (int i = 0; i < num_threads; i++)
+        pthread_join(threads[i], NULL);
+}
+
 /**
  * @brief Initialize the TraceGen structure
  *
@@ -156,17 +277,77 @@ void createEventProc(BurstProfile *bf, int proc_id, int bursts_per_process, cons
  * @param num_processes Number of processes to create
  * @param burst_per_process Number of burst per process
  * @param histogram_folder The path to the folder containing the histogram data
+ * @param seed The seed all the process streams are derived from
  */
-void TraceGen_init(TraceGen *tg, int num_processes, int burst_per_process, const char *histogram_folder)
+void TraceGen_init(TraceGen *tg, int num_processes, int burst_per_process, const char *histogram_folder, uint64_t seed)
 {
     tg->num_processes = num_processes;
     tg->histogram_folder = histogram_folder;
     tg->burst_per_process = burst_per_process;
+    tg->seed = seed;
+    tg->profiles = NULL;
     List_init(&tg->burst_profiles);
 
     return;
 }
 
+static int cmpProfile(ListItem *a, ListItem *b)
+{
+    return strcmp(((BurstProfile *)a)->source_type, ((BurstProfile *)b)->source_type);
+}
+
+/**
+ * @brief Load all the histograms of tg->histogram_folder in the burst_profiles list.
+ *        The profiles are sorted by name, so the same seed picks the same profile
+ *        whatever order the directory is read in
+ *
+ * @param tg The TraceGen structure
+ */
+void TraceGen_loadHistograms(TraceGen *tg)
+{
+    DIR *dir;
+    struct dirent *ent;
+
+    if ((dir = opendir(tg->histogram_folder)) == NULL)
+        assert(0 && "Could not open histogram folder");
+
+    while ((ent = readdir(dir)) != NULL)
+    {
+        if (ent->d_type == DT_REG)
+        {
+            char filename[512];
+            snprintf(filename, sizeof(filename), "%s/%s", tg->histogram_folder, ent->d_name);
+            BurstProfile *bf = BurstProfile_loadHistogram(filename);
+            List_pushBack(&tg->burst_profiles, &bf->list);
+        }
+    }
+    closedir(dir);
+
+    assert(tg->burst_profiles.size > 0 && "no histogram found");
+    List_sort(&tg->burst_profiles, cmpProfile);
+
+    if ((tg->profiles = (BurstProfile **)malloc(tg->burst_profiles.size * sizeof(BurstProfile *))) == NULL)
+        assert(0 && "malloc failed");
+
+    int i = 0;
+    for (ListItem *aux = tg->burst_profiles.first; aux; aux = aux->next)
+        tg->profiles[i++] = (BurstProfile *)aux;
+}
+
+/**
+ * @brief Free the histograms loaded by TraceGen_loadHistograms
+ *
+ * @param tg The TraceGen structure
+ */
+void TraceGen_destroy(TraceGen *tg)
+{
+    ListItem *aux;
+    while ((aux = List_popFront(&tg->burst_profiles)) != NULL)
+        BurstProfile_destroy((BurstProfile *)aux);
+    free(tg->profiles);
+    tg->profiles = NULL;
+}
+
 /**
  * @brief Load a histogram from a file
  *
@@ -210,9 +391,10 @@ BurstProfile *BurstProfile_loadHistogram(const char *filename)
         }
 
         // Parse burst time and probability
-        int burst_time;
+        char *rest;
+        int64_t burst_time = TraceTime_parse(line, &rest);
         double probability;
-        if (sscanf(line, "%d %lf", &burst_time, &probability) == 2 || sscanf(line, "%d,%lf", &burst_time, &probability) == 2)
+        if (burst_time >= 0 && (sscanf(rest, " %lf", &probability) == 1 || sscanf(rest, ",%lf", &probability) == 1))
 		{
             if (is_cpu)
 			{
@@ -234,6 +416,7 @@ BurstProfile *BurstProfile_loadHistogram(const char *filename)
     // Allocate memory for the BurstProfile
     if ((bf = (BurstProfile *)malloc(sizeof(BurstProfile))) == NULL)
         assert(0 && "malloc failed");
+    bf->list.next = bf->list.prev = 0;
     if ((bf->cpu_hist = (BurstDist *)malloc(cpu_count * sizeof(BurstDist))) == NULL)
         assert(0 && "malloc failed");
     if ((bf->io_hist = (BurstDist *)malloc(io_count * sizeof(BurstDist))) == NULL)
@@ -245,16 +428,35 @@ BurstProfile *BurstProfile_loadHistogram(const char *filename)
 	bf->cpu_size = cpu_count;
 	bf->io_size = io_count;
 
+    // Precompute the alias tables used to draw the bursts
+    AliasTable_build(&bf->cpu_alias, bf->cpu_hist, cpu_count);
+    AliasTable_build(&bf->io_alias, bf->io_hist, io_count);
+
     // Save the source type of the histogram without extension
-    char *source_type = strrchr(filename, '/');
-    source_type = (source_type == NULL) ? (char *)filename : source_type + 1; // ignore the last '/'
+    const char *source_type = strrchr(filename, '/');
+    source_type = (source_type == NULL) ? filename : source_type + 1; // ignore the last '/'
 
-    char *ext = strrchr(source_type, '.');
+    // Truncate the extension on the copy, the caller's filename stays untouched
+    bf->source_type = strdup(source_type);
+    char *ext = strrchr(bf->source_type, '.');
     if (ext != NULL) {
-        *ext = '\0';  // Truncate the extension
+        *ext = '\0';
     }
 
-    bf->source_type = strdup(source_type);
-
     return bf;
 }
+
+/**
+ * @brief Free the memory of a BurstProfile
+ *
+ * @param bf The BurstProfile to destroy
+ */
+void BurstProfile_destroy(BurstProfile *bf)
+{
+    AliasTable_destroy(&bf->cpu_alias);
+    AliasTable_destroy(&bf->io_alias);
+    free(bf->cpu_hist);
+    free(bf->io_hist);
+    free(bf->source_type);
+    free(bf);
+}
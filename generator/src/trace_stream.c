@@ -0,0 +1,329 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <assert.h>
+
+#include "../include/trace_generator.h"
+
+/*
+ * The stream generates the processes a window at a time: window w holds the processes
+ * [w * window_procs, (w + 1) * window_procs) and their arrivals are spread on
+ * [w * ARRIVAL_WINDOW, (w + 1) * ARRIVAL_WINDOW). Only one window lives in memory,
+ * sorted by arrival, so the processes come out in arrival order with bounded memory.
+ * With a single window the processes are the same the generator writes on file with the same seed.
+ */
+struct TraceStream {
+    TraceGen tg;
+    char *histogram_folder; // copy owned by the stream
+    int shared;             // the profiles of tg belong to a TraceHistograms
+    int window_procs;
+    int window;             // index of the window in the buffer
+    int count;              // processes in the buffer
+    int pos;                // next process of the buffer to hand out
+    TraceProc *procs;
+    TraceBurst *bursts;
+};
+
+struct TraceHistograms {
+    TraceGen tg;            // only the profiles are used
+    char *histogram_folder;
+};
+
+static int cmpArrival(const void *a, const void *b)
+{
+    const TraceProc *pa = (const TraceProc *)a;
+    const TraceProc *pb = (const TraceProc *)b;
+
+    if (pa->arrival != pb->arrival)
+        return (pa->arrival > pb->arrival) ? 1 : -1;
+    return pa->proc_id - pb->proc_id;
+}
+
+/**
+ * @brief Generate the next window of processes in the buffer
+ *
+ * @param ts The stream
+ */
+static void TraceStream_fill(TraceStream *ts)
+{
+    int first = ts->window * ts->window_procs;
+    int last = first + ts->window_procs;
+
+    if (last > ts->tg.num_processes)
+        last = ts->tg.num_processes;
+
+    ts->count = (first < last) ? last - first : 0;
+    ts->pos = 0;
+
+    for (int i = 0; i < ts->count; i++)
+    {
+        TraceProc *proc = &ts->procs[i];
+        proc->bursts = &ts->bursts[i * ts->tg.burst_per_process];
+        TraceGen_generateProc(&ts->tg, first + i, proc);
+        proc->arrival += ts->window * ARRIVAL_WINDOW * NS_PER_MS;
+    }
+
+    qsort(ts->procs, ts->count, sizeof(TraceProc), cmpArrival);
+}
+
+/**
+ * @brief Allocate a stream and its window buffers, without histograms and without generating anything
+ *
+ * @param histogram_folder The path to the folder containing the histogram data
+ * @param num_processes Number of processes to generate
+ * @param burst_per_process Number of burst per process
+ * @param seed The seed all the process streams are derived from
+ * @param window_procs Number of processes generated at a time (<= 0 for all of them in a single window)
+ * @return TraceStream*
+ */
+static TraceStream *TraceStream_alloc(const char *histogram_folder, int num_processes, int burst_per_process,
+                                      uint64_t seed, int window_procs)
+{
+    TraceStream *ts;
+
+    assert(num_processes > 0 && burst_per_process > 0 && "empty stream");
+
+    if ((ts = (TraceStream *)malloc(sizeof(TraceStream))) == NULL)
+        assert(0 && "malloc failed");
+
+    if ((ts->histogram_folder = strdup(histogram_folder)) == NULL)
+        assert(0 && "malloc failed");
+    TraceGen_init(&ts->tg, num_processes, burst_per_process, ts->histogram_folder, seed);
+    ts->shared = 0;
+
+    ts->window_procs = (window_procs <= 0 || window_procs > num_processes) ? num_processes : window_procs;
+    ts->window = 0;
+
+    if ((ts->procs = (TraceProc *)malloc(ts->window_procs * sizeof(TraceProc))) == NULL)
+        assert(0 && "malloc failed");
+    if ((ts->bursts = (TraceBurst *)malloc((size_t)ts->window_procs * burst_per_process * sizeof(TraceBurst))) == NULL)
+        assert(0 && "malloc failed");
+
+    return ts;
+}
+
+/**
+ * @brief Open a stream of generated processes
+ *
+ * @param histogram_folder The path to the folder containing the histogram data
+ * @param num_processes Number of processes to generate
+ * @param burst_per_process Number of burst per process
+ * @param seed The seed all the process streams are derived from
+ * @param window_procs Number of processes generated at a time (<= 0 for all of them in a single window)
+ * @return TraceStream*
+ */
+TraceStream *TraceStream_open(const char *histogram_folder, int num_processes, int burst_per_process,
+                              uint64_t seed, int window_procs)
+{
+    TraceStream *ts = TraceStream_alloc(histogram_folder, num_processes, burst_per_process, seed, window_procs);
+
+    TraceGen_loadHistograms(&ts->tg);
+    TraceStream_fill(ts);
+
+    return ts;
+}
+
+/**
+ * @brief Open a stream on histograms already loaded. The generation only reads the profiles,
+ *        so any number of streams can share them from different threads; th must outlive them
+ *
+ * @param th The loaded histograms
+ * @param num_processes Number of processes to generate
+ * @param burst_per_process Number of burst per process
+ * @param seed The seed all the process streams are derived from
+ * @param window_procs Number of processes generated at a time (<= 0 for all of them in a single window)
+ * @return TraceStream*
+ */
+TraceStream *TraceStream_openShared(const TraceHistograms *th, int num_processes, int burst_per_process,
+                                    uint64_t seed, int window_procs)
+{
+    TraceStream *ts = TraceStream_alloc(th->histogram_folder, num_processes, burst_per_process, seed, window_procs);
+
+    ts->tg.burst_profiles = th->tg.burst_profiles;
+    ts->tg.profiles = th->tg.profiles;
+    ts->shared = 1;
+    TraceStream_fill(ts);
+
+    return ts;
+}
+
+/**
+ * @brief Arrival time of the next process, without consuming it
+ *
+ * @param ts The stream
+ * @return int64_t the arrival time in ns, -1 if the stream is over
+ */
+int64_t TraceStream_peekArrival(TraceStream *ts)
+{
+    if (ts->pos == ts->count)
+    {
+        if (ts->count == 0)
+            return -1;
+        ts->window++;
+        TraceStream_fill(ts);
+        if (ts->count == 0)
+            return -1;
+    }
+    return ts->procs[ts->pos].arrival;
+}
+
+/**
+ * @brief Hand out the next process in arrival order.
+ *        The process (and its bursts) stays valid until the next call
+ *
+ * @param ts The stream
+ * @return TraceProc* the process, NULL if the stream is over
+ */
+TraceProc *TraceStream_next(TraceStream *ts)
+{
+    if (TraceStream_peekArrival(ts) < 0)
+        return NULL;
+    return &ts->procs[ts->pos++];
+}
+
+/**
+ * @brief Close the stream and free its memory
+ *
+ * @param ts The stream
+ */
+void TraceStream_close(TraceStream *ts)
+{
+    if (!ts->shared)
+        TraceGen_destroy(&ts->tg);
+    free(ts->histogram_folder);
+    free(ts->procs);
+    free(ts->bursts);
+    free(ts);
+}
+
+/**
+ * @brief Parameters and position of the stream. The folder stays valid until the stream is closed
+ *
+ * @param ts The stream
+ * @param state The state to fill
+ */
+void TraceStream_getState(TraceStream *ts, TraceStreamState *state)
+{
+    state->histogram_folder = ts->histogram_folder;
+    state->num_processes = ts->tg.num_processes;
+    state->burst_per_process = ts->tg.burst_per_process;
+    state->seed = ts->tg.seed;
+    state->window_procs = ts->window_procs;
+    state->window = ts->window;
+    state->pos = ts->pos;
+}
+
+/**
+ * @brief Reopen a stream at the position of a saved state.
+ *        The processes are generated per process from the seed, so the window is the same it was
+ *
+ * @param state The state saved by TraceStream_getState
+ * @return TraceStream*
+ */
+TraceStream *TraceStream_restore(const TraceStreamState *state)
+{
+    TraceStream *ts = TraceStream_open(state->histogram_folder, state->num_processes, state->burst_per_process,
+                                       state->seed, state->window_procs);
+
+    if (state->window != ts->window)
+    {
+        ts->window = state->window;
+        TraceStream_fill(ts);
+    }
+    assert(state->pos <= ts->count && "stream position out of the window");
+    ts->pos = state->pos;
+
+    return ts;
+}
+
+/**
+ * @brief Load the histograms of a folder, to open streams on them with TraceStream_openShared
+ *
+ * @param histogram_folder The path to the folder containing the histogram data
+ * @return TraceHistograms*
+ */
+TraceHistograms *TraceHistograms_load(const char *histogram_folder)
+{
+    TraceHistograms *th;
+
+    if ((th = (TraceHistograms *)malloc(sizeof(TraceHistograms))) == NULL)
+        assert(0 && "malloc failed");
+    if ((th->histogram_folder = strdup(histogram_folder)) == NULL)
+        assert(0 && "malloc failed");
+
+    TraceGen_init(&th->tg, 0, 0, th->histogram_folder, 0);
+    TraceGen_loadHistograms(&th->tg);
+
+    return th;
+}
+
+/**
+ * @brief Free the histograms, after all the streams opened on them are closed
+ *
+ * @param th The histograms
+ */
+void TraceHistograms_destroy(TraceHistograms *th)
+{
+    TraceGen_destroy(&th->tg);
+    free(th->histogram_folder);
+    free(th);
+}
+
+/**
+ * @brief Parse a time of a trace or of a histogram: a number with an optional unit, ns, us, ms or s.
+ *        Without the unit it is in ms
+ *
+ * @param str The text, the leading blanks are skipped
+ * @param end Set to the first character after the time, may be NULL
+ * @return int64_t the time in ns, -1 if the text doesn't start with a time
+ */
+int64_t TraceTime_parse(const char *str, char **end)
+{
+    static const struct {
+        const char *unit;
+        double ns;
+    } units[] = {{"ns", 1}, {"us", 1e3}, {"ms", 1e6}, {"s", 1e9}};
+    double scale = NS_PER_MS;
+    char *rest;
+    double value = strtod(str, &rest);
+
+    // the negation also refuses nan
+    if (rest == str || !(value >= 0))
+        return -1;
+    for (size_t i = 0; i < sizeof(units) / sizeof(units[0]); i++)
+    {
+        size_t len = strlen(units[i].unit);
+        if (strncmp(rest, units[i].unit, len) == 0 && !isalpha((unsigned char)rest[len]))
+        {
+            scale = units[i].ns;
+            rest += len;
+            break;
+        }
+    }
+    // an unknown unit, or a time out of the range of the ns
+    if (isalpha((unsigned char)*rest) || value * scale >= 9e18)
+        return -1;
+
+    if (end)
+        *end = rest;
+    return (int64_t)(value * scale + 0.5);
+}
+
+/**
+ * @brief Write a time as the traces hold it: a whole number of ms without the unit, as the
+ *        first traces, else in us or in ns
+ *
+ * @param buf The buffer
+ * @param size Size of the buffer
+ * @param ns The time in ns
+ * @return int the length of the text, as snprintf
+ */
+int TraceTime_format(char *buf, int size, int64_t ns)
+{
+    if (ns % NS_PER_MS == 0)
+        return snprintf(buf, size, "%lld", (long long)(ns / NS_PER_MS));
+    if (ns % 1000 == 0)
+        return snprintf(buf, size, "%lldus", (long long)(ns / 1000));
+    return snprintf(buf, size, "%lldns", (long long)ns);
+}
@@ -1,6 +1,5 @@
 #include <stdio.h>
 #include <stdlib.h>
-#include <time.h>
 #include <assert.h>
 #include <string.h>
 #include <dirent.h>
@@ -21,13 +20,16 @@ void test_generateBurstDuration(const char *filename) {
     int num_samples = 10000;
     int *cpu_counts = (int *)calloc(bf->cpu_size, sizeof(int));
     int *io_counts = (int *)calloc(bf->io_size, sizeof(int));
+    Rng rng;
+
+    Rng_seed(&rng, 42, 0);
 
     for (int i = 0; i < num_samples; i++) {
-        int duration;
-        double random_val = (double)rand() / RAND_MAX;
+        int64_t duration;
+        double random_val = Rng_uniform(&rng);
 
         if (random_val < 0.5) {
-            duration = getBurstDuration(bf->cpu_hist, bf->cpu_size, 1);
+            duration = getBurstDuration(bf->cpu_hist, &bf->cpu_alias, &rng);
             for (int j = 0; j < bf->cpu_size; j++) {
                 if (duration == bf->cpu_hist[j].burst_time) {
                     cpu_counts[j]++;
@@ -35,7 +37,7 @@ void test_generateBurstDuration(const char *filename) {
                 }
             }
         } else {
-            duration = getBurstDuration(bf->io_hist, bf->io_size, 1);
+            duration = getBurstDuration(bf->io_hist, &bf->io_alias, &rng);
             for (int j = 0; j < bf->io_size; j++) {
                 if (duration == bf->io_hist[j].burst_time) {
                     io_counts[j]++;
@@ -48,12 +50,12 @@ void test_generateBurstDuration(const char *filename) {
     num_samples = num_samples / 2; // mezzi perche alterniamo CPU e IO burst 
     printf("CPU Burst Histogram:\n");
     for (int i = 0; i < bf->cpu_size; i++) {
-        printf("Duration %d: %d (Expected ~%d)\n", bf->cpu_hist[i].burst_time, cpu_counts[i], (int)(num_samples * bf->cpu_hist[i].probability));
+        printf("Duration %lld ns: %d (Expected ~%d)\n", (long long)bf->cpu_hist[i].burst_time, cpu_counts[i], (int)(num_samples * bf->cpu_hist[i].probability));
     }
 
     printf("IO Burst Histogram:\n");
     for (int i = 0; i < bf->io_size; i++) {
-        printf("Duration %d: %d (Expected ~%d)\n", bf->io_hist[i].burst_time, io_counts[i], (int)(num_samples * bf->io_hist[i].probability));
+        printf("Duration %lld ns: %d (Expected ~%d)\n", (long long)bf->io_hist[i].burst_time, io_counts[i], (int)(num_samples * bf->io_hist[i].probability));
     }
 
     for (int i = 0; i < bf->cpu_size; i++) {
@@ -67,17 +69,107 @@ void test_generateBurstDuration(const char *filename) {
         int tolerance = expected * 0.15; // Tolleranza del 15%
         assert(io_counts[i] > expected - tolerance && io_counts[i] < expected + tolerance);
     }
+
+    free(cpu_counts);
+    free(io_counts);
+    BurstProfile_destroy(bf);
+}
+
+// Funzione di test per verificare che lo stesso seed dia la stessa sequenza
+// e che stream diversi siano indipendenti
+void test_rngStreams(void) {
+    Rng a, b, c;
+
+    Rng_seed(&a, 42, 7);
+    Rng_seed(&b, 42, 7);
+    Rng_seed(&c, 42, 8);
+
+    int same_stream = 1, other_stream = 1;
+    for (int i = 0; i < 1000; i++) {
+        uint64_t va = Rng_next(&a);
+        same_stream &= (va == Rng_next(&b));
+        other_stream &= (va == Rng_next(&c));
+    }
+    assert(same_stream && "same seed and stream must give the same sequence");
+    assert(!other_stream && "different streams must differ");
+
+    for (int i = 0; i < 1000; i++) {
+        double u = Rng_uniform(&a);
+        int r = Rng_range(&a, 5);
+        assert(u >= 0.0 && u < 1.0);
+        assert(r >= 0 && r < 5);
+    }
 }
 
+// Funzione di test per verificare che il batch di burst rispetti l'istogramma
+void test_generateBurstBatch(const char *filename) {
+
+    BurstProfile *bf = BurstProfile_loadHistogram(filename);
+
+    int num_samples = 10000;
+    int64_t *bursts = (int64_t *)malloc(num_samples * sizeof(int64_t));
+    int *cpu_counts = (int *)calloc(bf->cpu_size, sizeof(int));
+    Rng rng;
+
+    Rng_seed(&rng, 42, 1);
+    getBurstDurations(bf->cpu_hist, &bf->cpu_alias, &rng, bursts, num_samples);
+
+    for (int i = 0; i < num_samples; i++) {
+        int found = 0;
+        for (int j = 0; j < bf->cpu_size; j++) {
+            if (bursts[i] == bf->cpu_hist[j].burst_time) {
+                cpu_counts[j]++;
+                found = 1;
+                break;
+            }
+        }
+        assert(found && "burst not in the histogram");
+    }
+
+    for (int i = 0; i < bf->cpu_size; i++) {
+        int expected = (int)(num_samples * bf->cpu_hist[i].probability);
+        int tolerance = expected * 0.15; // Tolleranza del 15%
+        assert(cpu_counts[i] > expected - tolerance && cpu_counts[i] < expected + tolerance);
+    }
+
+    free(bursts);
+    free(cpu_counts);
+    BurstProfile_destroy(bf);
+}
+
+
+// Funzione di test per verificare la lettura e la scrittura dei tempi delle tracce
+void test_traceTime(void) {
+    char buf[32];
+    char *end;
+
+    // senza unita' il tempo e' in ms, come nelle prime tracce
+    assert(TraceTime_parse("  25 0.40", &end) == 25 * NS_PER_MS && *end == ' ');
+    assert(TraceTime_parse("250us,0.5", &end) == 250000 && *end == ',');
+    assert(TraceTime_parse("1.5ms", NULL) == 1500000);
+    assert(TraceTime_parse("2s", NULL) == 2000 * NS_PER_MS);
+    assert(TraceTime_parse("40ns", NULL) == 40);
+    assert(TraceTime_parse("10min", NULL) < 0 && TraceTime_parse("-3", NULL) < 0 && TraceTime_parse("IO", NULL) < 0);
+
+    TraceTime_format(buf, sizeof(buf), 50 * NS_PER_MS);
+    assert(strcmp(buf, "50") == 0);
+    TraceTime_format(buf, sizeof(buf), 1500000);
+    assert(strcmp(buf, "1500us") == 0);
+    TraceTime_format(buf, sizeof(buf), 2001);
+    assert(strcmp(buf, "2001ns") == 0);
+    assert(TraceTime_parse(buf, NULL) == 2001);
+}
 
 int main(int argc, char **argv) {
-    srand(time(NULL));
 
     if (argc < 2) {
         printf("Usage: %s <path_of_histogram_folder>\n", argv[0]);
         return 1;
     }
 
+    test_rngStreams();
+    test_traceTime();
+
     // Path della cartella contenente gli istogrammi
     const char *histogram_folder = argv[1];
 
@@ -103,6 +195,7 @@ int main(int argc, char **argv) {
         // Test che verifica la corretta generazione dei burst in base all'istogramma
         printf("\nTesting histogram file: %s\n\n", file_path);
         test_generateBurstDuration(file_path);
+        test_generateBurstBatch(file_path);
     }
 
     // Chiudi la cartella
@@ -0,0 +1,393 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <getopt.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#include <sys/utsname.h>
+
+#include "../include/fake_os.h"
+
+/*
+ * End-to-end benchmark: every configuration (processes x scheduler x cores) runs a pipeline
+ * workload generated from all the histograms with a fixed seed, in a forked child so the
+ * peak RSS of the run is its own. Every configuration is repeated and the fastest run that
+ * finished is kept. The results can be saved as a baseline and later runs compared against
+ * it: a drop of the throughput beyond the tolerance is a regression. A baseline only holds on
+ * the host that saved it, no baseline is shipped: save one with --save on the reference host.
+ */
+
+#define MAX_CONFIGS 16
+#define MAX_RESULTS 1024
+#define BENCH_SEED 42
+#define BENCH_BURSTS 10
+#define BENCH_QUANTUM 20
+#define BENCH_WINDOW 1000 // processes generated per arrival window
+
+typedef struct
+{
+	int procs;
+	int scheduler; // numbered as in disastros
+	int cores;
+	double wall;		 // s
+	double sim_per_sec;	 // simulated ms per wall second
+	double events_per_sec; // bursts simulated per wall second
+	long max_rss;		 // kB
+	int timed_out;
+} BenchResult;
+
+static char usage_buffer[] = "Usage: %s [options] \n\
+\n\
+Options: \n\
+	--histograms <folder>: histograms the workloads are generated from (default histogram) \n\
+	--procs <n,n,...>: processes of the workloads (default 1000) \n\
+	--cores <n,n,...>: simulated cores (default 1,4,16,64,256) \n\
+	--schedulers <n,n,...>: schedulers, numbered as in disastros (default all) \n\
+	--repeat <n>: runs of every configuration, the fastest finished one is reported (default 5) \n\
+	--timeout <s>: wall time limit of a single run (default 60) \n\
+	--baseline <file>: compare the results with this baseline, exit 1 on regression \n\
+	--tolerance <percent>: allowed throughput drop with respect to the baseline (default 10) \n\
+	--save <file>: save the results as a baseline \n\
+	--full: run the canonical workloads of 1000,100000,1000000 processes \n\
+\n";
+
+static double now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Parse a comma separated list of integers
+ *
+ * @param str
+ * @param values
+ * @return int number of values, -1 if the list is not valid
+ */
+static int parseList(const char *str, int *values)
+{
+	int n = 0;
+	char *end;
+
+	while (*str)
+	{
+		if (n == MAX_CONFIGS)
+			return -1;
+		values[n++] = strtol(str, &end, 10);
+		if (end == str || values[n - 1] < 1 || (*end && *end != ','))
+			return -1;
+		str = (*end == ',') ? end + 1 : end;
+	}
+	return n;
+}
+
+/**
+ * @brief Simulate a configuration, the final time of the simulation is written on fd
+ *
+ * @param histograms
+ * @param result the configuration to run
+ * @param fd
+ */
+static void runChild(const char *histograms, BenchResult *result, int fd)
+{
+	FakeOS os;
+
+	FakeOS_init(&os, result->cores);
+	FakeOS_setScheduler(&os, result->scheduler - 1, BENCH_QUANTUM);
+	os.verbose = 0;
+	os.stream = TraceStream_open(histograms, result->procs, BENCH_BURSTS, BENCH_SEED, BENCH_WINDOW);
+
+	while (!FakeOS_finished(&os))
+		FakeOS_simStep(&os);
+
+	// the simulated time and its timebase, for the simulated ms
+	if (write(fd, &os.timer, sizeof(SimTime)) != sizeof(SimTime) ||
+		write(fd, &os.ticks_per_ms, sizeof(SimTime)) != sizeof(SimTime))
+		_exit(1);
+	_exit(0);
+}
+
+/**
+ * @brief Run a configuration in a child process and measure it
+ *
+ * @param histograms
+ * @param result
+ * @param timeout
+ * @return int 1 if the timeout stopped the run
+ */
+static int runConfig(const char *histograms, BenchResult *result, int timeout)
+{
+	int fds[2];
+	int status;
+	SimTime sim_time = 0;
+	SimTime ticks_per_ms = TIMEBASE_MS;
+	struct rusage usage;
+	double start;
+	pid_t pid;
+
+	if (pipe(fds) < 0)
+		assert(0 && "pipe failed");
+
+	fflush(stdout);
+	start = now();
+	if ((pid = fork()) < 0)
+		assert(0 && "fork failed");
+	if (pid == 0)
+	{
+		close(fds[0]);
+		alarm(timeout);
+		runChild(histograms, result, fds[1]);
+	}
+
+	close(fds[1]);
+	if (read(fds[0], &sim_time, sizeof(SimTime)) != sizeof(SimTime) ||
+		read(fds[0], &ticks_per_ms, sizeof(SimTime)) != sizeof(SimTime) || ticks_per_ms < 1)
+	{
+		sim_time = 0;
+		ticks_per_ms = TIMEBASE_MS;
+	}
+	close(fds[0]);
+	if (wait4(pid, &status, 0, &usage) < 0)
+		assert(0 && "wait failed");
+
+	result->wall = now() - start;
+	result->max_rss = usage.ru_maxrss;
+	result->timed_out = !WIFEXITED(status) || WEXITSTATUS(status) != 0;
+	result->sim_per_sec = result->timed_out ? 0 : (double)sim_time / ticks_per_ms / result->wall;
+	result->events_per_sec = result->timed_out ? 0 : (double)result->procs * BENCH_BURSTS / result->wall;
+	return WIFSIGNALED(status) && WTERMSIG(status) == SIGALRM;
+}
+
+/**
+ * @brief Look for a configuration in the baseline
+ *
+ * @param baseline
+ * @param n
+ * @param result
+ * @return BenchResult* NULL if the configuration is not in the baseline
+ */
+static BenchResult *findBaseline(BenchResult *baseline, int n, BenchResult *result)
+{
+	for (int i = 0; i < n; i++)
+		if (baseline[i].procs == result->procs && baseline[i].scheduler == result->scheduler &&
+			baseline[i].cores == result->cores)
+			return &baseline[i];
+	return NULL;
+}
+
+/**
+ * @brief Load a baseline file, one configuration per line
+ *
+ * @param file
+ * @param baseline
+ * @return int number of configurations
+ */
+static int loadBaseline(const char *file, BenchResult *baseline)
+{
+	FILE *f = fopen(file, "r");
+	char line[256];
+	int n = 0;
+
+	if (!f)
+	{
+		perror("Could not open baseline");
+		exit(1);
+	}
+	while (n < MAX_RESULTS && fgets(line, sizeof(line), f))
+	{
+		BenchResult *b = &baseline[n];
+		if (line[0] == '#')
+			continue;
+		if (sscanf(line, "%d %d %d %lf %lf %ld %lf", &b->procs, &b->scheduler, &b->cores,
+				   &b->sim_per_sec, &b->events_per_sec, &b->max_rss, &b->wall) == 7)
+			n++;
+	}
+	fclose(f);
+	return n;
+}
+
+static void saveBaseline(const char *file, BenchResult *results, int n)
+{
+	FILE *f = fopen(file, "w");
+	struct utsname host;
+	time_t saved = time(NULL);
+
+	if (!f)
+	{
+		perror("Could not write baseline");
+		exit(1);
+	}
+	if (uname(&host) == 0)
+		fprintf(f, "# reference host: %s %s %s, saved %s", host.nodename, host.sysname, host.machine, ctime(&saved));
+	fprintf(f, "# procs scheduler cores sim_ms_per_s events_per_s max_rss_kb wall_s\n");
+	for (int i = 0; i < n; i++)
+		if (!results[i].timed_out)
+			fprintf(f, "%d %d %d %.1f %.1f %ld %.4f\n", results[i].procs, results[i].scheduler, results[i].cores,
+					results[i].sim_per_sec, results[i].events_per_sec, results[i].max_rss, results[i].wall);
+	fclose(f);
+}
+
+int main(int argc, char **argv)
+{
+	const char *histograms = "histogram";
+	const char *baseline_file = NULL;
+	const char *save_file = NULL;
+	int procs[MAX_CONFIGS] = {1000};
+	int cores[MAX_CONFIGS] = {1, 4, 16, 64, 256};
+	int schedulers[MAX_CONFIGS];
+	int num_procs = 1, num_cores = 5, num_schedulers = MAX_SCHEDULERS;
+	int timeout = 60;
+	int repeat = 5;
+	double tolerance = 10;
+	int opt;
+
+	static BenchResult results[MAX_RESULTS];
+	static BenchResult baseline[MAX_RESULTS];
+	int num_results = 0, num_baseline = 0, regressions = 0;
+
+	static struct option long_options[] = {
+		{"histograms", required_argument, 0, 'H'},
+		{"procs", required_argument, 0, 'n'},
+		{"cores", required_argument, 0, 'c'},
+		{"schedulers", required_argument, 0, 's'},
+		{"repeat", required_argument, 0, 'r'},
+		{"timeout", required_argument, 0, 't'},
+		{"baseline", required_argument, 0, 'b'},
+		{"tolerance", required_argument, 0, 'T'},
+		{"save", required_argument, 0, 'o'},
+		{"full", no_argument, 0, 'F'},
+		{0, 0, 0, 0}
+	};
+
+	for (int i = 0; i < MAX_SCHEDULERS; i++)
+		schedulers[i] = i + 1;
+
+	while ((opt = getopt_long(argc, argv, "H:n:c:s:r:t:b:T:o:F", long_options, NULL)) != -1)
+	{
+		switch (opt)
+		{
+		case 'H':
+			histograms = optarg;
+			break;
+		case 'n':
+			num_procs = parseList(optarg, procs);
+			break;
+		case 'c':
+			num_cores = parseList(optarg, cores);
+			break;
+		case 's':
+			num_schedulers = parseList(optarg, schedulers);
+			break;
+		case 'r':
+			repeat = atoi(optarg);
+			break;
+		case 't':
+			timeout = atoi(optarg);
+			break;
+		case 'b':
+			baseline_file = optarg;
+			break;
+		case 'T':
+			tolerance = atof(optarg);
+			break;
+		case 'o':
+			save_file = optarg;
+			break;
+		case 'F':
+			procs[0] = 1000;
+			procs[1] = 100000;
+			procs[2] = 1000000;
+			num_procs = 3;
+			break;
+		default:
+			printf(usage_buffer, argv[0]);
+			return 1;
+		}
+	}
+
+	if (optind != argc || num_procs < 1 || num_cores < 1 || num_schedulers < 1 || repeat < 1 || timeout < 1 || tolerance < 0 ||
+		(long)num_procs * num_cores * num_schedulers > MAX_RESULTS)
+	{
+		printf(usage_buffer, argv[0]);
+		return 1;
+	}
+	for (int i = 0; i < num_schedulers; i++)
+	{
+		if (schedulers[i] > MAX_SCHEDULERS)
+		{
+			printf(usage_buffer, argv[0]);
+			return 1;
+		}
+	}
+
+	if (baseline_file)
+		num_baseline = loadBaseline(baseline_file, baseline);
+
+	printf("%9s %5s %5s %10s %14s %14s %12s %9s\n", "procs", "sched", "cores", "wall (s)", "sim ms/s", "events/s",
+		   "max rss kB", "vs base");
+	for (int p = 0; p < num_procs; p++)
+	{
+		for (int s = 0; s < num_schedulers; s++)
+		{
+			for (int c = 0; c < num_cores; c++)
+			{
+				BenchResult *result = &results[num_results++];
+				BenchResult *base;
+
+				memset(result, 0, sizeof(BenchResult));
+				result->procs = procs[p];
+				result->scheduler = schedulers[s];
+				result->cores = cores[c];
+				for (int r = 0, finished = 0; r < repeat; r++)
+				{
+					BenchResult run = *result;
+					int stopped = runConfig(histograms, &run, timeout);
+
+					// a failed run, however quick, never replaces a finished one: the
+					// configuration fails only if every run does
+					if (run.timed_out ? !finished : !finished || run.wall < result->wall)
+						*result = run;
+					finished |= !run.timed_out;
+					// a run stopped by the timeout would be stopped again
+					if (stopped && !finished)
+						break;
+				}
+				base = findBaseline(baseline, num_baseline, result);
+
+				printf("%9d %5d %5d %10.3f", result->procs, result->scheduler, result->cores, result->wall);
+				if (result->timed_out)
+				{
+					// a configuration that completed in the baseline and doesn't anymore is a regression
+					printf(" %14s %14s %12ld %9s\n", "timeout", "-", result->max_rss, base ? "REGRESSION" : "-");
+					if (base)
+						regressions++;
+					continue;
+				}
+				printf(" %14.0f %14.0f %12ld", result->sim_per_sec, result->events_per_sec, result->max_rss);
+				if (!base)
+				{
+					printf(" %9s\n", "-");
+					continue;
+				}
+
+				double delta = (result->sim_per_sec - base->sim_per_sec) * 100 / base->sim_per_sec;
+				printf(" %+8.1f%%%s\n", delta, (delta < -tolerance) ? " REGRESSION" : "");
+				if (delta < -tolerance)
+					regressions++;
+			}
+		}
+	}
+
+	if (save_file)
+		saveBaseline(save_file, results, num_results);
+
+	if (baseline_file)
+		printf("\n%d regressions beyond %.1f%% against %s\n", regressions, tolerance, baseline_file);
+
+	return regressions ? 1 : 0;
+}
@@ -0,0 +1,209 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <math.h>
+#include <time.h>
+
+#include "../include/fake_os.h"
+
+/*
+ * Micro-benchmark of the enqueue and pick paths of every policy on synthetic ready queues.
+ * For each size the ready queue is filled with n PCBs (one CPU burst each), then every
+ * pick runs the picked slice, or the whole burst, and re-enqueues the process, so the queue
+ * size stays n and the preemptive policies split a burst at every pick of a long one.
+ * Allocations are counted wrapping malloc/calloc at link time (-Wl,--wrap).
+ */
+
+static unsigned long bench_allocs = 0;
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t nmemb, size_t size);
+
+void *__wrap_malloc(size_t size)
+{
+	bench_allocs++;
+	return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t nmemb, size_t size)
+{
+	bench_allocs++;
+	return __real_calloc(nmemb, size);
+}
+
+typedef struct
+{
+	const char *name;
+	SchedulerType scheduler;
+} BenchPolicy;
+
+static BenchPolicy policies[] = {
+	{"FCFS", FCFS},
+	{"FCFS_PREEMPTIVE", FCFS_PREEMPTIVE},
+	{"SJF_PREDICT", SJF_PREDICT},
+	{"SJF_PURE", SJF_PURE},
+	{"SRTF", SRTF},
+	{"PRIORITY", PRIORITY},
+	{"RR", RR},
+	{"MLQ", MLQ},
+	{"MLFQ", MLFQ},
+};
+
+#define NUM_POLICIES ((int)(sizeof(policies) / sizeof(policies[0])))
+#define BENCH_QUANTUM 20
+
+static double now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Create a PCB with a single CPU burst, as FakeOS_createPcb would
+ *
+ * @param os
+ * @param pid
+ * @return FakePCB*
+ */
+static FakePCB *benchPcb(FakeOS *os, int pid)
+{
+	FakePCB *pcb = (FakePCB *)malloc(sizeof(FakePCB));
+	ProcessEvent *e = (ProcessEvent *)malloc(sizeof(ProcessEvent));
+	assert(pcb && e);
+
+	pcb->list.next = pcb->list.prev = 0;
+	pcb->pid = pid;
+	pcb->id = PCBTable_alloc(&os->pcbs);
+	pcb->duration = 0;
+	pcb->quantum_used = 0;
+	pcb->priority = rand() % MAX_PRIORITY;
+	pcb->source = -1;
+	FakeOS_hot(os, pcb)->ready_since = 0;
+	FakeProcess_initiStats(FakeOS_cold(os, pcb));
+	List_init(&pcb->events);
+	FakeProcess_setArgs(FakeOS_hot(os, pcb), pcb, os->ops);
+	FakeOS_procUpdateStats(os, pcb, ARRIVAL_TIME);
+
+	e->list.next = e->list.prev = 0;
+	e->type = CPU;
+	e->duration = 1 + rand() % 500;
+	List_pushBack(&pcb->events, (ListItem *)e);
+
+	return pcb;
+}
+
+static void freePcb(FakePCB *pcb)
+{
+	ListItem *aux;
+	while ((aux = List_popFront(&pcb->events)))
+		free(aux);
+	free(pcb);
+}
+
+/**
+ * @brief Run the benchmark of a policy on a queue of n processes
+ *
+ * @param policy
+ * @param n size of the ready queue
+ * @param budget seconds spent on the picks at most (at least one pick is done)
+ * @param enqueue_ns ns per enqueue
+ * @param pick_ns ns per pick
+ * @param allocs allocations per pick + re-enqueue
+ */
+static void benchPolicy(BenchPolicy *policy, int n, double budget, double *enqueue_ns, double *pick_ns, double *allocs)
+{
+	FakeOS os;
+	FakePCB **pcbs = (FakePCB **)malloc(n * sizeof(FakePCB *));
+	double start, pick_time = 0;
+	long ops = 0;
+
+	FakeOS_init(&os, 1);
+	FakeOS_setScheduler(&os, policy->scheduler, BENCH_QUANTUM);
+	os.verbose = 0;
+	os.timer = 1;
+
+	for (int i = 0; i < n; i++)
+		pcbs[i] = benchPcb(&os, i + 1);
+
+	start = now();
+	for (int i = 0; i < n; i++)
+		FakeOS_enqueueProcess(&os, pcbs[i]);
+	*enqueue_ns = (now() - start) * 1e9 / n;
+
+	bench_allocs = 0;
+	do
+	{
+		double t = now();
+		FakeOS_schedule(&os);
+		pick_time += now() - t;
+
+		FakePCB *pcb = os.running[0];
+		assert(pcb && "nothing picked");
+		os.running[0] = 0;
+		os.timer++;
+		// the picked slice runs: the next pick of the process splits its remaining burst again,
+		// at the end of the burst a new one starts
+		ProcessEvent *e = (ProcessEvent *)List_popFront(&pcb->events);
+		if (pcb->events.first)
+			MemStats_free(MEM_EVENT, e, sizeof(ProcessEvent));
+		else
+		{
+			e->duration = 1 + rand() % 500;
+			List_pushBack(&pcb->events, (ListItem *)e);
+		}
+		FakeOS_enqueueProcess(&os, pcb);
+		ops++;
+	} while (pick_time < budget && ops < 1000000);
+
+	*pick_ns = pick_time * 1e9 / ops;
+	*allocs = (double)bench_allocs / ops;
+
+	// the queues still point to the PCBs, free them directly
+	for (int i = 0; i < n; i++)
+		freePcb(pcbs[i]);
+	free(pcbs);
+	FakeOS_destroy(&os);
+}
+
+int main(int argc, char **argv)
+{
+	int max_size = (argc > 1) ? atoi(argv[1]) : 1000000;
+	double budget = ((argc > 2) ? atoi(argv[2]) : 200) / 1000.0;
+
+	if (max_size < 10 || budget <= 0)
+	{
+		printf("Usage: %s [max_queue_size] [budget_ms_per_case]\n", argv[0]);
+		return 1;
+	}
+
+	srand(1);
+
+	printf("%-16s %9s %14s %14s %12s %9s\n", "policy", "queue", "enqueue ns/op", "pick ns/op", "allocs/op", "scaling");
+	for (int p = 0; p < NUM_POLICIES; p++)
+	{
+		double prev_pick = 0;
+		int prev_n = 0;
+
+		for (int n = 10; n <= max_size; n *= 10)
+		{
+			double enqueue_ns, pick_ns, allocs;
+
+			benchPolicy(&policies[p], n, budget, &enqueue_ns, &pick_ns, &allocs);
+
+			// scaling exponent of the pick cost: ~0 for O(1), ~1 for O(n)
+			printf("%-16s %9d %14.1f %14.1f %12.2f", policies[p].name, n, enqueue_ns, pick_ns, allocs);
+			if (prev_n)
+				printf(" %9.2f\n", log(pick_ns / prev_pick) / log((double)n / prev_n));
+			else
+				printf(" %9s\n", "-");
+			fflush(stdout);
+
+			prev_pick = pick_ns;
+			prev_n = n;
+		}
+	}
+
+	return 0;
+}
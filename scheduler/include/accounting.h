@@ -0,0 +1,48 @@
+#pragma once
+
+#include "fake_process.h"
+#include "latency_hist.h"
+
+#define MAX_SOURCES 32   // distinct source profiles (From: in the trace header)
+#define MAX_SLOS 16
+
+// Accounting of a group of processes (a priority class or a source profile)
+typedef struct
+{
+	unsigned int completed;
+	SimTime cpu_time;               // time spent running
+	SimTime waiting_time;           // time spent in the ready queue by the terminated processes
+	SimTime max_starvation;         // longest time a process sat in the ready queue without being scheduled
+	double share_sum;               // sum and sum of squares of the service share of the terminated processes,
+	double share_sq_sum;            // cpu / (cpu + waiting), for Jain's fairness index
+	LatencyHist response;
+} ClassStats;
+
+// Service level objective: the percentile of the response time of a class must stay under a threshold
+typedef struct
+{
+	ProcessPriority priority;
+	double percentile;
+	SimTime threshold;              // in ticks
+} SloTarget;
+
+typedef struct
+{
+	ClassStats priority[MAX_PRIORITY];
+	int num_sources;
+	char *source_names[MAX_SOURCES];
+	ClassStats source[MAX_SOURCES];
+	int num_slos;
+	SloTarget slos[MAX_SLOS];
+} Accounting;
+
+void Accounting_init(Accounting *acct);
+void Accounting_destroy(Accounting *acct);
+int Accounting_sourceId(Accounting *acct, const char *name);
+int Accounting_addSlo(Accounting *acct, const char *spec, SimTime ticks_per_ms);
+void Accounting_running(Accounting *acct, FakePCB *pcb);
+void Accounting_dispatch(Accounting *acct, FakePCB *pcb, SimTime starvation);
+void Accounting_terminated(Accounting *acct, FakePCB *pcb, ProcessStats *stats);
+double Accounting_jain(const ClassStats *stats, int num);
+double Accounting_jainClasses(const ClassStats *stats, int num);
+void Accounting_print(Accounting *acct, const char *unit);
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "timebase.h"
+
+struct FakeOS;
+
+#define MAX_BRANCHES 16
+
+// A scheduler configuration the simulation branches into
+typedef struct
+{
+	int scheduler;
+	SimTime quantum;
+} BranchVariant;
+
+// Outcome of a branch, sent by the child process to the parent
+typedef struct
+{
+	int ok;
+	SimTime total_time;
+	unsigned int completed;
+	double cpu_used;
+	double turnaround_mean;
+	uint64_t turnaround_p99;
+	double waiting_mean;
+	uint64_t waiting_p99;
+	double response_mean;
+	uint64_t response_p99;
+	double jain;
+	double energy;      // J, 0 without the energy model
+} BranchResult;
+
+int Branch_parseVariant(const char *spec, SimTime ticks_per_ms, BranchVariant *variant);
+void Branch_result(struct FakeOS *os, BranchResult *result);
+void Branch_run(struct FakeOS *os, const BranchVariant *variants, int num_variants);
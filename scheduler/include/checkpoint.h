@@ -0,0 +1,12 @@
+#pragma once
+
+struct FakeOS;
+
+// Snapshot of the whole simulator state in a binary file: the header holds the magic and the
+// version of the format, a file of another version is refused. Values are in the native
+// byte order, a checkpoint is meant to be restored on the same kind of machine.
+#define CHECKPOINT_MAGIC "DSOSCKPT"
+#define CHECKPOINT_VERSION 9
+
+int Checkpoint_save(struct FakeOS *os, const char *filename);
+int Checkpoint_restore(struct FakeOS *os, const char *filename);
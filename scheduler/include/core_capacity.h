@@ -0,0 +1,77 @@
+#pragma once
+
+#include <stddef.h>
+
+#include "timebase.h"
+
+struct FakeOS;
+struct FakePCB;
+
+#define MAX_CORE_CLASSES 8
+#define CAPACITY_EWMA 0.125     // weight of a dispatched burst in the heavy threshold
+#define CAPACITY_LIGHT 0.5      // a process is light below this fraction of the threshold
+
+// Cores of different speeds (big.LITTLE, mixed CPU generations). A tick on a core retires
+// speed units of the running burst, times the frequency factor set by the energy model and the
+// scale of the topology, the quantum stays in burst units. The dispatcher places a heavy
+// process, whose remaining burst is at least the moving average of the dispatched bursts, on
+// the fastest idle core and a light one on the slowest. Before scheduling, a heavy process on a
+// slower core moves up to an idle faster core, and a light process on a faster core moves down
+// to an idle slower one when a heavy process is ready for the core it frees. With a topology
+// the dispatcher places by the nodes, the bursts still update the threshold, and the
+// migrations stay within a node.
+// The state of the cores is a structure of arrays, one per field in a single block that starts
+// at speed: the step reads a few fields of every core, the placement scans the classes only.
+typedef struct CoreCapacity
+{
+	unsigned int cores;
+	int num_classes;
+	double class_speed[MAX_CORE_CLASSES];   // speed of each class, decreasing
+	double threshold;           // moving average of the dispatched bursts, 0 before the first
+	unsigned int upmigrations;
+	unsigned int downmigrations;
+	double *speed;              // burst units retired per tick
+	double *freq;               // frequency factor of the speed, 1 without the energy model
+	double *scale;              // speed factor of the running process, remote memory and busy SMT sibling
+	double *credit;             // fraction of a unit carried to the next tick
+	SimTime *work;              // burst units retired
+	SimTime *stall;             // ticks the core waits, waking up from an idle state, before it runs
+	int *cls;                   // class of the core, 0 is the fastest
+	unsigned int *bursts;       // CPU bursts completed on the core
+} CoreCapacity;
+
+/**
+ * @brief Burst units a core retires in this tick, at most the remaining ones of the burst
+ *
+ * @param cap
+ * @param core
+ * @param remaining units left in the running CPU event
+ * @return SimTime
+ */
+static inline SimTime CoreCapacity_retire(CoreCapacity *cap, int core, SimTime remaining)
+{
+	SimTime units;
+
+	if (cap->stall[core])
+	{
+		cap->stall[core]--;
+		return 0;
+	}
+	cap->credit[core] += cap->speed[core] * cap->freq[core] * cap->scale[core];
+	units = (SimTime)cap->credit[core];
+	cap->credit[core] -= units;
+	// the rest of the tick is lost when the burst ends before it
+	if (units > remaining)
+		units = remaining;
+	cap->work[core] += units;
+	return units;
+}
+
+size_t CoreCapacity_coresSize(int cores);
+void CoreCapacity_allocCores(CoreCapacity *cap, int cores);
+CoreCapacity *CoreCapacity_create(const char *spec, int cores);
+int CoreCapacity_place(CoreCapacity *cap, struct FakeOS *os, struct FakePCB *pcb);
+void CoreCapacity_observe(CoreCapacity *cap, struct FakePCB *pcb);
+void CoreCapacity_migrate(CoreCapacity *cap, struct FakeOS *os);
+void CoreCapacity_print(const CoreCapacity *cap, const struct FakeOS *os);
+void CoreCapacity_destroy(CoreCapacity *cap);
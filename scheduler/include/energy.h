@@ -0,0 +1,76 @@
+#pragma once
+
+#include "timebase.h"
+
+struct FakeOS;
+
+#define MAX_PSTATES 4
+#define MAX_CSTATES 4
+#define EN_GOVERNOR_PERIOD 10   // ms between two frequency decisions of the governor
+#define EN_UP_THRESHOLD 0.80    // ondemand: above this utilization the core goes to the highest frequency
+#define EN_SCHEDUTIL_MARGIN 1.25 // schedutil: headroom over the frequency invariant utilization
+#define EN_IDLE_EWMA 0.25       // weight of an idle period in the prediction of the next one
+
+typedef enum
+{
+	GOV_PERFORMANCE,
+	GOV_POWERSAVE,
+	GOV_ONDEMAND,
+	GOV_SCHEDUTIL,
+	MAX_GOVERNORS
+} Governor;
+
+// performance state: frequency relative to the highest one and power of a busy core of speed 1
+typedef struct
+{
+	double freq;
+	double power;               // W
+} PState;
+
+// idle state: the first entry_latency ms are spent at the power of the shallowest state, a wakeup
+// stalls the core for exit_latency ms, the state is chosen only for a predicted idle period of at
+// least target_residency ms
+typedef struct
+{
+	const char *name;
+	double power;               // W
+	int entry_latency;          // ms
+	int exit_latency;           // ms
+	int target_residency;       // ms
+} CState;
+
+typedef struct CorePower
+{
+	int pstate;
+	int cstate;                 // idle state, -1 while the core runs a process
+	SimTime idle_since;         // time the core went idle
+	double idle_predict;        // moving average of the idle periods, in ticks
+	SimTime period_busy;        // busy time in the current governor period
+	unsigned int wakeups;
+	double joules;
+	SimTime pstate_time[MAX_PSTATES];
+	SimTime cstate_time[MAX_CSTATES];
+} CorePower;
+
+// Energy model of the cores: busy cores draw the power of their P-state, chosen by the governor
+// from the utilization of the last period, idle cores the power of the C-state chosen for the
+// predicted idle period. Powers scale with the speed of the core (see core_capacity.h), whose
+// frequency factor and wakeup stall this model drives. The struct has a single pointer, a
+// checkpoint saves it with the array of the cores.
+typedef struct EnergyModel
+{
+	Governor governor;
+	unsigned int cores;
+	SimTime period;             // EN_GOVERNOR_PERIOD in ticks
+	SimTime next_update;        // time of the next decision of the governor
+	double busy_joules;
+	double idle_joules;
+	CorePower *core;
+} EnergyModel;
+
+int Energy_governor(const char *name);
+EnergyModel *Energy_create(const char *governor, int cores, SimTime ticks_per_ms);
+void Energy_tick(EnergyModel *en, struct FakeOS *os);
+double Energy_joules(const EnergyModel *en);
+void Energy_print(const EnergyModel *en, const struct FakeOS *os);
+void Energy_destroy(EnergyModel *en);
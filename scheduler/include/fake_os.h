@@ -1,7 +1,20 @@
 #pragma once
 
+#include <stddef.h>
+
 #include "fake_process.h"
 #include "linked_list.h"
+#include "latency_hist.h"
+#include "sampler.h"
+#include "accounting.h"
+#include "report.h"
+#include "quantum_tuner.h"
+#include "core_capacity.h"
+#include "energy.h"
+#include "topology.h"
+#include "profiler.h"
+#include "mem_stats.h"
+#include "../../generator/include/trace_stream.h"
 
 #define ANSI_ORANGE "\x1b[38;5;208m"
 #define ANSI_GREY "\x1b[38;5;240m"
@@ -16,10 +29,13 @@
 #define PREDICTION_WEIGHT 0.125 // 1/8 
 #define AGING_FACTOR 5 // 5 times the mean burst time
 #define MLFQ_QUEUES 5
+// trace of the simulation steps, printed only when the OS is verbose
+#define OS_LOG(os, ...) do { if ((os)->verbose) printf(__VA_ARGS__); } while (0)
+
+#define MAX_READY_LEVELS ((MLFQ_QUEUES > MAX_PRIORITY) ? MLFQ_QUEUES : MAX_PRIORITY)
 
 
 struct FakeOS;
-typedef void (*ScheduleFn)(struct FakeOS *os, void *args);
 
 typedef enum SchedulerType
 {
@@ -37,102 +53,203 @@ typedef enum SchedulerType
 	MAX_SCHEDULERS // add a new scheduler before this one
 } SchedulerType;
 
-
-
+/*
+ * Operations of a scheduling policy. The arguments returned by init are the state of the policy
+ * and own its ready set: the OS only reaches the ready processes through these hooks.
+ * A scheduling step picks a process for every idle core, with pick_batch in a single pass
+ * when the policy has it, then calls dispatcher and on_preempt on each of them in order.
+ */
+typedef void (*SchedEnqueueFn)(void *args, struct FakeOS *os, FakePCB *pcb);
+typedef FakePCB *(*SchedPickFn)(void *args, struct FakeOS *os);
+typedef int (*SchedPickBatchFn)(void *args, struct FakeOS *os, FakePCB **picked, int k);
+typedef double (*SchedRankFn)(void *args, struct FakeOS *os, FakePCB *pcb);
+typedef void (*SchedPreemptFn)(void *args, struct FakeOS *os, FakePCB *pcb);
+
+typedef struct SchedOps
+{
+	void *(*init)(SimTime quantum, SchedulerType scheduler);           // arguments with an empty ready set
+	void (*destroy)(void *args);
+	void (*proc_init)(PCBHot *hot, FakePCB *pcb);                       // per process keys, NULL if none
+	SchedEnqueueFn enqueue;
+	SchedPickFn pick;                                                   // detach the next process, NULL if none
+	SchedPickBatchFn pick_batch;                                        // detach up to k processes, NULL to repeat pick
+	SchedPreemptFn on_preempt;                                          // split the burst of the dispatched process
+	void (*on_tick)(void *args, struct FakeOS *os);                     // once per step before scheduling, may be NULL
+	int (*stats)(void *args, ListHead **levels);                        // ready lists by level, returns their number
+	void (*print)(void *args, struct FakeOS *os);
+	void (*set_quantum)(void *args, SimTime quantum);                   // change the quantum, NULL if it has none
+	SchedRankFn rank;                                                   // order of the processes, lower runs first, NULL if none
+} SchedOps;
+
+// the single queue schedulers start with their ready list (see sched_enqueue in sched_inline.h)
 typedef struct
 {
-	int quantum;
+	ListHead ready;
+	SimTime quantum;
 	int preemptive;
 } SchedFCFSArgs;
 
 typedef struct 
 {
-	int quantum;
+	ListHead ready;
+	SimTime quantum;
 	int prediction;
 	int preemptive;
 } SchedSJFArgs;
 
 typedef struct 
 {
-	int quantum;
+	ListHead ready;
+	SimTime quantum;
 } SchedRRArgs;
 
 typedef struct 
 {
+	ListHead ready;
 	int preemptive;
-	int quantum;
-	unsigned int agingThreshold;
+	SimTime quantum;
+	SimTime agingThreshold;
 } SchedPriorArgs;
 
+// every queue is run by a policy of its own, which holds the queue
 typedef struct 
 {
 	int num_ready_queues;
 	int high_priority_queues;
+	int hpq_time;   // times the high and low priority queues were scheduled
+	int lpq_time;
 	void **schedule_args;
-	ScheduleFn *schedule_fn;
-	ListHead *ready;
+	const SchedOps **ops;
+	ListHead **ready;
 } SchedMLQArgs;
 
 typedef struct 
 {
 	int num_ready_queues;
-	unsigned int agingThreshold;
+	int high_priority_queues;
+	SimTime agingThreshold;
 	void **schedule_args;
-	ScheduleFn *schedule_fn;
-	ListHead *ready;
+	const SchedOps **ops;
+	ListHead **ready;
 } SchedMLFQArgs;
 
 
 
+// Statistics of the terminated processes, constant memory whatever the number of processes
+typedef struct
+{
+	unsigned int completed;
+	LatencyHist turnaround;
+	LatencyHist waiting;
+	LatencyHist response;
+} SimStats;
+
 typedef struct FakeOS
 {
-	unsigned int timer;
+	SimTime timer;
+	SimTime ticks_per_ms;            // resolution of the timebase (see timebase.h), 1 for ms ticks
 	unsigned int cores;
 	FakePCB **running;
-	ListHead ready;
 	ListHead waiting;
 	SchedulerType scheduler;
-	ScheduleFn schedule_fn;
-	void *schedule_args; 
+	SimTime quantum;
+	const SchedOps *ops;
+	void *schedule_args;            // state of the scheduler, with the ready processes
+	void (*step)(struct FakeOS *os); // simulation step specialized for the scheduler
 	ListHead processes;
+	PCBTable pcbs;                   // keys and statistics of the live processes, by PCB id
+	unsigned int next_pid;           // pid of the next process created
+	TraceStream *stream; // pipeline mode: processes generated in memory instead of read from traces
 
 	// Statistiche
-	ListHead terminated_stats;
-	unsigned int cpu_busy_time; 
+	SimStats stats;
+	Accounting acct;                // per priority class and per source profile
+	SimTime cpu_busy_time;          // sum of the busy time of all the cores
+	SimTime *core_busy_time;        // busy time of each core
+	Sampler *sampler;               // time series, NULL if disabled
+	Report *report;                 // structured output, NULL if disabled
+	QuantumTuner *tuner;            // adaptive quantum, NULL if disabled
+	CoreCapacity *capacity;         // speeds of the cores, NULL if they are identical
+	EnergyModel *energy;            // power states of the cores, NULL if disabled
+	Topology *topology;             // NUMA layout of the cores, NULL if flat
+	SimTime wakeup_granularity;     // time a process runs before a wakeup can preempt it, -1 if disabled
+	SchedRankFn wakeup_rank;        // rank of the preemptive scheduler if the wakeup preemption is on, else NULL
+	FakePCB **woken;                // processes that entered the ready set in the current step
+	int num_woken;
+	int max_woken;
+	unsigned int wakeup_preemptions;
+	int verbose;                    // print the trace of every step
+	int mem_report;                 // print the memory accounting with the statistics
 } FakeOS;
 
 
 void printPCB(ListItem *item);
 char *print_priority(ProcessPriority priority);
+char *print_scheduler(SchedulerType scheduler);
 
 // function auxiliar for the scheduler
 void dispatcher(FakeOS *os, FakePCB *pcb);
-void sched_preemption(struct FakePCB *pcb, int quantum);
-int cmp(ListItem *a, ListItem *b);
-void resetAging(FakePCB *pcb);
-void MLQ_enqueue(FakeOS *os, FakePCB *pcb);
-void MLQ_destroyArgs(void *args_);
-void MLFQ_enqueue(FakeOS *os, FakePCB *pcb);
-void MLFQ_destroyArgs(void *args_);
-
-void SJF_printQueue(FakeOS *os);
-void Prior_printQueue(FakeOS *os);
-void MLFQ_printQueue(SchedMLFQArgs *args);
-void MLQ_printQueue(SchedMLQArgs *sched_args);
-
-void *FCFSArgs(int quantum, SchedulerType scheduler);
-void *SJFArgs(int quantum, enum SchedulerType scheduler);
-void *PriorArgs(int quantum, float aging_threshold, enum SchedulerType scheduler);
-void *RRArgs(int quantum, enum SchedulerType scheduler);
-void *MLQArgs(int quantum);
-void *MLFQArgs(int quantum, float aging_threshold);
-
-void schedFCFS(FakeOS *os, void *args_);
-void schedSJF(FakeOS *os, void *args_);
-void schedRR(FakeOS *os, void *args_);
-void schedPriority(FakeOS *os, void *args_);
-void schedMLQ(FakeOS *os, void *args_);
-void schedMLFQ(FakeOS *os, void *args_);
+void sched_preemption(struct FakePCB *pcb, SimTime quantum);
+int sched_levels(void *args_, ListHead **levels);
+void sched_printQueue(void *args_, FakeOS *os);
+
+void *FCFSArgs(SimTime quantum, SchedulerType scheduler);
+void *SJFArgs(SimTime quantum, SchedulerType scheduler);
+void *PriorArgs(SimTime quantum, SchedulerType scheduler);
+void *RRArgs(SimTime quantum, SchedulerType scheduler);
+void *MLQArgs(SimTime quantum, SchedulerType scheduler);
+void *MLFQArgs(SimTime quantum, SchedulerType scheduler);
+
+extern const SchedOps FCFS_ops;
+extern const SchedOps SJF_ops;
+extern const SchedOps SJFPure_ops;
+extern const SchedOps Prior_ops;
+extern const SchedOps RR_ops;
+extern const SchedOps MLQ_ops;
+extern const SchedOps MLFQ_ops;
+
+/**
+ * @brief Scheduler keys of a process, in the hot array of the OS
+ *
+ * @param os
+ * @param pcb
+ * @return PCBHot*
+ */
+static inline PCBHot *FakeOS_hot(const FakeOS *os, const FakePCB *pcb)
+{
+	return &os->pcbs.hot[pcb->id];
+}
+
+/**
+ * @brief Statistics of a process, in the cold array of the OS
+ *
+ * @param os
+ * @param pcb
+ * @return ProcessStats*
+ */
+static inline ProcessStats *FakeOS_cold(const FakeOS *os, const FakePCB *pcb)
+{
+	return &os->pcbs.cold[pcb->id];
+}
 
 void FakeOS_procUpdateStats(FakeOS *os, FakePCB *pcb, ProcStatsType type);
-void FakeOS_enqueueProcess(FakeOS *os, FakePCB *pcb);
\ No newline at end of file
+void FakeOS_recordStats(FakeOS *os, FakePCB *pcb);
+void FakeOS_enqueueProcess(FakeOS *os, FakePCB *pcb);
+void FakeOS_destroyPCB(FakeOS *os, FakePCB *pcb);
+
+void FakeOS_init(FakeOS *os, int cores);
+void FakeOS_setScheduler(FakeOS *os, SchedulerType scheduler, SimTime quantum);
+void FakeOS_switchScheduler(FakeOS *os, SchedulerType scheduler, SimTime quantum);
+int FakeOS_setWakeupPreemption(FakeOS *os, SimTime granularity);
+int FakeOS_setEnergy(FakeOS *os, const char *governor);
+int FakeOS_setTopology(FakeOS *os, const char *spec);
+void FakeOS_createProcess(FakeOS *os, const char *proc_file);
+void FakeOS_streamProcesses(FakeOS *os);
+int FakeOS_readyLists(FakeOS *os, ListHead **lists);
+int FakeOS_readyLevels(FakeOS *os, int *sizes);
+void FakeOS_schedule(FakeOS *os);
+int FakeOS_scheduleBatch(FakeOS *os, int k);
+void FakeOS_simStep(FakeOS *os);
+int FakeOS_finished(FakeOS *os);
+void FakeOS_calculateStatistics(FakeOS *os);
+void FakeOS_destroy(FakeOS *os);
@@ -1,10 +1,11 @@
 #pragma once
 
 #include "linked_list.h"
+#include "timebase.h"
 
 
 // forward declaration
-enum SchedulerType;
+struct SchedOps;
 
 typedef enum
 {
@@ -34,77 +35,90 @@ typedef enum procstatstype
 
 
 
-typedef struct
-{
-    double previousPrediction;
-} ProcSJFArgs;
-
-typedef struct
-{
-	unsigned int last_aging;
-	ProcessPriority curr_priority;
-} ProcPriorArgs;
-
-typedef struct 
-{
-	int queue;
-} ProcMLQArgs;
-
-typedef struct 
-{
-	int queue;
-	unsigned int last_aging;
-} ProcMLFQArgs;
-
-
-
 typedef struct ProcessEvent
 {
 	ListItem list;
 	ResourceType type;
-	int duration;
+	SimTime duration;
 } ProcessEvent;
 
 typedef struct ProcessStats
 {
-	ListItem list;
-	unsigned int arrival_time;
-	unsigned int waiting_time;
-	unsigned int last_ready_enqueue;
-	unsigned int turnaround_time;
-	unsigned int response_time;
-	unsigned int complete_time;
+	SimTime arrival_time;
+	SimTime waiting_time;
+	SimTime turnaround_time;
+	SimTime response_time;
+	SimTime complete_time;
+	SimTime cpu_time;
+	SimTime burst_start;        // cpu_time when the current CPU burst started
 } ProcessStats;
 
 typedef struct FakeProcess
 {
 	ListItem list;
 	int pid;
-	int arrival_time;
+	SimTime arrival_time;
 	ProcessPriority priority;
+	int source;     // source profile id in the accounting, -1 if unknown
 	ListHead events;
 } FakeProcess;
 
+// Scheduler keys of a process: the picks scan them for every ready process, they live in a
+// contiguous array of the OS at the id of the PCB (see PCBTable) instead of behind its pointers
+typedef struct PCBHot
+{
+	SimTime burst;              // first CPU event when it entered the ready set, the SJF key
+	double prediction;          // SJF: last prediction
+	SimTime ready_since;        // last time it entered the ready set, the aging key
+	SimTime last_aging;         // Priority, MLFQ: last time it was aged
+	int level;                  // current priority (Priority) or queue (MLQ, MLFQ)
+} PCBHot;
+
+// Slots of the live processes: the hot keys and the cold statistics of a process are at its id
+// in two arrays, the ids of the terminated processes are reused so the arrays stay as large as
+// the processes alive at once
+typedef struct PCBTable
+{
+	PCBHot *hot;
+	ProcessStats *cold;
+	int *free_ids;              // stack of the released ids
+	int num_free;
+	int size;                   // ids handed out
+	int capacity;
+} PCBTable;
+
+// the fields of the running process and of the list scans first, the rest after
 typedef struct FakePCB
 {
 	ListItem list;
 	int pid;
-	int duration;
+	int id;             // slot in the PCBTable of the OS
+	SimTime duration;   // run time of the current dispatch
 	int quantum_used;
-	void *args;
-	ProcessStats *stats;
-	ProcessPriority priority;
 	ListHead events;
+	ProcessPriority priority;
+	int source;
+	int home_node;      // NUMA node of its memory, -1 before its first run or without a topology
+	int remote_passes;  // NUMA balancing passes it ran away from home
 } FakePCB;
 
 
 void printProcessEvent(ListItem *item);
-void FakeProcess_SJFArgs(FakePCB *pcb);
-void FakeProcess_setArgs(FakePCB *pcb, enum SchedulerType scheduler);
-ProcessStats *FakeProcess_initiStats();
-void FakeProcess_arrivalTime(FakePCB *pcb, unsigned int timer);
-void FakeProcess_lastEnqueuedTime(FakePCB *pcb, unsigned int timer);
-void FakeProcess_waitingTime(FakePCB *pcb, unsigned int timer);
-void FakeProcess_completeTime(FakePCB *pcb, unsigned int timer);
-void FakeProcess_turnaroundTime(FakePCB *pcb, unsigned int timer);
-void FakeProcess_responseTime(FakePCB *pcb, unsigned int timer);
+void FakeProcess_SJFArgs(PCBHot *hot, FakePCB *pcb);
+void FakeProcess_PriorArgs(PCBHot *hot, FakePCB *pcb);
+void FakeProcess_MLQArgs(PCBHot *hot, FakePCB *pcb);
+void FakeProcess_MLFQArgs(PCBHot *hot, FakePCB *pcb);
+void FakeProcess_setArgs(PCBHot *hot, FakePCB *pcb, const struct SchedOps *ops);
+void FakeProcess_initiStats(ProcessStats *stats);
+void FakeProcess_arrivalTime(ProcessStats *stats, SimTime timer);
+void FakeProcess_lastEnqueuedTime(PCBHot *hot, SimTime timer);
+void FakeProcess_waitingTime(ProcessStats *stats, const PCBHot *hot, SimTime timer);
+void FakeProcess_completeTime(ProcessStats *stats, SimTime timer);
+void FakeProcess_turnaroundTime(ProcessStats *stats, SimTime timer);
+void FakeProcess_responseTime(ProcessStats *stats, SimTime timer);
+
+void PCBTable_init(PCBTable *table);
+int PCBTable_alloc(PCBTable *table);
+void PCBTable_release(PCBTable *table, int id);
+void PCBTable_restore(PCBTable *table, int capacity, int size);
+void PCBTable_destroy(PCBTable *table);
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <stdint.h>
+
+// Log-linear histogram (HDR histogram like): values below 2 * LHIST_SUB_BUCKETS are exact,
+// above that every power of two is split in LHIST_SUB_BUCKETS buckets, so the relative
+// error of a percentile is below 1 / LHIST_SUB_BUCKETS. Memory is constant and two
+// histograms can be merged by adding their buckets.
+#define LHIST_SUB_BITS 6
+#define LHIST_SUB_BUCKETS (1 << LHIST_SUB_BITS)
+#define LHIST_BUCKETS ((64 - LHIST_SUB_BITS + 1) * LHIST_SUB_BUCKETS)
+
+typedef struct
+{
+	uint64_t count;
+	uint64_t sum;
+	uint64_t min;
+	uint64_t max;
+	uint64_t *buckets;
+} LatencyHist;
+
+void LatencyHist_init(LatencyHist *h);
+void LatencyHist_reset(LatencyHist *h);
+void LatencyHist_destroy(LatencyHist *h);
+void LatencyHist_record(LatencyHist *h, uint64_t value);
+void LatencyHist_merge(LatencyHist *dst, const LatencyHist *src);
+double LatencyHist_mean(const LatencyHist *h);
+uint64_t LatencyHist_percentile(const LatencyHist *h, double percentile);
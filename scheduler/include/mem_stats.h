@@ -0,0 +1,107 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "timebase.h"
+
+// Objects of the simulation whose allocations are counted
+typedef enum MemType
+{
+	MEM_PROCESS,            // FakeProcess, from its creation to its arrival
+	MEM_EVENT,              // ProcessEvent, the slices included
+	MEM_SLICE,              // ProcessEvent split from a CPU burst at the end of a quantum (sched_preemption):
+	                        // allocations only, the slices are freed as events
+	MEM_PCB,                // FakePCB
+	MEM_PCB_KEYS,           // scheduler keys of the PCB table (PCBHot), the whole capacity
+	MEM_PROCESS_STATS,      // statistics of the PCB table (ProcessStats), the whole capacity
+	MEM_SCHED_ARGS,         // arguments of the scheduler
+	MAX_MEM_TYPES
+} MemType;
+
+typedef struct
+{
+	uint64_t allocs;
+	uint64_t frees;
+	uint64_t bytes;         // allocated since the start
+	int64_t live;           // bytes
+	int64_t peak;           // bytes
+} MemCounters;
+
+// Allocations of the thread: every replica counts its own, without atomics
+typedef struct
+{
+	MemCounters type[MAX_MEM_TYPES];
+	int64_t live;           // bytes of all the types
+	int64_t peak;
+} MemStats;
+
+extern __thread MemStats mem_stats;
+
+const char *MemStats_name(MemType type);
+void MemStats_count(MemType type, size_t size);
+uint64_t MemStats_allocs(void);
+long MemStats_maxRss(void);
+void MemStats_print(SimTime timer, SimTime ticks_per_ms);
+
+/**
+ * @brief Account an allocation (size > 0) or a free (size < 0)
+ *
+ * @param type
+ * @param size bytes
+ */
+static inline void MemStats_account(MemType type, int64_t size)
+{
+	MemCounters *c = &mem_stats.type[type];
+
+	if (size > 0)
+	{
+		c->allocs++;
+		c->bytes += size;
+	}
+	else
+		c->frees++;
+	if ((c->live += size) > c->peak)
+		c->peak = c->live;
+	if ((mem_stats.live += size) > mem_stats.peak)
+		mem_stats.peak = mem_stats.live;
+}
+
+static inline void *MemStats_alloc(MemType type, size_t size)
+{
+	void *ptr = malloc(size);
+
+	if (ptr)
+		MemStats_account(type, size);
+	return ptr;
+}
+
+static inline void MemStats_free(MemType type, void *ptr, size_t size)
+{
+	if (!ptr)
+		return;
+	MemStats_account(type, -(int64_t)size);
+	free(ptr);
+}
+
+/**
+ * @brief realloc, counted as the free of the old block and the allocation of the new one
+ *
+ * @param type
+ * @param ptr
+ * @param old_size bytes of ptr, 0 if NULL
+ * @param size
+ * @return void* NULL if it failed, ptr is then still allocated
+ */
+static inline void *MemStats_realloc(MemType type, void *ptr, size_t old_size, size_t size)
+{
+	void *new_ptr = realloc(ptr, size);
+
+	if (!new_ptr)
+		return NULL;
+	if (ptr)
+		MemStats_account(type, -(int64_t)old_size);
+	MemStats_account(type, size);
+	return new_ptr;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+// Phase profiler of the simulation step, compiled in only with -DSIM_PROFILE (make PROFILE=1).
+// Without it the macros expand to nothing and the simulator is unchanged.
+
+typedef enum ProfPhase
+{
+	PROF_ARRIVALS,      // processes arriving in the step
+	PROF_WAITING,       // update of the waiting queue
+	PROF_RUNNING,       // update of the running cores
+	PROF_READY_PRINT,   // print of the ready queue
+	PROF_SCHEDULING,    // scheduling loop, FakeOS_schedule calls included
+	PROF_SCHEDULE,      // single FakeOS_schedule calls
+	PROF_TICK,          // end of the step: durations, timer and sampler
+	MAX_PROF_PHASES
+} ProfPhase;
+
+#ifdef SIM_PROFILE
+
+void Profiler_begin(ProfPhase phase);
+void Profiler_end(ProfPhase phase);
+void Profiler_print(void);
+
+#define PROFILE_BEGIN(phase) Profiler_begin(phase)
+#define PROFILE_END(phase) Profiler_end(phase)
+
+#else
+
+#define PROFILE_BEGIN(phase) ((void)0)
+#define PROFILE_END(phase) ((void)0)
+
+#endif
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "timebase.h"
+
+struct FakeOS;
+
+#define QT_PERIOD 100           // ms between two recomputations of the quantum
+#define QT_GAIN 0.02            // relative step of the percentile estimate at every burst
+#define QT_HYSTERESIS 0.20      // the quantum changes only if the new one differs by more than this
+#define QT_EWMA 0.05            // weight of a new response time in its moving average
+#define QT_FEEDBACK_STEP 0.10   // relative correction of the feedback loop at every recomputation
+#define QT_MIN_FACTOR 0.25
+#define QT_MAX_FACTOR 4.0
+
+// Adaptive quantum of RR and of the RR levels of MLQ/MLFQ: the quantum follows a running
+// estimate of a percentile of the observed CPU bursts (the time a process runs before it
+// blocks), within bounds. A response time target scales it with a feedback loop: shorter
+// slices when the first responses are too slow, longer when they are well below the target.
+// The struct has no pointers, a checkpoint saves it as it is.
+typedef struct QuantumTuner
+{
+	double percentile;          // of the bursts, in (0, 100)
+	SimTime min_quantum;
+	SimTime max_quantum;
+	SimTime response_target;    // 0 without the feedback loop
+	SimTime period;             // QT_PERIOD in ticks
+
+	SimTime quantum;            // quantum in use
+	double burst_estimate;      // running estimate of the percentile of the bursts
+	double response_avg;        // moving average of the response times
+	double factor;              // correction of the feedback loop
+	unsigned long bursts;       // bursts observed
+	unsigned long responses;    // response times observed
+	SimTime next_update;        // time of the next recomputation
+	unsigned int changes;       // times the quantum changed
+} QuantumTuner;
+
+QuantumTuner *QuantumTuner_create(const char *spec, SimTime quantum, SimTime response_target, SimTime ticks_per_ms);
+void QuantumTuner_observeBurst(QuantumTuner *qt, SimTime burst);
+void QuantumTuner_observeResponse(QuantumTuner *qt, SimTime response);
+void QuantumTuner_update(QuantumTuner *qt, struct FakeOS *os);
+void QuantumTuner_apply(QuantumTuner *qt, struct FakeOS *os);
+void QuantumTuner_print(const QuantumTuner *qt, const char *unit);
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "branch.h"
+
+#define MAX_REPLICAS 100000
+
+// Workload and parallelism of a Monte Carlo run
+typedef struct
+{
+	const char *histogram_folder;
+	int cores;
+	int num_procs;
+	int num_bursts;
+	int window;
+	uint64_t seed;  // replica r is generated with seed + r
+	int replicas;
+	int threads;    // <= 0 for one per online cpu
+	SimTime ticks_per_ms;           // timebase of the simulations
+	const char *adaptive_quantum;   // spec of QuantumTuner_create for the schedulers with a quantum, NULL for none
+	SimTime response_target;
+	SimTime wakeup_granularity;     // -1 for none, else for the schedulers that preempt on wakeup
+	const char *core_speeds;        // NULL for identical cores
+	const char *energy;             // governor of the energy model, NULL without
+	const char *topology;           // NUMA layout, NULL for none
+	int numa_flat;
+} ReplicaConfig;
+
+void Replica_run(const ReplicaConfig *config, const BranchVariant *schedulers, int num_schedulers);
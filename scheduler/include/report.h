@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+
+struct FakeOS;
+struct FakePCB;
+
+#define REPORT_MAX_DEPTH 8
+#define REPORT_MAX_PHASES 8
+
+typedef enum
+{
+	REPORT_JSON,
+	REPORT_CSV
+} ReportFormat;
+
+// Configuration of the run, copied in the report
+typedef struct
+{
+	int cores;
+	int scheduler;
+	int64_t quantum;                // in ticks
+	const char *timebase;           // unit of the ticks
+	const char *traces_folder;      // NULL in pipeline mode
+	const char *histogram_folder;   // NULL reading the traces
+	int procs;
+	int bursts;
+	int window;
+	uint64_t seed;
+} RunConfig;
+
+// Structured output of a run. JSON is a single document, CSV is a <section>,<metric>,<value> table
+// with the per process records in a second file, <output>.processes.csv.
+// The per process records are written when the processes terminate, nothing is kept in memory.
+typedef struct Report
+{
+	ReportFormat format;
+	char *filename;
+	FILE *out;
+	FILE *procs_out;
+	int depth;
+	int first[REPORT_MAX_DEPTH];            // JSON: no element written yet at this depth
+	const char *keys[REPORT_MAX_DEPTH];     // CSV: path of the current element
+	int num_phases;
+	const char *phase_names[REPORT_MAX_PHASES];
+	double phase_seconds[REPORT_MAX_PHASES];
+} Report;
+
+Report *Report_open(ReportFormat format, const char *filename, const RunConfig *config);
+void Report_process(Report *r, struct FakeOS *os, struct FakePCB *pcb);
+void Report_phase(Report *r, const char *name, double seconds);
+void Report_close(Report *r, struct FakeOS *os);
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <stdio.h>
+
+#include "timebase.h"
+
+struct FakeOS;
+
+// Time series of the simulation: every interval ticks a row with the busy time of each core,
+// the length of each ready queue level, the length of the waiting queue and the completions
+typedef struct Sampler
+{
+	FILE *out;
+	char *filename;
+	SimTime interval;
+	SimTime start;                  // start time of the current interval
+	unsigned int cores;
+	SimTime *last_core_busy;        // cumulative busy time of the cores at the start of the interval
+	unsigned int last_completed;    // cumulative completions at the start of the interval
+} Sampler;
+
+Sampler *Sampler_open(struct FakeOS *os, const char *filename, SimTime interval);
+void Sampler_step(Sampler *sampler, struct FakeOS *os);
+void Sampler_close(Sampler *sampler, struct FakeOS *os);
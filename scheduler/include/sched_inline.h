@@ -0,0 +1,721 @@
+#pragma once
+
+#include <assert.h>
+#include <stdlib.h>
+#include <limits.h>
+
+#include "fake_os.h"
+
+/*
+ * Hot hooks of the schedulers: enqueue, pick, pick_batch and on_preempt of every policy.
+ * They are static inline so that the step loop of fake_os.c, instantiated per policy,
+ * inlines them instead of calling through the SchedOps table; the sched_*.c files
+ * take their address for the tables. MLQ and MLFQ call the hooks of their levels directly.
+ * The scans read the keys of the processes in the hot array of the OS, by PCB id: a ready
+ * process costs its list node and its slot, not its events and per process arguments.
+ */
+
+/********************************* single queue *********************************/
+
+/**
+ * @brief Enqueue hook of the single queue schedulers: the process goes at the end of the ready list.
+ * Their arguments start with the ready list, so they can be used as a ListHead.
+ *
+ * @param args_ The arguments of the scheduler.
+ * @param os The fake OS instance.
+ * @param pcb The process to enqueue.
+ */
+static inline void sched_enqueue(void *args_, FakeOS *os, FakePCB *pcb)
+{
+	List_pushBack((ListHead *)args_, (ListItem *)pcb);
+}
+
+/**
+ * @brief Insert a candidate among the best ones of a batch pick, kept sorted by key (lowest first).
+ * Candidates with the same key stay in the order they were offered, like repeated picks
+ * of the first best candidate of the ready list would give them.
+ *
+ * @param best The best candidates.
+ * @param keys Their keys.
+ * @param n Number of candidates in best.
+ * @param k Size of best.
+ * @param pcb The candidate.
+ * @param key Its key.
+ * @return int The new number of candidates.
+ */
+static inline int sched_topInsert(FakePCB **best, double *keys, int n, int k, FakePCB *pcb, double key)
+{
+	if (n == k && key >= keys[n - 1])
+		return n;
+
+	int i = (n < k) ? n++ : n - 1;
+	while (i > 0 && keys[i - 1] > key)
+	{
+		best[i] = best[i - 1];
+		keys[i] = keys[i - 1];
+		i--;
+	}
+	best[i] = pcb;
+	keys[i] = key;
+	return n;
+}
+
+/********************************* FCFS *********************************/
+
+static inline FakePCB *FCFS_pick(void *args_, FakeOS *os)
+{
+	SchedFCFSArgs *args = (SchedFCFSArgs *)args_;
+
+	// look for the first process in ready
+	// if none, return
+	if (!args->ready.first)
+		return NULL;
+
+	FakePCB *pcb = (FakePCB *)List_popFront(&args->ready);
+	pcb->duration = 0;
+	return pcb;
+}
+
+static inline void FCFS_onPreempt(void *args_, FakeOS *os, FakePCB *pcb)
+{
+	SchedFCFSArgs *args = (SchedFCFSArgs *)args_;
+
+	/*********************** FCFS Preemptive ***********************/
+	// Preempt the current CPU burst event if it exceeds the given quantum
+	if (args->preemptive)
+		sched_preemption(pcb, args->quantum);
+}
+
+/********************************* RR *********************************/
+
+static inline FakePCB *RR_pick(void *args_, FakeOS *os)
+{
+	SchedRRArgs *args = (SchedRRArgs *)args_;
+
+	// look for the first process in ready
+	// if none, return
+	if (!args->ready.first)
+		return NULL;
+
+	// take the first process in ready queue
+	FakePCB *pcb = (FakePCB *)List_popFront(&args->ready);
+	pcb->duration = 0;
+	return pcb;
+}
+
+static inline void RR_onPreempt(void *args_, FakeOS *os, FakePCB *pcb)
+{
+	SchedRRArgs *args = (SchedRRArgs *)args_;
+
+	/*********************** RR Preemptive ***********************/
+	// Preempt the current CPU burst event if it exceeds the given quantum
+	sched_preemption(pcb, args->quantum);
+}
+
+/********************************* SJF *********************************/
+
+/**
+ * @brief The new prediction of a process: a weighted average of the previous prediction and the current burst time.
+ * If the burst time is greater than the quantum, the quantum is used instead.
+ *
+ * @param oldPrediction The previous prediction of the process.
+ * @param burst The current burst time.
+ * @param quantum The time of the quantum to use in the prediction calculation.
+ * @return double The new prediction, not stored in the process.
+ */
+static inline double SJF_predict(double oldPrediction, SimTime burst, SimTime quantum)
+{
+	double currPrediction;
+
+	if (quantum)
+		currPrediction = (burst < quantum) ? burst : quantum;
+	else
+		currPrediction = burst;
+
+	return PREDICTION_WEIGHT * currPrediction + (1 - PREDICTION_WEIGHT) * oldPrediction;
+}
+
+/**
+ * @brief This function iterates through the list of processes and calculates the prediction time for each process.
+ * The process with the shortest prediction time is returned.
+ *
+ * @param keys The hot array of the OS.
+ * @param items The list of processes to choose from and calculate the prediction.
+ * @param quantum The time of the quantum to use in the prediction calculation.
+ * @return The process with the shortest prediction time.
+ *
+ */
+static inline FakePCB *prediction(PCBHot *keys, ListItem *items, SimTime quantum)
+{
+	FakePCB *proc;
+	FakePCB *shortProcess = NULL;
+	double shortPrediction = __DBL_MAX__;
+
+	while ((proc = (FakePCB *)items) != NULL)
+	{
+		PCBHot *hot = &keys[proc->id];
+		double newPrediction = SJF_predict(hot->prediction, hot->burst, quantum);
+		if (newPrediction < shortPrediction)
+		{
+			shortPrediction = newPrediction;
+			shortProcess = proc;
+			hot->prediction = newPrediction;
+		}
+		items = items->next;
+	}
+
+	return shortProcess;
+}
+
+/**
+ * @brief The process with the shortest CPU burst, the first one of the list among equal bursts:
+ * the one a stable sort of the list would put first.
+ *
+ * @param keys The hot array of the OS.
+ * @param items The list of processes to choose from.
+ * @return The process with the shortest CPU burst.
+ */
+static inline FakePCB *shortestBurst(PCBHot *keys, ListItem *items)
+{
+	FakePCB *shortProcess = NULL;
+	SimTime shortBurst = INT64_MAX;
+
+	for (; items; items = items->next)
+	{
+		FakePCB *proc = (FakePCB *)items;
+		if (keys[proc->id].burst < shortBurst)
+		{
+			shortBurst = keys[proc->id].burst;
+			shortProcess = proc;
+		}
+	}
+
+	return shortProcess;
+}
+
+/**
+ * @brief Pick the next process of the SJF scheduler.
+ * With prediction the process with the shortest prediction time is selected and its duration set to 0,
+ * without it the one with the shortest CPU burst. The process is removed from the ready list.
+ *
+ * @param args_ The arguments for the SJF scheduler
+ * @param os The fake OS instance
+ * @return FakePCB* the process to run, NULL if the ready list is empty
+ */
+static inline FakePCB *SJF_pick(void *args_, FakeOS *os)
+{
+	SchedSJFArgs *args = (SchedSJFArgs *)args_;
+	FakePCB *pcb = NULL;
+
+	// look for the first process in ready
+	// if none, return
+	if (!args->ready.first)
+		return NULL;
+
+	/*********************** SJF with prediction ***********************/
+	// look for the process with the shortest prediction time
+	if (args->prediction)
+	{
+		pcb = prediction(os->pcbs.hot, args->ready.first, args->quantum);
+		if (pcb)
+			pcb->duration = 0;
+	}
+	/*********************** pure SJF case (no prediction) ***********************/
+	// look for the process with the shortest CPU burst time
+	else
+		pcb = shortestBurst(os->pcbs.hot, args->ready.first);
+
+	// remove it from the ready list
+	return (FakePCB *)List_detach(&args->ready, (ListItem *)pcb);
+}
+
+/**
+ * @brief Pick up to k processes of the SJF scheduler in a single pass.
+ * With prediction the ready list is scanned once, the predictions are updated as in a single
+ * prediction() scan and the k shortest ones are taken; without it the k shortest bursts.
+ *
+ * @param args_ The arguments for the SJF scheduler
+ * @param os The fake OS instance
+ * @param picked Array of k elements to fill, in the order the processes are dispatched
+ * @param k Number of idle cores
+ * @return int The number of processes picked
+ */
+static inline int SJF_pickBatch(void *args_, FakeOS *os, FakePCB **picked, int k)
+{
+	SchedSJFArgs *args = (SchedSJFArgs *)args_;
+	PCBHot *hot = os->pcbs.hot;
+	double keys[k];
+	int n = 0;
+
+	if (args->prediction)
+	{
+		double shortPrediction = __DBL_MAX__;
+
+		for (ListItem *item = args->ready.first; item; item = item->next)
+		{
+			FakePCB *proc = (FakePCB *)item;
+			double newPrediction = SJF_predict(hot[proc->id].prediction, hot[proc->id].burst, args->quantum);
+
+			n = sched_topInsert(picked, keys, n, k, proc, newPrediction);
+			if (newPrediction < shortPrediction)
+			{
+				shortPrediction = newPrediction;
+				hot[proc->id].prediction = newPrediction;
+			}
+		}
+	}
+	else
+	{
+		// the shortest bursts in the order a stable sort would give them
+		for (ListItem *item = args->ready.first; item; item = item->next)
+			n = sched_topInsert(picked, keys, n, k, (FakePCB *)item, hot[((FakePCB *)item)->id].burst);
+	}
+
+	for (int i = 0; i < n; i++)
+	{
+		List_detach(&args->ready, (ListItem *)picked[i]);
+		picked[i]->duration = 0;
+	}
+	return n;
+}
+
+/**
+ * @brief If the CPU burst of the dispatched process is longer than the quantum,
+ * a CPU event of the quantum is added to the front of its event list and
+ * the duration of the original CPU event is reduced by the quantum.
+ *
+ * @param args_ The arguments for the SJF scheduler
+ * @param os The fake OS instance
+ * @param pcb The dispatched process
+ */
+static inline void SJF_onPreempt(void *args_, FakeOS *os, FakePCB *pcb)
+{
+	SchedSJFArgs *args = (SchedSJFArgs *)args_;
+
+	/*********************** SJF Preemptive ***********************/
+	if (args->preemptive)
+		sched_preemption(pcb, args->quantum);
+}
+
+/**
+ * @brief The CPU time a process still needs before it blocks: its first CPU event
+ * and the ones right after it (the rest of a burst split by the quantum).
+ *
+ * @param pcb The process
+ * @return SimTime The remaining time of the burst
+ */
+static inline SimTime sched_remainingBurst(FakePCB *pcb)
+{
+	SimTime remaining = 0;
+
+	for (ListItem *item = pcb->events.first; item && ((ProcessEvent *)item)->type == CPU; item = item->next)
+		remaining += ((ProcessEvent *)item)->duration;
+	return remaining;
+}
+
+/**
+ * @brief Rank of a process for the wakeup preemption, lower runs first:
+ * its prediction with prediction, the remaining burst without.
+ *
+ * @param args_ The arguments for the SJF scheduler
+ * @param os The fake OS instance
+ * @param pcb A ready or running process, its key is the burst left in its first event
+ * @return double The rank
+ */
+static inline double SJF_rank(void *args_, FakeOS *os, FakePCB *pcb)
+{
+	SchedSJFArgs *args = (SchedSJFArgs *)args_;
+	ProcessEvent *e = (ProcessEvent *)pcb->events.first;
+
+	assert(e->type == CPU);
+	if (args->prediction)
+		return SJF_predict(FakeOS_hot(os, pcb)->prediction, e->duration, args->quantum);
+	return sched_remainingBurst(pcb);
+}
+
+/********************************* Priority *********************************/
+
+static inline void resetAging(FakeOS *os, FakePCB *pcb)
+{
+	FakeOS_hot(os, pcb)->level = pcb->priority;
+}
+
+static inline void agingProc(SchedPriorArgs *sched_args, FakeOS *os, PCBHot *hot)
+{
+	// max priority level to be incremented
+	ProcessPriority max_proc_priority = HIGH;
+
+	SimTime currTimer = os->timer;
+
+	if (hot->level > max_proc_priority)
+	{
+		if (currTimer - hot->ready_since >= sched_args->agingThreshold &&
+			currTimer - hot->last_aging >= sched_args->agingThreshold)
+		{
+			hot->last_aging = currTimer;
+			hot->level--;
+		}
+	}
+}
+
+static inline FakePCB *getByPriority(SchedPriorArgs *sched_args, FakeOS *os)
+{
+	FakePCB *pcb;
+	FakePCB *highest_priority_pcb = NULL;
+	int highest_priority = 0;
+	PCBHot *keys = os->pcbs.hot;
+	ListItem *item = sched_args->ready.first;
+
+	while ((pcb = (FakePCB *)item) != NULL) {
+		// Aging process if wasn't scheduled for a long time
+		agingProc(sched_args, os, &keys[pcb->id]);
+		if (!highest_priority_pcb || keys[pcb->id].level < highest_priority)
+		{
+			highest_priority_pcb = pcb;
+			highest_priority = keys[pcb->id].level;
+		}
+		item = item->next;
+	}
+
+	return highest_priority_pcb;
+}
+
+static inline FakePCB *Prior_pick(void *args_, FakeOS *os)
+{
+	SchedPriorArgs *sched_args = (SchedPriorArgs *)args_;
+
+	if (!sched_args->ready.first)
+		return NULL;
+
+	FakePCB *pcb = getByPriority(sched_args, os);
+
+	// Rimuovi il processo dalla ready queue
+	List_detach(&sched_args->ready, (ListItem *)pcb);
+
+	assert(pcb->events.first);
+	ProcessEvent *e = (ProcessEvent *)pcb->events.first;
+	assert(e->type == CPU);
+
+	// the process runs with its base priority again
+	resetAging(os, pcb);
+	return pcb;
+}
+
+/**
+ * @brief Pick up to k processes of the priority scheduler in a single pass:
+ * the ready list is aged once and the k highest current priorities are taken.
+ *
+ * @param args_ The arguments of the priority scheduler.
+ * @param os The fake OS instance.
+ * @param picked Array of k elements to fill, in the order the processes are dispatched.
+ * @param k Number of idle cores.
+ * @return int The number of processes picked.
+ */
+static inline int Prior_pickBatch(void *args_, FakeOS *os, FakePCB **picked, int k)
+{
+	SchedPriorArgs *sched_args = (SchedPriorArgs *)args_;
+	PCBHot *hot = os->pcbs.hot;
+	double keys[k];
+	int n = 0;
+
+	for (ListItem *item = sched_args->ready.first; item; item = item->next)
+	{
+		FakePCB *pcb = (FakePCB *)item;
+
+		// Aging process if wasn't scheduled for a long time
+		agingProc(sched_args, os, &hot[pcb->id]);
+		n = sched_topInsert(picked, keys, n, k, pcb, hot[pcb->id].level);
+	}
+
+	for (int i = 0; i < n; i++)
+	{
+		List_detach(&sched_args->ready, (ListItem *)picked[i]);
+		assert(((ProcessEvent *)picked[i]->events.first)->type == CPU);
+		resetAging(os, picked[i]);
+	}
+	return n;
+}
+
+static inline void Prior_onPreempt(void *args_, FakeOS *os, FakePCB *pcb)
+{
+	SchedPriorArgs *sched_args = (SchedPriorArgs *)args_;
+
+	/*********************** Priority Preemptive ***********************/
+	// Preempt the current CPU burst event if it exceeds the given quantum
+	if (sched_args->preemptive)
+		sched_preemption(pcb, sched_args->quantum);
+}
+
+/**
+ * @brief Rank of a process for the wakeup preemption: its current priority, lower runs first.
+ *
+ * @param args_ The arguments of the priority scheduler.
+ * @param os The fake OS instance.
+ * @param pcb A ready or running process.
+ * @return double The rank.
+ */
+static inline double Prior_rank(void *args_, FakeOS *os, FakePCB *pcb)
+{
+	return FakeOS_hot(os, pcb)->level;
+}
+
+/********************************* MLQ *********************************/
+
+/**
+ * @brief Enqueue a process in the MLQ scheduler, in the queue of its priority.
+ *
+ * @param args_ The arguments of the MLQ scheduler.
+ * @param os The fake OS instance.
+ * @param pcb The process to enqueue.
+ */
+static inline void MLQ_enqueue(void *args_, FakeOS *os, FakePCB *pcb)
+{
+	SchedMLQArgs *sched_args = (SchedMLQArgs *)args_;
+	int queue = FakeOS_hot(os, pcb)->level;
+
+	// the RR and FCFS queues enqueue the same way
+	sched_enqueue(sched_args->schedule_args[queue], os, pcb);
+}
+
+static inline FakePCB *MLQ_pickLevel(FakeOS *os, SchedMLQArgs *args, int start, int end, int *time_counter)
+{
+	for (int i = start; i < end; i++)
+	{
+		if (args->ready[i]->size > 0)
+		{
+			(*time_counter)++;
+			// the high priority queues are RR, the others FCFS (see MLQArgs)
+			if (i < args->high_priority_queues)
+				return RR_pick(args->schedule_args[i], os);
+			return FCFS_pick(args->schedule_args[i], os);
+		}
+	}
+	return NULL;
+}
+
+/**
+ * @brief Pick a process in the MLQ scheduler, 80% time for high priority queues and 20% for low priority queues.
+ *
+ * @param args_ The arguments of the MLQ scheduler.
+ * @param os The fake OS instance.
+ * @return FakePCB* the process to run, NULL if all the queues are empty
+ */
+static inline FakePCB *MLQ_pick(void *args_, FakeOS *os)
+{
+	SchedMLQArgs *args = (SchedMLQArgs *)args_;
+
+	// total time spent on both queues
+	int total_time = args->hpq_time + args->lpq_time;
+
+	// check if high priority queues should be scheduled
+	// if the total time is 0 or the time spent on high priority queues is less than 80% of the total time
+	int should_schedule_hpq = (total_time == 0) || (args->hpq_time < 0.8 * total_time);
+
+	// variable to check if the high priority queue or the low priority queue is empty
+	short int hpq_empty = 1;
+	short int lpq_empty = 1;
+
+	for (int i = 0; i < args->num_ready_queues; i++)
+	{
+		int is_hpq = (i < args->high_priority_queues);
+
+		if (args->ready[i]->size > 0)
+		{
+			if (is_hpq)
+				hpq_empty = 0;
+			else
+				lpq_empty = 0;
+		}
+	}
+
+	if (should_schedule_hpq && !hpq_empty)
+		return MLQ_pickLevel(os, args, 0, args->high_priority_queues, &args->hpq_time);
+	else if (!lpq_empty)
+		return MLQ_pickLevel(os, args, args->high_priority_queues, args->num_ready_queues, &args->lpq_time);
+	else if (!hpq_empty)
+		return MLQ_pickLevel(os, args, 0, args->high_priority_queues, &args->hpq_time);
+	return NULL;
+}
+
+/**
+ * @brief The process runs under the policy of its queue, only the RR queues preempt.
+ *
+ * @param args_ The arguments of the MLQ scheduler.
+ * @param os The fake OS instance.
+ * @param pcb The dispatched process.
+ */
+static inline void MLQ_onPreempt(void *args_, FakeOS *os, FakePCB *pcb)
+{
+	SchedMLQArgs *args = (SchedMLQArgs *)args_;
+	int queue = FakeOS_hot(os, pcb)->level;
+
+	if (queue < args->high_priority_queues)
+		RR_onPreempt(args->schedule_args[queue], os, pcb);
+}
+
+/********************************* MLFQ *********************************/
+
+/**
+ * @brief Promote a process to a higher priority queue.
+ *
+ * @param args The arguments of the MLFQ scheduler.
+ * @param hot The keys of the process.
+ * @param pcb The process to promote.
+ */
+static inline void promote_process(SchedMLFQArgs *sched_args, PCBHot *hot, FakePCB *pcb)
+{
+	// if the process is already in the highest priority queue, don't promote
+	if (hot->level > 0)
+	{
+		List_detach(sched_args->ready[hot->level], (ListItem *)pcb);
+		hot->level--;
+		List_pushBack(sched_args->ready[hot->level], (ListItem *)pcb);
+	}
+}
+
+/**
+ * @brief Demote a process to a lower priority queue.
+ *
+ * @param args The arguments of the MLFQ scheduler.
+ * @param hot The keys of the process.
+ * @param pcb The process to demote.
+ */
+static inline void demote_process(SchedMLFQArgs *sched_args, PCBHot *hot, FakePCB *pcb)
+{
+	// if the process is already in the lowest priority queue, don't demote
+	if (hot->level < sched_args->num_ready_queues - 1)
+	{
+		List_detach(sched_args->ready[hot->level], (ListItem *)pcb);
+		hot->level++;
+		List_pushBack(sched_args->ready[hot->level], (ListItem *)pcb);
+	}
+}
+
+/**
+ * @brief Aging of the processes in the ready queues.
+ *
+ * @param args The arguments of the MLFQ scheduler.
+ * @param os The fake OS instance, its time and the keys of the processes.
+ */
+static inline void MLFQ_aging(SchedMLFQArgs *sched_args, FakeOS *os)
+{
+	SimTime currTimer = os->timer;
+	PCBHot *keys = os->pcbs.hot;
+
+	// 1 cause the first queue is not subject to aging
+	for (int i = 1; i < sched_args->num_ready_queues; i++)
+	{
+		ListItem *aux = sched_args->ready[i]->first;
+
+		while (aux)
+		{
+			FakePCB *pcb = (FakePCB *)aux;
+			PCBHot *hot = &keys[pcb->id];
+
+			if (hot->level > 0)
+			{
+				if (currTimer - hot->ready_since >= sched_args->agingThreshold &&
+					currTimer - hot->last_aging >= sched_args->agingThreshold)
+				{
+					promote_process(sched_args, hot, pcb);
+					hot->last_aging = currTimer;
+				}
+			}
+			aux = aux->next;
+		}
+	}
+}
+
+/**
+ * @brief Enqueue a process in the MLFQ scheduler.
+ *
+ * @param args_ The arguments of the MLFQ scheduler.
+ * @param os The fake OS instance.
+ * @param pcb The process to enqueue.
+ */
+static inline void MLFQ_enqueue(void *args_, FakeOS *os, FakePCB *pcb)
+{
+	SchedMLFQArgs *sched_args = (SchedMLFQArgs *)args_;
+	PCBHot *hot = FakeOS_hot(os, pcb);
+
+	if (pcb->quantum_used)
+	{
+		demote_process(sched_args, hot, pcb);
+		pcb->quantum_used = 0;
+	}
+	else
+		sched_enqueue(sched_args->schedule_args[hot->level], os, pcb);
+}
+
+/**
+ * @brief Pick a process in the MLFQ scheduler, from the first non empty queue.
+ *
+ * @param args_ The arguments of the MLFQ scheduler.
+ * @param os The fake OS instance.
+ * @return FakePCB* the process to run, NULL if all the queues are empty
+ */
+static inline FakePCB *MLFQ_pick(void *args_, FakeOS *os)
+{
+	SchedMLFQArgs *args = (SchedMLFQArgs *)args_;
+
+	MLFQ_aging(args, os);
+
+	for (int i = 0; i < args->num_ready_queues; i++)
+	{
+		if (args->ready[i]->size > 0)
+		{
+			// the high priority queues are RR, the others FCFS (see MLFQArgs)
+			if (i < args->high_priority_queues)
+				return RR_pick(args->schedule_args[i], os);
+			return FCFS_pick(args->schedule_args[i], os);
+		}
+	}
+	return NULL;
+}
+
+/**
+ * @brief Pick up to k processes in the MLFQ scheduler: the queues are aged once,
+ * then the processes are taken from the first non empty queues.
+ *
+ * @param args_ The arguments of the MLFQ scheduler.
+ * @param os The fake OS instance.
+ * @param picked Array of k elements to fill, in the order the processes are dispatched.
+ * @param k Number of idle cores.
+ * @return int The number of processes picked.
+ */
+static inline int MLFQ_pickBatch(void *args_, FakeOS *os, FakePCB **picked, int k)
+{
+	SchedMLFQArgs *args = (SchedMLFQArgs *)args_;
+	int n = 0;
+
+	MLFQ_aging(args, os);
+
+	for (int i = 0; i < args->num_ready_queues && n < k; i++)
+	{
+		while (n < k && args->ready[i]->size > 0)
+		{
+			// the high priority queues are RR, the others FCFS (see MLFQArgs)
+			if (i < args->high_priority_queues)
+				picked[n++] = RR_pick(args->schedule_args[i], os);
+			else
+				picked[n++] = FCFS_pick(args->schedule_args[i], os);
+		}
+	}
+	return n;
+}
+
+/**
+ * @brief The process runs under the policy of its queue, only the RR queues preempt.
+ *
+ * @param args_ The arguments of the MLFQ scheduler.
+ * @param os The fake OS instance.
+ * @param pcb The dispatched process.
+ */
+static inline void MLFQ_onPreempt(void *args_, FakeOS *os, FakePCB *pcb)
+{
+	SchedMLFQArgs *args = (SchedMLFQArgs *)args_;
+	int queue = FakeOS_hot(os, pcb)->level;
+
+	if (queue < args->high_priority_queues)
+		RR_onPreempt(args->schedule_args[queue], os, pcb);
+}
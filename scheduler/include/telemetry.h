@@ -0,0 +1,102 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "timebase.h"
+
+struct FakeOS;
+
+#define TELEMETRY_MAGIC 0x4d4c5444      // "DTLM"
+#define TELEMETRY_VERSION 1
+#define TELEMETRY_LEVELS 8              // ready levels in the segment, at least MAX_READY_LEVELS
+#define TELEMETRY_CHECK_STEPS 32        // steps between two looks at the wall clock, a power of 2
+#define TELEMETRY_PERIOD_MS 100         // wall time between two publications
+#define TELEMETRY_READ_TRIES 1000       // torn reads before a reader gives up
+
+// Latency of the terminated processes, in ticks
+typedef struct
+{
+	double mean;
+	uint64_t p50;
+	uint64_t p90;
+	uint64_t p99;
+	uint64_t max;
+} TelemetryLatency;
+
+// State of a running simulation as the readers see it
+typedef struct
+{
+	int32_t pid;                    // of the simulator
+	int32_t finished;               // the simulation is over, no more publications
+	char scheduler[32];
+	char unit[8];                   // of the times, the one of the timebase
+	SimTime timer;
+	SimTime ticks_per_ms;
+	uint32_t cores;
+	uint32_t running;
+	uint32_t waiting;
+	int32_t num_levels;
+	uint32_t ready[TELEMETRY_LEVELS];
+	uint64_t created;               // processes that arrived
+	uint64_t completed;
+	double cpu_used;                // % of the cores busy since the start
+	double wall_seconds;            // since the telemetry was opened
+	double sim_ms_per_sec;          // simulated ms per wall second, in the last period
+	TelemetryLatency turnaround;
+	TelemetryLatency waiting_time;
+	TelemetryLatency response;
+	uint64_t publications;
+} TelemetrySnapshot;
+
+// Shared memory segment (/dev/shm) of the telemetry, a seqlock: the simulator makes seq odd,
+// copies the snapshot and makes it even again, a reader copies the snapshot and keeps the
+// copy only if seq was the same even value before and after. The simulator never waits for
+// the readers.
+typedef struct
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t seq;
+	uint32_t size;                  // of the segment
+	TelemetrySnapshot snap;
+} TelemetryPage;
+
+// Publisher in the simulator. Without a segment it only serves the snapshots on demand (SIGUSR1)
+typedef struct Telemetry
+{
+	char *name;                     // of the segment, NULL without it
+	TelemetryPage *page;            // mapped segment, NULL without it
+	unsigned long steps;
+	struct timespec start;
+	struct timespec last;           // time of the last publication
+	SimTime last_timer;             // simulated time of the last publication
+	double rate;                    // simulated ms per wall second in the last period
+	uint64_t publications;
+} Telemetry;
+
+Telemetry *Telemetry_open(const char *name, struct FakeOS *os);
+void Telemetry_tick(Telemetry *t, struct FakeOS *os);
+void Telemetry_publish(Telemetry *t, struct FakeOS *os);
+void Telemetry_dump(Telemetry *t, struct FakeOS *os, FILE *out);
+void Telemetry_close(Telemetry *t, struct FakeOS *os);
+
+const TelemetryPage *Telemetry_attach(const char *name);
+int Telemetry_read(const TelemetryPage *page, TelemetrySnapshot *snap);
+void Telemetry_detach(const TelemetryPage *page);
+void Telemetry_print(const TelemetrySnapshot *snap, FILE *out);
+void Telemetry_printRow(const TelemetrySnapshot *snap, FILE *out, int header);
+
+/**
+ * @brief Called after every simulation step: the wall clock is read every
+ *        TELEMETRY_CHECK_STEPS steps, the segment is written every TELEMETRY_PERIOD_MS
+ *
+ * @param t
+ * @param os
+ */
+static inline void Telemetry_step(Telemetry *t, struct FakeOS *os)
+{
+	if (t->page && !(++t->steps & (TELEMETRY_CHECK_STEPS - 1)))
+		Telemetry_tick(t, os);
+}
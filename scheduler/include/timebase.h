@@ -0,0 +1,20 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "../../generator/include/trace_stream.h"
+
+// Time of the simulation in ticks, a step of the simulation is a tick. The timebase is the length
+// of the tick: 1 ms by default, the unit the traces were first written in, 1 us or 1 ns for the
+// sub-millisecond bursts. The times of the traces (ns, see TraceTime_parse) and of the options
+// (ms without a unit) are converted to ticks once, when they are read; the statistics are in ticks
+// and are printed in the unit of the timebase. 64 bits hold about 292 years of ns.
+typedef int64_t SimTime;
+
+#define TIMEBASE_MS 1           // ticks per ms of the default timebase
+
+int Timebase_ticksPerMs(const char *unit);
+const char *Timebase_unit(SimTime ticks_per_ms);
+SimTime Timebase_fromNs(SimTime ticks_per_ms, int64_t ns);
+int Timebase_parse(SimTime ticks_per_ms, const char *str, SimTime *ticks);
+int Timebase_format(char *buf, int size, SimTime ticks_per_ms, SimTime ticks);
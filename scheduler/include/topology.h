@@ -0,0 +1,52 @@
+#pragma once
+
+#include "timebase.h"
+
+struct FakeOS;
+struct FakePCB;
+
+#define MAX_NODES 16
+#define TOPO_PENALTY 1.5        // default slowdown of a burst on a node of another socket
+#define TOPO_BALANCE_PERIOD 100 // default ms between two NUMA balancing passes
+#define TOPO_SMT_SHARE 0.625    // speed of a core whose SMT sibling is busy
+#define TOPO_MEMORY_PASSES 4    // balancing passes a process runs away from home before its memory moves
+
+// Sockets of NUMA nodes of cores of SMT siblings, numbered in this order: the siblings of a
+// core are adjacent and the cores of a node contiguous, so the layout needs no tables.
+// A process gets its home node, where its memory is, on its first run. Away from it a
+// burst is slower: by the penalty on another socket, by half of it on another node of the
+// same socket, and a core whose sibling is busy runs at TOPO_SMT_SHARE. The dispatcher places
+// a process on an idle core of its home node, else of its socket, preferring idle siblings;
+// a new process goes to the node with the most idle cores. A process that has to run away
+// from home swaps with one running on its home node whose home is the idle core's node, so
+// that both run at home: with a single ready queue this keeps the nodes' queues apart
+// under load. Every balance period a process
+// running away from home moves to an idle core of its home node or swaps with one running
+// there whose home is here; after TOPO_MEMORY_PASSES passes away its memory moves instead.
+// The struct has no pointers, a checkpoint saves it as it is.
+typedef struct Topology
+{
+	int sockets;
+	int nodes_per_socket;
+	int cores_per_node;         // physical cores
+	int smt;                    // threads per core
+	int nodes;
+	double penalty;
+	SimTime balance_period;     // ticks, 0 without balancing
+	int flat;                   // place on the first idle core, ignoring the nodes
+	SimTime next_balance;
+	unsigned int migrations;        // processes moved by the balancing
+	unsigned int memory_migrations; // homes moved by the balancing
+	SimTime local_ticks[MAX_NODES];     // busy time of each node with processes at home
+	SimTime remote_ticks[MAX_NODES];    // busy time of each node with processes away from home
+} Topology;
+
+static inline int Topology_node(const Topology *topo, int core)
+{
+	return core / (topo->cores_per_node * topo->smt);
+}
+
+Topology *Topology_create(const char *spec, int cores, SimTime ticks_per_ms);
+int Topology_place(Topology *topo, struct FakeOS *os, struct FakePCB *pcb);
+void Topology_tick(Topology *topo, struct FakeOS *os);
+void Topology_print(const Topology *topo, const struct FakeOS *os);
@@ -0,0 +1,273 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <assert.h>
+
+#include "../include/fake_os.h"
+
+static void ClassStats_init(ClassStats *cs)
+{
+	cs->completed = 0;
+	cs->cpu_time = 0;
+	cs->waiting_time = 0;
+	cs->max_starvation = 0;
+	cs->share_sum = 0;
+	cs->share_sq_sum = 0;
+	LatencyHist_init(&cs->response);
+}
+
+/**
+ * @brief Initialize the per class and per source accounting
+ *
+ * @param acct
+ */
+void Accounting_init(Accounting *acct)
+{
+	for (int i = 0; i < MAX_PRIORITY; i++)
+		ClassStats_init(&acct->priority[i]);
+	acct->num_sources = 0;
+	acct->num_slos = 0;
+}
+
+/**
+ * @brief Free the memory of the accounting
+ *
+ * @param acct
+ */
+void Accounting_destroy(Accounting *acct)
+{
+	for (int i = 0; i < MAX_PRIORITY; i++)
+		LatencyHist_destroy(&acct->priority[i].response);
+	for (int i = 0; i < acct->num_sources; i++)
+	{
+		LatencyHist_destroy(&acct->source[i].response);
+		free(acct->source_names[i]);
+	}
+	acct->num_sources = 0;
+}
+
+/**
+ * @brief Id of a source profile, registered the first time it is seen
+ *
+ * @param acct
+ * @param name name of the profile, as in the From: field of the trace
+ * @return int
+ */
+int Accounting_sourceId(Accounting *acct, const char *name)
+{
+	for (int i = 0; i < acct->num_sources; i++)
+	{
+		if (strcmp(acct->source_names[i], name) == 0)
+			return i;
+	}
+
+	assert(acct->num_sources < MAX_SOURCES && "too many source profiles");
+	acct->source_names[acct->num_sources] = strdup(name);
+	ClassStats_init(&acct->source[acct->num_sources]);
+	return acct->num_sources++;
+}
+
+/**
+ * @brief Parse a SLO in the form <class>:p<percentile>:<time>, e.g. HIGH:p99:200 or LOW:p50:500us.
+ *        The class is the name or the number of the priority, the time is in ms without a unit
+ *
+ * @param acct
+ * @param spec
+ * @param ticks_per_ms timebase of the simulation
+ * @return int 0 if the SLO is added, -1 if it is malformed
+ */
+int Accounting_addSlo(Accounting *acct, const char *spec, SimTime ticks_per_ms)
+{
+	char name[32];
+	double percentile;
+	SimTime threshold;
+	int priority = -1;
+	int len = 0;
+
+	if (acct->num_slos == MAX_SLOS)
+		return -1;
+	if (sscanf(spec, "%31[^:]:p%lf:%n", name, &percentile, &len) != 2 || !len)
+		return -1;
+	if (Timebase_parse(ticks_per_ms, spec + len, &threshold) < 0)
+		return -1;
+	if (percentile <= 0 || percentile > 100)
+		return -1;
+
+	for (int i = 0; i < MAX_PRIORITY; i++)
+	{
+		if (strcasecmp(name, print_priority(i)) == 0)
+			priority = i;
+	}
+	if (priority < 0 && sscanf(name, "%d", &priority) != 1)
+		return -1;
+	if (priority < 0 || priority >= MAX_PRIORITY)
+		return -1;
+
+	acct->slos[acct->num_slos].priority = priority;
+	acct->slos[acct->num_slos].percentile = percentile;
+	acct->slos[acct->num_slos].threshold = threshold;
+	acct->num_slos++;
+	return 0;
+}
+
+/**
+ * @brief Account one tick of CPU to the class and the source of a running process
+ *
+ * @param acct
+ * @param pcb
+ */
+void Accounting_running(Accounting *acct, FakePCB *pcb)
+{
+	acct->priority[pcb->priority].cpu_time++;
+	if (pcb->source >= 0)
+		acct->source[pcb->source].cpu_time++;
+}
+
+static inline void ClassStats_dispatch(ClassStats *cs, SimTime starvation)
+{
+	if (starvation > cs->max_starvation)
+		cs->max_starvation = starvation;
+}
+
+/**
+ * @brief Account the time a process waited in the ready queue before being scheduled.
+ *        Called by the dispatcher, before the waiting time of the process is updated
+ *
+ * @param acct
+ * @param pcb
+ * @param starvation time since it entered the ready queue
+ */
+void Accounting_dispatch(Accounting *acct, FakePCB *pcb, SimTime starvation)
+{
+	ClassStats_dispatch(&acct->priority[pcb->priority], starvation);
+	if (pcb->source >= 0)
+		ClassStats_dispatch(&acct->source[pcb->source], starvation);
+}
+
+static inline void ClassStats_terminated(ClassStats *cs, ProcessStats *stats)
+{
+	SimTime served = stats->cpu_time + stats->waiting_time;
+	double share = served ? (double)stats->cpu_time / served : 1.0;
+
+	cs->completed++;
+	cs->waiting_time += stats->waiting_time;
+	cs->share_sum += share;
+	cs->share_sq_sum += share * share;
+	LatencyHist_record(&cs->response, stats->response_time);
+}
+
+/**
+ * @brief Account a terminated process to its class and source
+ *
+ * @param acct
+ * @param pcb
+ * @param stats its statistics
+ */
+void Accounting_terminated(Accounting *acct, FakePCB *pcb, ProcessStats *stats)
+{
+	ClassStats_terminated(&acct->priority[pcb->priority], stats);
+	if (pcb->source >= 0)
+		ClassStats_terminated(&acct->source[pcb->source], stats);
+}
+
+/**
+ * @brief Jain's fairness index of the service share of all the processes of the groups:
+ *        (sum x)^2 / (n * sum x^2), 1 when every process got the same share
+ *
+ * @param stats
+ * @param num
+ * @return double
+ */
+double Accounting_jain(const ClassStats *stats, int num)
+{
+	double sum = 0, sq_sum = 0;
+	unsigned int n = 0;
+
+	for (int i = 0; i < num; i++)
+	{
+		sum += stats[i].share_sum;
+		sq_sum += stats[i].share_sq_sum;
+		n += stats[i].completed;
+	}
+	return (n && sq_sum > 0) ? (sum * sum) / (n * sq_sum) : 1.0;
+}
+
+/**
+ * @brief Jain's fairness index between the groups, on the mean service share of each group
+ *
+ * @param stats
+ * @param num
+ * @return double
+ */
+double Accounting_jainClasses(const ClassStats *stats, int num)
+{
+	double sum = 0, sq_sum = 0;
+	int n = 0;
+
+	for (int i = 0; i < num; i++)
+	{
+		if (!stats[i].completed)
+			continue;
+		double mean = stats[i].share_sum / stats[i].completed;
+		sum += mean;
+		sq_sum += mean * mean;
+		n++;
+	}
+	return (n && sq_sum > 0) ? (sum * sum) / (n * sq_sum) : 1.0;
+}
+
+static void ClassStats_print(const char *name, const ClassStats *cs)
+{
+	printf(ANSI_CYAN "  %-16s %6u %10lld %10.1f %8lu %8lu %8lu %10lld %7.3f\n" ANSI_RESET, name,
+		cs->completed,
+		(long long)cs->cpu_time,
+		cs->completed ? (double)cs->waiting_time / cs->completed : 0.0,
+		(unsigned long)LatencyHist_percentile(&cs->response, 50),
+		(unsigned long)LatencyHist_percentile(&cs->response, 95),
+		(unsigned long)LatencyHist_percentile(&cs->response, 99),
+		(long long)cs->max_starvation,
+		Accounting_jain(cs, 1));
+}
+
+/**
+ * @brief Print the per class and per source tables, the fairness indexes and the SLO checks
+ *
+ * @param acct
+ * @param unit of the times, the one of the timebase
+ */
+void Accounting_print(Accounting *acct, const char *unit)
+{
+	char cpu[16];
+
+	snprintf(cpu, sizeof(cpu), "cpu[%s]", unit);
+	printf(ANSI_CYAN "\n------------------------------------FAIRNESS------------------------------------\n" ANSI_RESET);
+	printf(ANSI_CYAN "  %-16s %6s %10s %10s %8s %8s %8s %10s %7s\n" ANSI_RESET,
+		"class", "done", cpu, "wait avg", "resp p50", "resp p95", "resp p99", "starvation", "jain");
+	for (int i = 0; i < MAX_PRIORITY; i++)
+		ClassStats_print(print_priority(i), &acct->priority[i]);
+
+	if (acct->num_sources > 0)
+	{
+		printf(ANSI_CYAN "  %-16s\n" ANSI_RESET, "source");
+		for (int i = 0; i < acct->num_sources; i++)
+			ClassStats_print(acct->source_names[i], &acct->source[i]);
+	}
+
+	printf(ANSI_CYAN "Jain's index (processes): \t[%.4f]\n" ANSI_RESET, Accounting_jain(acct->priority, MAX_PRIORITY));
+	printf(ANSI_CYAN "Jain's index (classes): \t[%.4f]\n" ANSI_RESET, Accounting_jainClasses(acct->priority, MAX_PRIORITY));
+	if (acct->num_sources > 0)
+		printf(ANSI_CYAN "Jain's index (sources): \t[%.4f]\n" ANSI_RESET, Accounting_jainClasses(acct->source, acct->num_sources));
+
+	for (int i = 0; i < acct->num_slos; i++)
+	{
+		SloTarget *slo = &acct->slos[i];
+		ClassStats *cs = &acct->priority[slo->priority];
+		uint64_t value = LatencyHist_percentile(&cs->response, slo->percentile);
+		int met = (value <= (uint64_t)slo->threshold);
+
+		printf("%sSLO %s response p%g <= %lld %s: \t[%lu %s] %s\n" ANSI_RESET, met ? ANSI_GREEN : ANSI_RED,
+			print_priority(slo->priority), slo->percentile, (long long)slo->threshold, unit, (unsigned long)value, unit,
+			!cs->completed ? "NO DATA" : (met ? "OK" : "VIOLATED"));
+	}
+}
@@ -0,0 +1,177 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "../include/fake_os.h"
+#include "../include/branch.h"
+
+/*
+ * What-if analysis: the simulation runs once up to the branch time, then every variant is a
+ * fork() of the simulator. The children share the state of the prefix copy-on-write, switch
+ * to their scheduler and run to the end at the same time; each one sends its outcome back on
+ * a pipe and the parent prints the comparison. The first branch always goes on with the
+ * scheduler of the prefix, as the reference of the others.
+ */
+
+/**
+ * @brief Parse a variant in the form <scheduler>:<quantum>, the scheduler is its number
+ *        (as on the command line) or its name, e.g. 9:20 or RR:500us
+ *
+ * @param spec
+ * @param ticks_per_ms timebase of the simulation, the quantum is in ms without a unit
+ * @param variant
+ * @return int 0 if the variant is valid, -1 otherwise
+ */
+int Branch_parseVariant(const char *spec, SimTime ticks_per_ms, BranchVariant *variant)
+{
+	char name[32];
+	SimTime quantum;
+	int len = 0;
+
+	if (sscanf(spec, "%31[^:]:%n", name, &len) != 1 || !len || Timebase_parse(ticks_per_ms, spec + len, &quantum) < 0)
+		return -1;
+
+	variant->quantum = quantum;
+	variant->scheduler = atoi(name) - 1;
+	for (int i = 0; i < MAX_SCHEDULERS && variant->scheduler < 0; i++)
+		if (strcmp(name, print_scheduler(i)) == 0)
+			variant->scheduler = i;
+
+	return (variant->scheduler >= 0 && variant->scheduler < MAX_SCHEDULERS) ? 0 : -1;
+}
+
+/**
+ * @brief Outcome of a simulation run to the end
+ *
+ * @param os
+ * @param result
+ */
+void Branch_result(FakeOS *os, BranchResult *result)
+{
+	SimStats *stats = &os->stats;
+
+	memset(result, 0, sizeof(*result));
+	result->ok = 1;
+	result->total_time = os->timer;
+	result->completed = stats->completed;
+	result->cpu_used = os->timer ? (double)os->cpu_busy_time / ((double)os->timer * os->cores) * 100.0 : 0.0;
+	result->turnaround_mean = LatencyHist_mean(&stats->turnaround);
+	result->turnaround_p99 = LatencyHist_percentile(&stats->turnaround, 99);
+	result->waiting_mean = LatencyHist_mean(&stats->waiting);
+	result->waiting_p99 = LatencyHist_percentile(&stats->waiting, 99);
+	result->response_mean = LatencyHist_mean(&stats->response);
+	result->response_p99 = LatencyHist_percentile(&stats->response, 99);
+	result->jain = Accounting_jain(os->acct.priority, MAX_PRIORITY);
+	result->energy = os->energy ? Energy_joules(os->energy) : 0.0;
+}
+
+/**
+ * @brief Child side of a branch: switch scheduler, simulate to the end and send the outcome
+ *
+ * @param os
+ * @param variant
+ * @param fd write end of the pipe to the parent
+ */
+static void Branch_child(FakeOS *os, const BranchVariant *variant, int fd)
+{
+	BranchResult result;
+
+	os->verbose = 0;
+	if (variant->scheduler != (int)os->scheduler || variant->quantum != os->quantum)
+		FakeOS_switchScheduler(os, variant->scheduler, variant->quantum);
+
+	while (!FakeOS_finished(os))
+		FakeOS_simStep(os);
+
+	Branch_result(os, &result);
+	if (write(fd, &result, sizeof(result)) != sizeof(result))
+		_exit(1);
+	_exit(0);
+}
+
+/**
+ * @brief Branch the simulation in its current state into the variants and print how they end.
+ *        The state of os is not changed
+ *
+ * @param os
+ * @param variants
+ * @param num_variants
+ */
+void Branch_run(FakeOS *os, const BranchVariant *variants, int num_variants)
+{
+	BranchVariant all[MAX_BRANCHES + 1];
+	BranchResult results[MAX_BRANCHES + 1];
+	pid_t pids[MAX_BRANCHES + 1];
+	int fds[MAX_BRANCHES + 1];
+	int num = 0;
+
+	assert(num_variants <= MAX_BRANCHES && "too many branches");
+
+	all[num].scheduler = os->scheduler;
+	all[num++].quantum = os->quantum;
+	for (int i = 0; i < num_variants; i++)
+		all[num++] = variants[i];
+
+	// the buffered output would be written again by every child
+	fflush(stdout);
+
+	for (int i = 0; i < num; i++)
+	{
+		int pipe_fds[2];
+
+		if (pipe(pipe_fds) < 0)
+			assert(0 && "pipe failed");
+		if ((pids[i] = fork()) < 0)
+			assert(0 && "fork failed");
+		if (pids[i] == 0)
+		{
+			close(pipe_fds[0]);
+			for (int j = 0; j < i; j++)
+				close(fds[j]);
+			Branch_child(os, &all[i], pipe_fds[1]);
+		}
+		close(pipe_fds[1]);
+		fds[i] = pipe_fds[0];
+	}
+
+	for (int i = 0; i < num; i++)
+	{
+		if (read(fds[i], &results[i], sizeof(BranchResult)) != sizeof(BranchResult))
+			results[i].ok = 0;
+		close(fds[i]);
+		waitpid(pids[i], NULL, 0);
+	}
+
+	const char *unit = Timebase_unit(os->ticks_per_ms);
+	char total[16];
+
+	snprintf(total, sizeof(total), "total[%s]", unit);
+	printf(ANSI_CYAN "\n\n------------------------------------WHAT-IF AT %lld %s------------------------------------\n" ANSI_RESET,
+		   (long long)os->timer, unit);
+	printf(ANSI_CYAN "  %-28s %10s %9s %8s %10s %9s %10s %9s %10s %9s %7s %8s\n" ANSI_RESET, "branch", total, "done",
+		   "cpu%", "turn avg", "turn p99", "wait avg", "wait p99", "resp avg", "resp p99", "jain", "vs base");
+	for (int i = 0; i < num; i++)
+	{
+		BranchResult *r = &results[i];
+		char name[64], quantum[32];
+
+		Timebase_format(quantum, sizeof(quantum), os->ticks_per_ms, all[i].quantum);
+		snprintf(name, sizeof(name), "%s%s:%s", i ? "" : "(base) ", print_scheduler(all[i].scheduler), quantum);
+		if (!r->ok)
+		{
+			printf(ANSI_CYAN "  %-28s failed\n" ANSI_RESET, name);
+			continue;
+		}
+		printf(ANSI_CYAN "  %-28s %10lld %9u %8.2f %10.1f %9lu %10.1f %9lu %10.1f %9lu %7.3f" ANSI_RESET, name,
+			   (long long)r->total_time, r->completed, r->cpu_used, r->turnaround_mean, (unsigned long)r->turnaround_p99,
+			   r->waiting_mean, (unsigned long)r->waiting_p99, r->response_mean, (unsigned long)r->response_p99, r->jain);
+		// difference of the mean turnaround with respect to the branch that keeps the scheduler
+		if (i && results[0].ok && results[0].turnaround_mean > 0)
+			printf(ANSI_CYAN " %+7.1f%%\n" ANSI_RESET, (r->turnaround_mean - results[0].turnaround_mean) * 100.0 / results[0].turnaround_mean);
+		else
+			printf(ANSI_CYAN " %8s\n" ANSI_RESET, "-");
+	}
+}
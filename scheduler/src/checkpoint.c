@@ -0,0 +1,713 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <assert.h>
+#include <unistd.h>
+
+#include "../include/fake_os.h"
+#include "../include/checkpoint.h"
+
+/*
+ * The checkpoint is written at the boundary between two steps, in this order:
+ * header, OS counters, scheduler counters, statistics, accounting, running cores,
+ * ready levels, waiting queue, processes not yet arrived, stream, time series, report,
+ * and the magic again to catch truncated files. Lists are written in order and rebuilt
+ * with List_pushBack, so the restored queues are the same and so are the following steps.
+ * The output files are truncated to their length at the time of the checkpoint.
+ */
+
+typedef struct
+{
+	FILE *f;
+	int error;
+} CkptFile;
+
+static void put(CkptFile *cf, const void *data, size_t size)
+{
+	if (!cf->error && fwrite(data, 1, size, cf->f) != size)
+		cf->error = 1;
+}
+
+static void get(CkptFile *cf, void *data, size_t size)
+{
+	if (cf->error || fread(data, 1, size, cf->f) != size)
+	{
+		cf->error = 1;
+		memset(data, 0, size);
+	}
+}
+
+#define PUT(cf, x) put(cf, &(x), sizeof(x))
+#define GET(cf, x) get(cf, &(x), sizeof(x))
+
+static void putString(CkptFile *cf, const char *str)
+{
+	int32_t len = str ? (int32_t)strlen(str) : -1;
+
+	PUT(cf, len);
+	if (str)
+		put(cf, str, len);
+}
+
+/**
+ * @brief Read a string written by putString
+ *
+ * @param cf
+ * @return char* a malloc'd copy, NULL if the string was NULL
+ */
+static char *getString(CkptFile *cf)
+{
+	int32_t len;
+	char *str;
+
+	GET(cf, len);
+	if (cf->error || len < 0)
+		return NULL;
+	if (!(str = (char *)malloc(len + 1)))
+		assert(0 && "malloc failed restoring checkpoint");
+	get(cf, str, len);
+	str[len] = '\0';
+	return str;
+}
+
+static void putHist(CkptFile *cf, const LatencyHist *h)
+{
+	uint32_t nonzero = 0;
+
+	PUT(cf, h->count);
+	PUT(cf, h->sum);
+	PUT(cf, h->min);
+	PUT(cf, h->max);
+
+	// most buckets are empty: only the non empty ones are written, with their index
+	for (uint32_t i = 0; i < LHIST_BUCKETS; i++)
+		if (h->buckets[i])
+			nonzero++;
+	PUT(cf, nonzero);
+	for (uint32_t i = 0; i < LHIST_BUCKETS; i++)
+	{
+		if (h->buckets[i])
+		{
+			PUT(cf, i);
+			PUT(cf, h->buckets[i]);
+		}
+	}
+}
+
+static void getHist(CkptFile *cf, LatencyHist *h)
+{
+	uint32_t nonzero, index;
+
+	LatencyHist_reset(h);
+	GET(cf, h->count);
+	GET(cf, h->sum);
+	GET(cf, h->min);
+	GET(cf, h->max);
+	GET(cf, nonzero);
+	for (uint32_t i = 0; i < nonzero && !cf->error; i++)
+	{
+		GET(cf, index);
+		if (index >= LHIST_BUCKETS)
+		{
+			cf->error = 1;
+			return;
+		}
+		GET(cf, h->buckets[index]);
+	}
+}
+
+static void putClass(CkptFile *cf, const ClassStats *cs)
+{
+	PUT(cf, cs->completed);
+	PUT(cf, cs->cpu_time);
+	PUT(cf, cs->waiting_time);
+	PUT(cf, cs->max_starvation);
+	PUT(cf, cs->share_sum);
+	PUT(cf, cs->share_sq_sum);
+	putHist(cf, &cs->response);
+}
+
+static void getClass(CkptFile *cf, ClassStats *cs)
+{
+	GET(cf, cs->completed);
+	GET(cf, cs->cpu_time);
+	GET(cf, cs->waiting_time);
+	GET(cf, cs->max_starvation);
+	GET(cf, cs->share_sum);
+	GET(cf, cs->share_sq_sum);
+	getHist(cf, &cs->response);
+}
+
+static void putEvents(CkptFile *cf, ListHead *events)
+{
+	uint32_t count = events->size;
+
+	PUT(cf, count);
+	for (ListItem *aux = events->first; aux; aux = aux->next)
+	{
+		ProcessEvent *e = (ProcessEvent *)aux;
+		int32_t type = e->type;
+		int64_t duration = e->duration;
+		PUT(cf, type);
+		PUT(cf, duration);
+	}
+}
+
+static void getEvents(CkptFile *cf, ListHead *events)
+{
+	uint32_t count;
+	int32_t type;
+	int64_t duration;
+
+	List_init(events);
+	GET(cf, count);
+	for (uint32_t i = 0; i < count && !cf->error; i++)
+	{
+		ProcessEvent *e = (ProcessEvent *)MemStats_alloc(MEM_EVENT, sizeof(ProcessEvent));
+		if (!e)
+			assert(0 && "malloc failed restoring checkpoint");
+		GET(cf, type);
+		GET(cf, duration);
+		e->list.next = e->list.prev = 0;
+		e->type = type;
+		e->duration = duration;
+		List_pushBack(events, (ListItem *)e);
+	}
+}
+
+static void putPCB(CkptFile *cf, FakeOS *os, FakePCB *pcb)
+{
+	int32_t priority = pcb->priority;
+
+	PUT(cf, pcb->pid);
+	PUT(cf, pcb->duration);
+	PUT(cf, pcb->quantum_used);
+	PUT(cf, priority);
+	PUT(cf, pcb->source);
+	PUT(cf, pcb->home_node);
+	PUT(cf, pcb->remote_passes);
+	put(cf, FakeOS_hot(os, pcb), sizeof(PCBHot));
+	put(cf, FakeOS_cold(os, pcb), sizeof(ProcessStats));
+	putEvents(cf, &pcb->events);
+}
+
+static FakePCB *getPCB(CkptFile *cf, FakeOS *os)
+{
+	FakePCB *pcb = (FakePCB *)MemStats_alloc(MEM_PCB, sizeof(FakePCB));
+	int32_t priority;
+
+	if (!pcb)
+		assert(0 && "malloc failed restoring checkpoint");
+	pcb->list.next = pcb->list.prev = 0;
+	GET(cf, pcb->pid);
+	GET(cf, pcb->duration);
+	GET(cf, pcb->quantum_used);
+	GET(cf, priority);
+	pcb->priority = priority;
+	GET(cf, pcb->source);
+	GET(cf, pcb->home_node);
+	GET(cf, pcb->remote_passes);
+	// the slot can differ from the saved one, only the keys and the statistics matter
+	pcb->id = PCBTable_alloc(&os->pcbs);
+	get(cf, FakeOS_hot(os, pcb), sizeof(PCBHot));
+	get(cf, FakeOS_cold(os, pcb), sizeof(ProcessStats));
+	getEvents(cf, &pcb->events);
+
+	return pcb;
+}
+
+static void putPCBList(CkptFile *cf, FakeOS *os, ListHead *list)
+{
+	uint32_t count = list->size;
+
+	PUT(cf, count);
+	for (ListItem *aux = list->first; aux; aux = aux->next)
+		putPCB(cf, os, (FakePCB *)aux);
+}
+
+static void getPCBList(CkptFile *cf, FakeOS *os, ListHead *list)
+{
+	uint32_t count;
+
+	List_init(list);
+	GET(cf, count);
+	for (uint32_t i = 0; i < count && !cf->error; i++)
+		List_pushBack(list, (ListItem *)getPCB(cf, os));
+}
+
+/**
+ * @brief Current length of an output file, after flushing it
+ *
+ * @param f
+ * @return int64_t
+ */
+static int64_t fileOffset(FILE *f)
+{
+	fflush(f);
+	return (int64_t)ftell(f);
+}
+
+/**
+ * @brief Reopen an output file for appending, discarding what was written after the checkpoint
+ *
+ * @param filename
+ * @param offset length of the file at the time of the checkpoint
+ * @return FILE* NULL if the file can't be opened
+ */
+static FILE *reopenTruncated(const char *filename, int64_t offset)
+{
+	FILE *f = fopen(filename, "r+");
+
+	if (!f)
+		return NULL;
+	if (ftruncate(fileno(f), offset) < 0 || fseek(f, 0, SEEK_END) < 0)
+	{
+		fclose(f);
+		return NULL;
+	}
+	return f;
+}
+
+/**
+ * @brief Save the whole state of the simulation. The file is written under a temporary name
+ *        and renamed at the end, so an interrupted save leaves the previous checkpoint intact
+ *
+ * @param os
+ * @param filename
+ * @return int 0 on success, -1 on error
+ */
+int Checkpoint_save(FakeOS *os, const char *filename)
+{
+	CkptFile cf = {0, 0};
+	char tmp_filename[512];
+	uint32_t version = CHECKPOINT_VERSION;
+	int32_t scheduler = os->scheduler;
+	ListHead *lists[MAX_READY_LEVELS];
+	int32_t num_lists = FakeOS_readyLists(os, lists);
+	uint8_t present;
+
+	snprintf(tmp_filename, sizeof(tmp_filename), "%s.tmp", filename);
+	if (!(cf.f = fopen(tmp_filename, "wb")))
+		return -1;
+
+	put(&cf, CHECKPOINT_MAGIC, 8);
+	PUT(&cf, version);
+
+	PUT(&cf, os->cores);
+	PUT(&cf, scheduler);
+	PUT(&cf, os->quantum);
+	PUT(&cf, os->ticks_per_ms);
+	PUT(&cf, os->timer);
+	PUT(&cf, os->next_pid);
+	PUT(&cf, os->cpu_busy_time);
+	put(&cf, os->core_busy_time, os->cores * sizeof(SimTime));
+	PUT(&cf, os->wakeup_granularity);
+	PUT(&cf, os->wakeup_preemptions);
+	if (os->scheduler == MLQ)
+	{
+		SchedMLQArgs *args = (SchedMLQArgs *)os->schedule_args;
+		PUT(&cf, args->hpq_time);
+		PUT(&cf, args->lpq_time);
+	}
+
+	PUT(&cf, os->stats.completed);
+	putHist(&cf, &os->stats.turnaround);
+	putHist(&cf, &os->stats.waiting);
+	putHist(&cf, &os->stats.response);
+
+	for (int i = 0; i < MAX_PRIORITY; i++)
+		putClass(&cf, &os->acct.priority[i]);
+	PUT(&cf, os->acct.num_sources);
+	for (int i = 0; i < os->acct.num_sources; i++)
+	{
+		putString(&cf, os->acct.source_names[i]);
+		putClass(&cf, &os->acct.source[i]);
+	}
+	PUT(&cf, os->acct.num_slos);
+	put(&cf, os->acct.slos, os->acct.num_slos * sizeof(SloTarget));
+
+	PUT(&cf, os->pcbs.capacity);
+	PUT(&cf, os->pcbs.size);
+	for (unsigned int i = 0; i < os->cores; i++)
+	{
+		present = os->running[i] != NULL;
+		PUT(&cf, present);
+		if (present)
+			putPCB(&cf, os, os->running[i]);
+	}
+
+	PUT(&cf, num_lists);
+	for (int i = 0; i < num_lists; i++)
+		putPCBList(&cf, os, lists[i]);
+	putPCBList(&cf, os, &os->waiting);
+
+	uint32_t num_processes = os->processes.size;
+	PUT(&cf, num_processes);
+	for (ListItem *aux = os->processes.first; aux; aux = aux->next)
+	{
+		FakeProcess *p = (FakeProcess *)aux;
+		int32_t priority = p->priority;
+		PUT(&cf, p->pid);
+		PUT(&cf, p->arrival_time);
+		PUT(&cf, priority);
+		PUT(&cf, p->source);
+		putEvents(&cf, &p->events);
+	}
+
+	present = os->stream != NULL;
+	PUT(&cf, present);
+	if (present)
+	{
+		TraceStreamState state;
+		TraceStream_getState(os->stream, &state);
+		putString(&cf, state.histogram_folder);
+		PUT(&cf, state.num_processes);
+		PUT(&cf, state.burst_per_process);
+		PUT(&cf, state.seed);
+		PUT(&cf, state.window_procs);
+		PUT(&cf, state.window);
+		PUT(&cf, state.pos);
+	}
+
+	present = os->sampler != NULL;
+	PUT(&cf, present);
+	if (present)
+	{
+		Sampler *s = os->sampler;
+		int64_t offset = fileOffset(s->out);
+		putString(&cf, s->filename);
+		PUT(&cf, s->interval);
+		PUT(&cf, s->start);
+		PUT(&cf, s->cores);
+		put(&cf, s->last_core_busy, s->cores * sizeof(SimTime));
+		PUT(&cf, s->last_completed);
+		PUT(&cf, offset);
+	}
+
+	present = os->report != NULL;
+	PUT(&cf, present);
+	if (present)
+	{
+		Report *r = os->report;
+		int32_t format = r->format;
+		int64_t offset = fileOffset(r->out);
+		int64_t procs_offset = r->procs_out ? fileOffset(r->procs_out) : 0;
+		putString(&cf, r->filename);
+		PUT(&cf, format);
+		PUT(&cf, r->depth);
+		put(&cf, r->first, sizeof(r->first));
+		PUT(&cf, offset);
+		PUT(&cf, procs_offset);
+	}
+
+	present = os->tuner != NULL;
+	PUT(&cf, present);
+	if (present)
+		put(&cf, os->tuner, sizeof(QuantumTuner));
+
+	present = os->capacity != NULL;
+	PUT(&cf, present);
+	if (present)
+	{
+		put(&cf, os->capacity, sizeof(CoreCapacity));
+		put(&cf, os->capacity->speed, CoreCapacity_coresSize(os->cores));
+	}
+
+	present = os->energy != NULL;
+	PUT(&cf, present);
+	if (present)
+	{
+		put(&cf, os->energy, sizeof(EnergyModel));
+		put(&cf, os->energy->core, os->cores * sizeof(CorePower));
+	}
+
+	present = os->topology != NULL;
+	PUT(&cf, present);
+	if (present)
+		put(&cf, os->topology, sizeof(Topology));
+
+	// the allocations counted up to here, as if the run had not stopped
+	put(&cf, &mem_stats, sizeof(MemStats));
+
+	put(&cf, CHECKPOINT_MAGIC, 8);
+
+	if (fflush(cf.f) != 0 || fsync(fileno(cf.f)) != 0)
+		cf.error = 1;
+	if (fclose(cf.f) != 0)
+		cf.error = 1;
+	if (cf.error || rename(tmp_filename, filename) != 0)
+	{
+		unlink(tmp_filename);
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * @brief Rebuild the simulation from a checkpoint: os must not be initialized, the scheduler,
+ *        the stream, the time series and the report are set up as they were
+ *
+ * @param os
+ * @param filename
+ * @return int 0 on success, -1 if the file can't be read, is of another version or is truncated
+ */
+int Checkpoint_restore(FakeOS *os, const char *filename)
+{
+	CkptFile cf = {0, 0};
+	char magic[8];
+	uint32_t version;
+	unsigned int cores;
+	int32_t scheduler;
+	SimTime quantum, ticks_per_ms;
+	ListHead *lists[MAX_READY_LEVELS];
+	int32_t num_lists;
+	uint8_t present;
+	int pcbs_capacity, pcbs_size;
+	MemStats saved_mem;
+
+	if (!(cf.f = fopen(filename, "rb")))
+		return -1;
+
+	get(&cf, magic, 8);
+	GET(&cf, version);
+	GET(&cf, cores);
+	GET(&cf, scheduler);
+	GET(&cf, quantum);
+	GET(&cf, ticks_per_ms);
+	if (cf.error || memcmp(magic, CHECKPOINT_MAGIC, 8) || version != CHECKPOINT_VERSION ||
+		cores < 1 || scheduler < 0 || scheduler >= MAX_SCHEDULERS ||
+		Timebase_ticksPerMs(Timebase_unit(ticks_per_ms)) != ticks_per_ms)
+	{
+		fclose(cf.f);
+		return -1;
+	}
+
+	FakeOS_init(os, cores);
+	os->ticks_per_ms = ticks_per_ms;
+	FakeOS_setScheduler(os, scheduler, quantum);
+	GET(&cf, os->timer);
+	GET(&cf, os->next_pid);
+	GET(&cf, os->cpu_busy_time);
+	get(&cf, os->core_busy_time, os->cores * sizeof(SimTime));
+	SimTime wakeup_granularity;
+	GET(&cf, wakeup_granularity);
+	GET(&cf, os->wakeup_preemptions);
+	if (wakeup_granularity >= 0)
+		FakeOS_setWakeupPreemption(os, wakeup_granularity);
+	if (os->scheduler == MLQ)
+	{
+		SchedMLQArgs *args = (SchedMLQArgs *)os->schedule_args;
+		GET(&cf, args->hpq_time);
+		GET(&cf, args->lpq_time);
+	}
+
+	GET(&cf, os->stats.completed);
+	getHist(&cf, &os->stats.turnaround);
+	getHist(&cf, &os->stats.waiting);
+	getHist(&cf, &os->stats.response);
+
+	for (int i = 0; i < MAX_PRIORITY; i++)
+		getClass(&cf, &os->acct.priority[i]);
+	int num_sources;
+	GET(&cf, num_sources);
+	for (int i = 0; i < num_sources && i < MAX_SOURCES && !cf.error; i++)
+	{
+		char *name = getString(&cf);
+		int id = Accounting_sourceId(&os->acct, name ? name : "");
+		free(name);
+		getClass(&cf, &os->acct.source[id]);
+	}
+	GET(&cf, os->acct.num_slos);
+	if (os->acct.num_slos < 0 || os->acct.num_slos > MAX_SLOS)
+		cf.error = 1;
+	else
+		get(&cf, os->acct.slos, os->acct.num_slos * sizeof(SloTarget));
+
+	GET(&cf, pcbs_capacity);
+	GET(&cf, pcbs_size);
+	for (unsigned int i = 0; i < os->cores && !cf.error; i++)
+	{
+		GET(&cf, present);
+		if (present)
+			os->running[i] = getPCB(&cf, os);
+	}
+
+	GET(&cf, num_lists);
+	if (num_lists != FakeOS_readyLists(os, lists))
+		cf.error = 1;
+	for (int i = 0; i < num_lists && !cf.error; i++)
+		getPCBList(&cf, os, lists[i]);
+	getPCBList(&cf, os, &os->waiting);
+	if (!cf.error && (pcbs_size < os->pcbs.size || pcbs_size > pcbs_capacity || pcbs_capacity < os->pcbs.capacity))
+		cf.error = 1;
+	if (!cf.error)
+		PCBTable_restore(&os->pcbs, pcbs_capacity, pcbs_size);
+
+	uint32_t num_processes;
+	GET(&cf, num_processes);
+	for (uint32_t i = 0; i < num_processes && !cf.error; i++)
+	{
+		FakeProcess *p = (FakeProcess *)MemStats_alloc(MEM_PROCESS, sizeof(FakeProcess));
+		int32_t priority;
+		if (!p)
+			assert(0 && "malloc failed restoring checkpoint");
+		p->list.next = p->list.prev = 0;
+		GET(&cf, p->pid);
+		GET(&cf, p->arrival_time);
+		GET(&cf, priority);
+		p->priority = priority;
+		GET(&cf, p->source);
+		getEvents(&cf, &p->events);
+		List_pushBack(&os->processes, (ListItem *)p);
+	}
+
+	GET(&cf, present);
+	if (present && !cf.error)
+	{
+		TraceStreamState state;
+		char *folder = getString(&cf);
+		GET(&cf, state.num_processes);
+		GET(&cf, state.burst_per_process);
+		GET(&cf, state.seed);
+		GET(&cf, state.window_procs);
+		GET(&cf, state.window);
+		GET(&cf, state.pos);
+		state.histogram_folder = folder;
+		if (!cf.error && folder)
+			os->stream = TraceStream_restore(&state);
+		free(folder);
+	}
+
+	GET(&cf, present);
+	if (present && !cf.error)
+	{
+		Sampler *s = (Sampler *)malloc(sizeof(Sampler));
+		int64_t offset;
+		if (!s)
+			assert(0 && "malloc failed restoring checkpoint");
+		s->filename = getString(&cf);
+		GET(&cf, s->interval);
+		GET(&cf, s->start);
+		GET(&cf, s->cores);
+		if (s->cores != os->cores)
+			cf.error = 1;
+		if (!(s->last_core_busy = (SimTime *)calloc(os->cores, sizeof(SimTime))))
+			assert(0 && "malloc failed restoring checkpoint");
+		get(&cf, s->last_core_busy, os->cores * sizeof(SimTime));
+		GET(&cf, s->last_completed);
+		GET(&cf, offset);
+		s->out = (!cf.error && s->filename) ? reopenTruncated(s->filename, offset) : NULL;
+		if (!s->out)
+		{
+			cf.error = 1;
+			free(s->filename);
+			free(s->last_core_busy);
+			free(s);
+		}
+		else
+			os->sampler = s;
+	}
+
+	GET(&cf, present);
+	if (present && !cf.error)
+	{
+		Report *r = (Report *)malloc(sizeof(Report));
+		int32_t format;
+		int64_t offset, procs_offset;
+		if (!r)
+			assert(0 && "malloc failed restoring checkpoint");
+		r->filename = getString(&cf);
+		GET(&cf, format);
+		r->format = format;
+		GET(&cf, r->depth);
+		get(&cf, r->first, sizeof(r->first));
+		GET(&cf, offset);
+		GET(&cf, procs_offset);
+		for (int i = 0; i < REPORT_MAX_DEPTH; i++)
+			r->keys[i] = NULL;
+		r->num_phases = 0;
+		r->procs_out = NULL;
+		r->out = (!cf.error && r->filename) ? reopenTruncated(r->filename, offset) : NULL;
+		if (r->out && r->format == REPORT_CSV)
+		{
+			char procs_filename[512];
+			snprintf(procs_filename, sizeof(procs_filename), "%s.processes.csv", r->filename);
+			if (!(r->procs_out = reopenTruncated(procs_filename, procs_offset)))
+			{
+				fclose(r->out);
+				r->out = NULL;
+			}
+		}
+		if (!r->out || r->depth < 0 || r->depth >= REPORT_MAX_DEPTH)
+		{
+			cf.error = 1;
+			if (r->out)
+				fclose(r->out);
+			if (r->procs_out)
+				fclose(r->procs_out);
+			free(r->filename);
+			free(r);
+		}
+		else
+			os->report = r;
+	}
+
+	GET(&cf, present);
+	if (present && !cf.error)
+	{
+		QuantumTuner *qt = (QuantumTuner *)malloc(sizeof(QuantumTuner));
+		if (!qt)
+			assert(0 && "malloc failed restoring checkpoint");
+		get(&cf, qt, sizeof(QuantumTuner));
+		os->tuner = qt;
+		// the scheduler was created with the initial quantum
+		QuantumTuner_apply(qt, os);
+	}
+
+	GET(&cf, present);
+	if (present && !cf.error)
+	{
+		CoreCapacity *cap = (CoreCapacity *)malloc(sizeof(CoreCapacity));
+		if (!cap)
+			assert(0 && "malloc failed restoring checkpoint");
+		get(&cf, cap, sizeof(CoreCapacity));
+		CoreCapacity_allocCores(cap, os->cores);
+		get(&cf, cap->speed, CoreCapacity_coresSize(os->cores));
+		os->capacity = cap;
+	}
+
+	GET(&cf, present);
+	if (present && !cf.error)
+	{
+		EnergyModel *en = (EnergyModel *)malloc(sizeof(EnergyModel));
+		if (!en)
+			assert(0 && "malloc failed restoring checkpoint");
+		get(&cf, en, sizeof(EnergyModel));
+		if (!(en->core = (CorePower *)malloc(os->cores * sizeof(CorePower))))
+			assert(0 && "malloc failed restoring checkpoint");
+		get(&cf, en->core, os->cores * sizeof(CorePower));
+		os->energy = en;
+	}
+
+	GET(&cf, present);
+	if (present && !cf.error)
+	{
+		Topology *topo = (Topology *)malloc(sizeof(Topology));
+		if (!topo)
+			assert(0 && "malloc failed restoring checkpoint");
+		get(&cf, topo, sizeof(Topology));
+		os->topology = topo;
+	}
+
+	// the objects restored are the ones alive when the checkpoint was saved, the counters go on from there
+	get(&cf, &saved_mem, sizeof(MemStats));
+	get(&cf, magic, 8);
+	if (memcmp(magic, CHECKPOINT_MAGIC, 8))
+		cf.error = 1;
+	if (!cf.error)
+		mem_stats = saved_mem;
+
+	fclose(cf.f);
+	return cf.error ? -1 : 0;
+}
@@ -0,0 +1,355 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#include "../include/fake_os.h"
+#include "../include/sched_inline.h"
+#include "../include/core_capacity.h"
+
+/**
+ * @brief Bytes of the arrays of the cores, a single block starting at speed
+ *
+ * @param cores
+ * @return size_t
+ */
+size_t CoreCapacity_coresSize(int cores)
+{
+	return cores * (4 * sizeof(double) + 2 * sizeof(SimTime) + sizeof(int) + sizeof(unsigned int));
+}
+
+/**
+ * @brief Allocate the arrays of the cores, zeroed, in a single block: the 8 byte fields first
+ *
+ * @param cap
+ * @param cores
+ */
+void CoreCapacity_allocCores(CoreCapacity *cap, int cores)
+{
+	if (!(cap->speed = (double *)calloc(1, CoreCapacity_coresSize(cores))))
+		assert(0 && "calloc failed");
+	cap->freq = cap->speed + cores;
+	cap->scale = cap->freq + cores;
+	cap->credit = cap->scale + cores;
+	cap->work = (SimTime *)(cap->credit + cores);
+	cap->stall = cap->work + cores;
+	cap->cls = (int *)(cap->stall + cores);
+	cap->bursts = (unsigned int *)(cap->cls + cores);
+}
+
+/**
+ * @brief Create the cores from a spec of comma separated speeds, one per core, where
+ *        <n>x<speed> stands for n cores of that speed, e.g. 2x2.0,4x1.0 or 2,2,1,1,1,1
+ *
+ * @param spec
+ * @param cores number of cores of the OS
+ * @return CoreCapacity* NULL if the spec is not valid or doesn't give the speed of every core
+ */
+CoreCapacity *CoreCapacity_create(const char *spec, int cores)
+{
+	CoreCapacity *cap;
+	char *copy = strdup(spec);
+	char *save = NULL;
+	int n = 0;
+
+	if (!copy)
+		assert(0 && "strdup failed");
+	if (!(cap = (CoreCapacity *)calloc(1, sizeof(CoreCapacity))))
+		assert(0 && "calloc failed");
+	CoreCapacity_allocCores(cap, cores);
+	cap->cores = cores;
+
+	for (char *tok = strtok_r(copy, ",", &save); tok && n >= 0; tok = strtok_r(NULL, ",", &save))
+	{
+		int count = 1;
+		double speed;
+		char end;
+
+		if (sscanf(tok, "%dx%lf%c", &count, &speed, &end) != 2)
+		{
+			count = 1;
+			if (sscanf(tok, "%lf%c", &speed, &end) != 1)
+				speed = 0;
+		}
+		if (count < 1 || speed <= 0 || n + count > cores)
+			n = -1;
+		else
+			while (count--)
+			{
+				cap->freq[n] = 1.0;
+				cap->scale[n] = 1.0;
+				cap->speed[n++] = speed;
+			}
+	}
+	free(copy);
+
+	// the classes are the distinct speeds, the fastest first
+	for (int i = 0; i < n; i++)
+	{
+		double speed = cap->speed[i];
+		int k = 0;
+
+		while (k < cap->num_classes && cap->class_speed[k] > speed)
+			k++;
+		if (k < cap->num_classes && cap->class_speed[k] == speed)
+			continue;
+		if (cap->num_classes == MAX_CORE_CLASSES)
+		{
+			n = -1;
+			break;
+		}
+		memmove(&cap->class_speed[k + 1], &cap->class_speed[k], (cap->num_classes - k) * sizeof(double));
+		cap->class_speed[k] = speed;
+		cap->num_classes++;
+	}
+	if (n != cores)
+	{
+		CoreCapacity_destroy(cap);
+		return NULL;
+	}
+	for (int i = 0; i < cores; i++)
+		for (int k = 0; k < cap->num_classes; k++)
+			if (cap->class_speed[k] == cap->speed[i])
+				cap->cls[i] = k;
+	return cap;
+}
+
+/**
+ * @brief Choose the idle core of a process being dispatched: the fastest if its remaining burst
+ *        is heavy, the slowest if it is light
+ *
+ * @param cap
+ * @param os
+ * @param pcb
+ * @return int the core
+ */
+int CoreCapacity_place(CoreCapacity *cap, FakeOS *os, FakePCB *pcb)
+{
+	SimTime burst = sched_remainingBurst(pcb);
+	int heavy = burst >= cap->threshold;
+	int best = -1;
+
+	for (int i = 0; i < cap->cores; i++)
+	{
+		if (os->running[i])
+			continue;
+		if (best < 0 || (heavy ? cap->cls[i] < cap->cls[best] : cap->cls[i] > cap->cls[best]))
+			best = i;
+	}
+	assert(best >= 0 && "dispatch without an idle core");
+	return best;
+}
+
+/**
+ * @brief The remaining burst of a dispatched process updates the heavy threshold, whichever
+ *        model placed it
+ *
+ * @param cap
+ * @param pcb
+ */
+void CoreCapacity_observe(CoreCapacity *cap, FakePCB *pcb)
+{
+	SimTime burst = sched_remainingBurst(pcb);
+
+	cap->threshold = cap->threshold > 0 ? cap->threshold + CAPACITY_EWMA * (burst - cap->threshold) : burst;
+}
+
+/**
+ * @brief Whether a core is on a node, any core without a node aware topology
+ *
+ * @param os
+ * @param core
+ * @param node -1 for any node
+ * @return int
+ */
+static int onNode(const FakeOS *os, int core, int node)
+{
+	return node < 0 || Topology_node(os->topology, core) == node;
+}
+
+/**
+ * @brief Idle core of the fastest or of the slowest class of a node
+ *
+ * @param cap
+ * @param os
+ * @param fastest
+ * @param node -1 for any node
+ * @return int -1 if no core is idle
+ */
+static int idleCore(CoreCapacity *cap, FakeOS *os, int fastest, int node)
+{
+	int best = -1;
+
+	for (int i = 0; i < cap->cores; i++)
+	{
+		if (os->running[i] || !onNode(os, i, node))
+			continue;
+		if (best < 0 || (fastest ? cap->cls[i] < cap->cls[best] : cap->cls[i] > cap->cls[best]))
+			best = i;
+	}
+	return best;
+}
+
+/**
+ * @brief Number of heavy processes in the ready set
+ *
+ * @param cap
+ * @param os
+ * @return int
+ */
+static int heavyReady(CoreCapacity *cap, FakeOS *os)
+{
+	ListHead *lists[MAX_READY_LEVELS];
+	int num_levels = FakeOS_readyLists(os, lists);
+	int heavy = 0;
+
+	for (int i = 0; i < num_levels; i++)
+		for (ListItem *item = lists[i]->first; item; item = item->next)
+			if (sched_remainingBurst((FakePCB *)item) >= cap->threshold)
+				heavy++;
+	return heavy;
+}
+
+/**
+ * @brief Move the running process of a core to an idle one, with its slice
+ *
+ * @param os
+ * @param from
+ * @param to
+ */
+static void moveProcess(FakeOS *os, int from, int to)
+{
+	OS_LOG(os, ANSI_ORANGE "\t[>] PID: %2d migrated from Core: %2d to Core: %2d\n" ANSI_RESET,
+		   os->running[from]->pid, from, to);
+	os->running[to] = os->running[from];
+	os->running[from] = 0;
+}
+
+/**
+ * @brief Up and down migrations of the running processes of a node
+ *
+ * @param cap
+ * @param os
+ * @param node -1 for any node
+ * @param heavy_ready heavy processes ready to take a core, -1 before the ready set is scanned
+ */
+static void migrateNode(CoreCapacity *cap, FakeOS *os, int node, int *heavy_ready)
+{
+	int to;
+
+	// up: the heaviest process on a slower core takes the fastest idle core
+	while ((to = idleCore(cap, os, 1, node)) >= 0)
+	{
+		int from = -1;
+		SimTime heaviest = 0;
+
+		for (int i = 0; i < cap->cores; i++)
+		{
+			SimTime burst;
+			if (!os->running[i] || cap->cls[i] <= cap->cls[to] || !onNode(os, i, node))
+				continue;
+			if ((burst = sched_remainingBurst(os->running[i])) >= cap->threshold && (from < 0 || burst > heaviest))
+			{
+				from = i;
+				heaviest = burst;
+			}
+		}
+		if (from < 0)
+			break;
+		moveProcess(os, from, to);
+		cap->upmigrations++;
+	}
+
+	// down: the lightest process on a faster core goes to the slowest idle core, if a heavy
+	// process is ready to take the core it leaves
+	while ((to = idleCore(cap, os, 0, node)) >= 0)
+	{
+		int from = -1;
+		SimTime lightest = 0;
+
+		for (int i = 0; i < cap->cores; i++)
+		{
+			SimTime burst;
+			if (!os->running[i] || cap->cls[i] >= cap->cls[to] || !onNode(os, i, node))
+				continue;
+			if ((burst = sched_remainingBurst(os->running[i])) < cap->threshold * CAPACITY_LIGHT && (from < 0 || burst < lightest))
+			{
+				from = i;
+				lightest = burst;
+			}
+		}
+		if (from < 0)
+			break;
+		// the ready set is only scanned when a migration is possible
+		if (*heavy_ready < 0)
+			*heavy_ready = heavyReady(cap, os);
+		if ((*heavy_ready)-- == 0)
+			break;
+		moveProcess(os, from, to);
+		cap->downmigrations++;
+	}
+}
+
+/**
+ * @brief Up and down migrations of the running processes, before the idle cores are scheduled.
+ *        With a node aware topology a process only moves within its node, away from it the
+ *        balancing of the topology brings it home
+ *
+ * @param cap
+ * @param os
+ */
+void CoreCapacity_migrate(CoreCapacity *cap, FakeOS *os)
+{
+	int heavy_ready = -1;
+
+	if (!os->topology || os->topology->flat)
+		migrateNode(cap, os, -1, &heavy_ready);
+	else
+		for (int n = 0; n < os->topology->nodes; n++)
+			migrateNode(cap, os, n, &heavy_ready);
+}
+
+/**
+ * @brief Print the utilization and the throughput of every class of cores
+ *
+ * @param cap
+ * @param os
+ */
+void CoreCapacity_print(const CoreCapacity *cap, const FakeOS *os)
+{
+	double capacity = 0;
+	SimTime work = 0;
+
+	printf(ANSI_CYAN "\n%-14s %9s %9s %9s %9s %9s\n" ANSI_RESET, "Core classes:", "speed", "cores", "used", "work/ms", "bursts/s");
+	for (int k = 0; k < cap->num_classes; k++)
+	{
+		SimTime class_work = 0, busy = 0;
+		unsigned long bursts = 0;
+		int cores = 0;
+
+		for (int i = 0; i < cap->cores; i++)
+		{
+			if (cap->cls[i] != k)
+				continue;
+			cores++;
+			busy += os->core_busy_time[i];
+			class_work += cap->work[i];
+			bursts += cap->bursts[i];
+		}
+		capacity += cores * cap->class_speed[k];
+		work += class_work;
+		printf(ANSI_CYAN "  class %-6d %9.2f %9d %8.2f%% %9.3f %9.3f\n" ANSI_RESET, k, cap->class_speed[k], cores,
+			   (double)busy / ((double)os->timer * cores) * 100.0,
+			   (double)class_work / os->timer * os->ticks_per_ms, (double)bursts * 1000.0 * os->ticks_per_ms / os->timer);
+	}
+	printf(ANSI_CYAN "Capacity: \t\t\t[%.2f units/ms] used %.2f%%, heavy burst %.1f, migrations up %u down %u\n" ANSI_RESET,
+		   capacity * os->ticks_per_ms, (double)work / (capacity * os->timer) * 100.0, cap->threshold, cap->upmigrations, cap->downmigrations);
+}
+
+void CoreCapacity_destroy(CoreCapacity *cap)
+{
+	if (!cap)
+		return;
+	free(cap->speed);
+	free(cap);
+}
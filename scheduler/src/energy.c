@@ -0,0 +1,238 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#include "../include/fake_os.h"
+#include "../include/energy.h"
+
+// P-states, the highest frequency first: the power falls faster than the frequency
+static const PState pstates[MAX_PSTATES] = {
+	{1.00, 3.00},
+	{0.80, 1.90},
+	{0.60, 1.10},
+	{0.40, 0.60},
+};
+
+// C-states, the shallowest first
+static const CState cstates[MAX_CSTATES] = {
+	{"POLL", 0.50, 0, 0, 0},
+	{"C1", 0.30, 0, 0, 1},
+	{"C3", 0.10, 1, 1, 5},
+	{"C6", 0.02, 1, 2, 20},
+};
+
+static const char *governor_names[MAX_GOVERNORS] = {"performance", "powersave", "ondemand", "schedutil"};
+
+/**
+ * @brief Governor by name
+ *
+ * @param name performance, powersave, ondemand or schedutil
+ * @return int -1 if unknown
+ */
+int Energy_governor(const char *name)
+{
+	for (int gov = 0; gov < MAX_GOVERNORS; gov++)
+		if (!strcmp(name, governor_names[gov]))
+			return gov;
+	return -1;
+}
+
+/**
+ * @brief Create the energy model of the cores, idle at the start
+ *
+ * @param governor performance, powersave, ondemand or schedutil
+ * @param cores
+ * @param ticks_per_ms timebase of the simulation
+ * @return EnergyModel* NULL if the governor is unknown
+ */
+EnergyModel *Energy_create(const char *governor, int cores, SimTime ticks_per_ms)
+{
+	EnergyModel *en;
+	int gov = Energy_governor(governor);
+
+	if (gov < 0)
+		return NULL;
+
+	if (!(en = (EnergyModel *)calloc(1, sizeof(EnergyModel))) ||
+		!(en->core = (CorePower *)calloc(cores, sizeof(CorePower))))
+		assert(0 && "calloc failed");
+	en->governor = gov;
+	en->cores = cores;
+	en->period = EN_GOVERNOR_PERIOD * ticks_per_ms;
+	en->next_update = en->period;
+	for (int i = 0; i < cores; i++)
+	{
+		en->core[i].pstate = gov == GOV_POWERSAVE ? MAX_PSTATES - 1 : 0;
+		en->core[i].cstate = -1;
+	}
+	return en;
+}
+
+/**
+ * @brief Lowest P-state with at least the frequency
+ *
+ * @param freq relative to the highest one
+ * @return int
+ */
+static int pstateFor(double freq)
+{
+	int p = MAX_PSTATES - 1;
+
+	while (p > 0 && pstates[p].freq < freq)
+		p--;
+	return p;
+}
+
+/**
+ * @brief Frequency decision of the governor for a core, from its utilization in the last period
+ *
+ * @param en
+ * @param c
+ */
+static void Energy_govern(EnergyModel *en, CorePower *c)
+{
+	double util = (double)c->period_busy / en->period;
+
+	switch (en->governor)
+	{
+	case GOV_ONDEMAND:
+		c->pstate = util > EN_UP_THRESHOLD ? 0 : pstateFor(pstates[MAX_PSTATES - 1].freq + util * (1.0 - pstates[MAX_PSTATES - 1].freq));
+		break;
+	case GOV_SCHEDUTIL:
+		// the utilization at the current frequency, scaled to the highest one
+		c->pstate = pstateFor(EN_SCHEDUTIL_MARGIN * util * pstates[c->pstate].freq);
+		break;
+	default:
+		break;
+	}
+	c->period_busy = 0;
+}
+
+/**
+ * @brief Idle state for the predicted idle period of a core: the deepest one worth entering
+ *
+ * @param c
+ * @param ticks_per_ms the latencies of the states are in ms
+ * @return int
+ */
+static int Energy_idleState(const CorePower *c, SimTime ticks_per_ms)
+{
+	int s = MAX_CSTATES - 1;
+
+	while (s > 0 && cstates[s].target_residency * ticks_per_ms > c->idle_predict)
+		s--;
+	return s;
+}
+
+/**
+ * @brief Account the energy of the tick that starts: called once per step after scheduling, with
+ *        the processes that run in it. Cores that went idle choose their C-state, cores that got
+ *        a process wake up and stall for the exit latency, every period the governor decides
+ *
+ * @param en
+ * @param os with a CoreCapacity, the frequency and the stall are applied to its cores
+ */
+void Energy_tick(EnergyModel *en, FakeOS *os)
+{
+	CoreCapacity *cap = os->capacity;
+	SimTime per_ms = os->ticks_per_ms;
+
+	for (unsigned int i = 0; i < en->cores; i++)
+	{
+		CorePower *c = &en->core[i];
+		double power;
+
+		if (os->running[i])
+		{
+			if (c->cstate >= 0)
+			{
+				c->idle_predict += EN_IDLE_EWMA * ((double)(os->timer - c->idle_since) - c->idle_predict);
+				cap->stall[i] = cstates[c->cstate].exit_latency * per_ms;
+				c->cstate = -1;
+				c->wakeups++;
+			}
+			c->period_busy++;
+			c->pstate_time[c->pstate]++;
+			power = pstates[c->pstate].power * cap->speed[i];
+			en->busy_joules += power / (1000.0 * per_ms);
+		}
+		else
+		{
+			if (c->cstate < 0)
+			{
+				c->cstate = Energy_idleState(c, per_ms);
+				c->idle_since = os->timer;
+			}
+			c->cstate_time[c->cstate]++;
+			power = (os->timer - c->idle_since < cstates[c->cstate].entry_latency * per_ms ? cstates[0].power : cstates[c->cstate].power) * cap->speed[i];
+			en->idle_joules += power / (1000.0 * per_ms);
+		}
+		c->joules += power / (1000.0 * per_ms);
+	}
+
+	if (os->timer + 1 >= en->next_update)
+	{
+		for (unsigned int i = 0; i < en->cores; i++)
+		{
+			Energy_govern(en, &en->core[i]);
+			cap->freq[i] = pstates[en->core[i].pstate].freq;
+		}
+		en->next_update += en->period;
+	}
+}
+
+double Energy_joules(const EnergyModel *en)
+{
+	return en->busy_joules + en->idle_joules;
+}
+
+/**
+ * @brief Print the energy, its split, the energy per process, the energy-delay product
+ *        (energy times total time) and the residency of the P-states and the C-states
+ *
+ * @param en
+ * @param os
+ */
+void Energy_print(const EnergyModel *en, const FakeOS *os)
+{
+	unsigned long pstate_time[MAX_PSTATES] = {0}, cstate_time[MAX_CSTATES] = {0};
+	unsigned long busy = 0, idle = 0, wakeups = 0;
+	double joules = Energy_joules(en);
+	double seconds = os->timer / (1000.0 * os->ticks_per_ms);
+
+	for (unsigned int i = 0; i < en->cores; i++)
+	{
+		for (int p = 0; p < MAX_PSTATES; p++)
+		{
+			pstate_time[p] += en->core[i].pstate_time[p];
+			busy += en->core[i].pstate_time[p];
+		}
+		for (int s = 0; s < MAX_CSTATES; s++)
+		{
+			cstate_time[s] += en->core[i].cstate_time[s];
+			idle += en->core[i].cstate_time[s];
+		}
+		wakeups += en->core[i].wakeups;
+	}
+
+	printf(ANSI_CYAN "\nEnergy: \t\t\t[%.3f J] busy %.3f J, idle %.3f J, avg power %.3f W, governor %s\n" ANSI_RESET,
+		   joules, en->busy_joules, en->idle_joules, seconds > 0 ? joules / seconds : 0.0, governor_names[en->governor]);
+	printf(ANSI_CYAN "Energy per process: \t\t[%.4f J]\n" ANSI_RESET, os->stats.completed ? joules / os->stats.completed : 0.0);
+	printf(ANSI_CYAN "Energy-delay product: \t\t[%.3f J*s]\n" ANSI_RESET, joules * seconds);
+	printf(ANSI_CYAN "P-states (busy time):\t\t" ANSI_RESET);
+	for (int p = 0; p < MAX_PSTATES; p++)
+		printf(ANSI_CYAN "[P%d %.2f: %.2f%%] " ANSI_RESET, p, pstates[p].freq, busy ? pstate_time[p] * 100.0 / busy : 0.0);
+	printf(ANSI_CYAN "\nC-states (idle time):\t\t" ANSI_RESET);
+	for (int s = 0; s < MAX_CSTATES; s++)
+		printf(ANSI_CYAN "[%s: %.2f%%] " ANSI_RESET, cstates[s].name, idle ? cstate_time[s] * 100.0 / idle : 0.0);
+	printf(ANSI_CYAN "wakeups %lu\n" ANSI_RESET, wakeups);
+}
+
+void Energy_destroy(EnergyModel *en)
+{
+	if (!en)
+		return;
+	free(en->core);
+	free(en);
+}
@@ -5,30 +5,7 @@
 #include <time.h>
 
 #include "../include/fake_os.h"
-#include <dirent.h>
-
-char usage_buffer[1024] = "Usage: %s <num_cores> <scheduler> <quantum> <traces_folder> \n\
-\n\
-<num_cores>: Number of cores to simulate the processes on. \n\
-<scheduler>: The scheduling algorithm to use: \n\
-	1: First Come First Served (FCFS) \n\
-	2: First Come First Served (FCFS) preemptive \n\
-	3: Shortest Job First (SJF) with prediction \n\
-	4: Shortest Job First (SJF) preemptive with prediction \n\
-	5: Shortest Job First (SJF) no prediction \n\
-	6: Shortest Remaining Time First (SRTF) (a sjf with preemptive)\n\
-	7: Priority \n\
-	8: Priority preemptive \n\
-	9: Round Robin (RR) \n\
-	10: Multi-Level Queue (MLQ) \n\
-	11: Multi-Level Feedback Queue (MLFQ) \n\
-<quantum>: The quantum to use for the scheduling algorithm. \n\
-<traces_folder>: The path to the folder containing the traces. \n\
-\n\
-Example: %s 4 3 10 traces_folder \n\
-\n\
-This will simulate a 4 core system using the SJF with prediction scheduling algorithm and a quantum of 10 using the traces in the traces_folder. \
-\n";
+#include "../include/sched_inline.h"
 
 char *print_priority(ProcessPriority priority)
 {
@@ -49,50 +26,80 @@ char *print_priority(ProcessPriority priority)
 	}
 }
 
+char *print_scheduler(SchedulerType scheduler)
+{
+	switch (scheduler)
+	{
+	case FCFS:
+		return "FCFS";
+	case FCFS_PREEMPTIVE:
+		return "FCFS_PREEMPTIVE";
+	case SJF_PREDICT:
+		return "SJF_PREDICT";
+	case SJF_PREDICT_PREEMPTIVE:
+		return "SJF_PREDICT_PREEMPTIVE";
+	case SJF_PURE:
+		return "SJF_PURE";
+	case SRTF:
+		return "SRTF";
+	case PRIORITY:
+		return "PRIORITY";
+	case PRIORITY_PREEMPTIVE:
+		return "PRIORITY_PREEMPTIVE";
+	case RR:
+		return "RR";
+	case MLQ:
+		return "MLQ";
+	case MLFQ:
+		return "MLFQ";
+	default:
+		return "UNKNOWN";
+	}
+}
+
 void printPCB(ListItem *item)
 {
 	FakePCB *pcb = (FakePCB *)item;
 	printf("PID: %d\n", pcb->pid);
 	printf("Priority: %s\n", print_priority(pcb->priority));
-	printf("Duration: %d\n", pcb->duration);
+	printf("Duration: %lld\n", (long long)pcb->duration);
 	// List_print(&pcb->events, printProcessEvent);
 }
 
 void FakeOS_printReadyQueue(FakeOS *os)
 {
-	ListItem *aux;
+	os->ops->print(os->schedule_args, os);
+}
 
-	switch (os->scheduler)
-	{
-	case SJF_PREDICT:
-	case SJF_PREDICT_PREEMPTIVE:
-		SJF_printQueue(os);
-		break;
-	case PRIORITY:
-	case PRIORITY_PREEMPTIVE:
-		Prior_printQueue(os);
-		break;
-	case MLQ:
-		MLQ_printQueue((SchedMLQArgs *)os->schedule_args);
-		break;
-	case MLFQ:
-		MLFQ_printQueue((SchedMLFQArgs *)os->schedule_args);
-		break;
-	default:
-		aux = os->ready.first;
-		printf(ANSI_BLUE "\nREADY QUEUE:\n" ANSI_RESET);
-		while (aux)
-		{
-			FakePCB *pcb = (FakePCB *)aux;
-			ProcessEvent *e = (ProcessEvent *)pcb->events.first;
-			assert(e->type == CPU);
-			printf(ANSI_BLUE "\tPID: %2d - CPU_burst: %3d - Priority: %-8s\n" ANSI_RESET, 
-				pcb->pid, e->duration, print_priority(pcb->priority));
-			aux = aux->next;
-		}
-	}
+/**
+ * @brief The lists holding the ready processes: one level for the single queue schedulers,
+ *        one per queue for MLQ and MLFQ
+ *
+ * @param os
+ * @param lists array of at least MAX_READY_LEVELS elements to fill
+ * @return int number of levels
+ */
+int FakeOS_readyLists(FakeOS *os, ListHead **lists)
+{
+	return os->ops->stats(os->schedule_args, lists);
 }
 
+/**
+ * @brief Length of each level of the ready queue (see FakeOS_readyLists)
+ *
+ * @param os
+ * @param sizes array of at least MAX_READY_LEVELS elements to fill
+ * @return int number of levels
+ */
+int FakeOS_readyLevels(FakeOS *os, int *sizes)
+{
+	ListHead *lists[MAX_READY_LEVELS];
+	int num_levels = FakeOS_readyLists(os, lists);
+
+	for (int i = 0; i < num_levels; i++)
+		sizes[i] = lists[i]->size;
+	return num_levels;
+}
 
 /**
  * @brief Increase the duration of the running processes
@@ -104,27 +111,30 @@ void increaseDuration(FakeOS *os)
 	FakePCB *pcb;
 	int i = -1;
 
-	while (++i < os->cores && (pcb = *(os->running + i)))
+	// the idle cores can be anywhere, they don't end the scan
+	while (++i < os->cores)
 	{
-		if (pcb->pid)
+		if ((pcb = *(os->running + i)) && pcb->pid)
 			pcb->duration++;
 	}
 }
 
 /**
- * @brief Check if all the cores are full
+ * @brief Number of cores without a running process
  * @param running
+ * @param cores
  * @return int
  */
-int cpuFull(FakePCB **running, int cores)
+int idleCores(FakePCB **running, int cores)
 {
+	int idle = 0;
 	int i = -1;
 	while (++i < cores)
 	{
-		if (!running[i] || !(*running[i]).pid)
-			return 0;
+		if (!running[i])
+			idle++;
 	}
-	return 1;
+	return idle;
 }
 
 /**
@@ -137,95 +147,295 @@ void FakeOS_init(FakeOS *os, int cores)
 	os->running = calloc(cores, sizeof(FakePCB *));
 	if (!os->running)
 		assert(0 && "malloc failed creating running array");
-	List_init(&os->ready);
 	List_init(&os->waiting);
 	List_init(&os->processes);
-	List_init(&os->terminated_stats);
+	PCBTable_init(&os->pcbs);
+	os->stats.completed = 0;
+	LatencyHist_init(&os->stats.turnaround);
+	LatencyHist_init(&os->stats.waiting);
+	LatencyHist_init(&os->stats.response);
+	Accounting_init(&os->acct);
+	os->stream = 0;
 	os->timer = 0;
-	os->schedule_fn = 0;
+	os->ticks_per_ms = TIMEBASE_MS;
+	os->next_pid = 1;
+	os->ops = 0;
+	os->step = 0;
+	os->schedule_args = 0;
 	os->cores = cores;
 	os->cpu_busy_time = 0;
+	os->core_busy_time = calloc(cores, sizeof(SimTime));
+	if (!os->core_busy_time)
+		assert(0 && "malloc failed creating core busy time array");
+	os->sampler = 0;
+	os->report = 0;
+	os->tuner = 0;
+	os->capacity = 0;
+	os->energy = 0;
+	os->topology = 0;
+	os->wakeup_granularity = -1;
+	os->wakeup_rank = 0;
+	os->woken = 0;
+	os->num_woken = 0;
+	os->max_woken = 0;
+	os->wakeup_preemptions = 0;
+	os->verbose = 1;
+	os->mem_report = 0;
 }
 
+static void FakeOS_stepFCFS(FakeOS *os);
+static void FakeOS_stepSJF(FakeOS *os);
+static void FakeOS_stepPrior(FakeOS *os);
+static void FakeOS_stepRR(FakeOS *os);
+static void FakeOS_stepMLQ(FakeOS *os);
+static void FakeOS_stepMLFQ(FakeOS *os);
+
+// policy and specialized step of each scheduler, the variants of a policy only differ in its arguments.
+// The preemptive variants of a policy with a rank can also preempt on wakeup
+static const struct
+{
+	const SchedOps *ops;
+	void (*step)(FakeOS *os);
+	int wakeup;
+} schedulers[MAX_SCHEDULERS] = {
+	[FCFS] = {&FCFS_ops, FakeOS_stepFCFS, 0},
+	[FCFS_PREEMPTIVE] = {&FCFS_ops, FakeOS_stepFCFS, 0},
+	[SJF_PREDICT] = {&SJF_ops, FakeOS_stepSJF, 0},
+	[SJF_PREDICT_PREEMPTIVE] = {&SJF_ops, FakeOS_stepSJF, 1},
+	[SJF_PURE] = {&SJFPure_ops, FakeOS_stepSJF, 0},
+	[SRTF] = {&SJFPure_ops, FakeOS_stepSJF, 1},
+	[PRIORITY] = {&Prior_ops, FakeOS_stepPrior, 0},
+	[PRIORITY_PREEMPTIVE] = {&Prior_ops, FakeOS_stepPrior, 1},
+	[RR] = {&RR_ops, FakeOS_stepRR, 0},
+	[MLQ] = {&MLQ_ops, FakeOS_stepMLQ, 0},
+	[MLFQ] = {&MLFQ_ops, FakeOS_stepMLFQ, 0},
+};
+
 /**
- * @brief Set the scheduler function and arguments
+ * @brief Set the scheduler operations and arguments
  *
  * @param os
  * @param scheduler
  */
-void FakeOS_setScheduler(FakeOS *os, SchedulerType scheduler, int quantum)
+void FakeOS_setScheduler(FakeOS *os, SchedulerType scheduler, SimTime quantum)
 {
     assert(os && "null pointer");
-
-    void *args;  // Variabile generica per gestire i diversi tipi di args
-	float aging_threshold = quantum * AGING_FACTOR;
-
-    switch (scheduler)
-    {
-    case FCFS:
-	case FCFS_PREEMPTIVE:
-		args = FCFSArgs(quantum, scheduler);
-        os->schedule_fn = schedFCFS;
-        break;
-    case SJF_PREDICT:
-    case SJF_PREDICT_PREEMPTIVE:
-    case SJF_PURE:
-	case SRTF:
-		args = SJFArgs(quantum, scheduler);
-        os->schedule_fn = schedSJF;
-        break;
-	case PRIORITY:
-	case PRIORITY_PREEMPTIVE:
-		args = PriorArgs(quantum, aging_threshold, scheduler);
-		os->schedule_fn = schedPriority;
-		break;
-	case RR:
-		args = RRArgs(quantum, scheduler);
-        os->schedule_fn = schedRR;
-        break;
-	case MLQ:
-		args = MLQArgs(quantum);
-		os->schedule_fn = schedMLQ;
-		break;
-    case MLFQ:
-		args = MLFQArgs(quantum, aging_threshold);
-		os->schedule_fn = schedMLFQ;
-        break;
-
-    default:
+    if (scheduler < 0 || scheduler >= MAX_SCHEDULERS)
         assert(0 && "illegal scheduler");
-    }
 
 	// set the scheduler arguments and type
     os->scheduler = scheduler;
-    os->schedule_args = args;
+    os->quantum = quantum;
+    os->ops = schedulers[scheduler].ops;
+    os->step = schedulers[scheduler].step;
+    os->schedule_args = os->ops->init(quantum, scheduler);
+    os->wakeup_rank = (os->wakeup_granularity >= 0 && schedulers[scheduler].wakeup) ? os->ops->rank : 0;
+}
+
+/**
+ * @brief Turn on the wakeup preemption: a process entering the ready set preempts the worst
+ *        running process if it ranks better and has run at least granularity ticks
+ *
+ * @param os
+ * @param granularity
+ * @return int 0, -1 if the scheduler is not a preemptive SJF, SRTF or priority
+ */
+int FakeOS_setWakeupPreemption(FakeOS *os, SimTime granularity)
+{
+	if (granularity < 0 || !schedulers[os->scheduler].wakeup || !os->ops->rank)
+		return -1;
+
+	os->wakeup_granularity = granularity;
+	os->wakeup_rank = os->ops->rank;
+	return 0;
+}
+
+/**
+ * @brief Identical cores of speed 1 for the models that act on the speed of the cores,
+ *        if the cores have no speeds. A single class neither migrates nor is printed
+ *
+ * @param os
+ */
+static void FakeOS_uniformCapacity(FakeOS *os)
+{
+	char spec[32];
+
+	snprintf(spec, sizeof(spec), "%ux1", os->cores);
+	if (!os->capacity)
+		os->capacity = CoreCapacity_create(spec, os->cores);
+}
+
+/**
+ * @brief Turn on the energy model. It drives the frequency and the wakeups of the cores
+ *
+ * @param os
+ * @param governor performance, powersave, ondemand or schedutil
+ * @return int 0, -1 if the governor is unknown
+ */
+int FakeOS_setEnergy(FakeOS *os, const char *governor)
+{
+	if (!(os->energy = Energy_create(governor, os->cores, os->ticks_per_ms)))
+		return -1;
+	FakeOS_uniformCapacity(os);
+	return 0;
+}
+
+/**
+ * @brief Lay the cores out in sockets, NUMA nodes and SMT siblings (see topology.h)
+ *
+ * @param os
+ * @param spec
+ * @return int 0, -1 if the spec is not valid for the cores
+ */
+int FakeOS_setTopology(FakeOS *os, const char *spec)
+{
+	if (!(os->topology = Topology_create(spec, os->cores, os->ticks_per_ms)))
+		return -1;
+	FakeOS_uniformCapacity(os);
+	return 0;
+}
+
+/**
+ * @brief Free the arguments of the scheduler
+ *
+ * @param os
+ */
+static void FakeOS_destroySchedulerArgs(FakeOS *os)
+{
+	if (!os->schedule_args)
+		return;
+
+	os->ops->destroy(os->schedule_args);
+	os->schedule_args = 0;
+}
+
+/**
+ * @brief Give a process the arguments of the current scheduler, as if it had just arrived
+ *
+ * @param os
+ * @param pcb
+ */
+static void FakeOS_resetProcArgs(FakeOS *os, FakePCB *pcb)
+{
+	FakeProcess_setArgs(FakeOS_hot(os, pcb), pcb, os->ops);
+	pcb->quantum_used = 0;
+}
+
+/**
+ * @brief Change the scheduler of a running simulation. The ready processes move, in order,
+ *        in the queues of the new scheduler; the new scheduler starts with fresh per process
+ *        arguments while the statistics of the processes are kept
+ *
+ * @param os
+ * @param scheduler
+ * @param quantum
+ */
+void FakeOS_switchScheduler(FakeOS *os, SchedulerType scheduler, SimTime quantum)
+{
+	ListHead ready;
+	ListHead *levels[MAX_READY_LEVELS];
+	ListItem *aux;
+
+	// take the ready processes out of the old queues, level by level
+	List_init(&ready);
+	int num_levels = FakeOS_readyLists(os, levels);
+	for (int i = 0; i < num_levels; i++)
+		while ((aux = List_popFront(levels[i])))
+			List_pushBack(&ready, aux);
+
+	FakeOS_destroySchedulerArgs(os);
+	FakeOS_setScheduler(os, scheduler, quantum);
+
+	for (unsigned int i = 0; i < os->cores; i++)
+		if (os->running[i])
+			FakeOS_resetProcArgs(os, os->running[i]);
+	for (aux = os->waiting.first; aux; aux = aux->next)
+		FakeOS_resetProcArgs(os, (FakePCB *)aux);
+
+	// the enqueue time of the processes is kept, their waiting time goes on
+	while ((aux = List_popFront(&ready)))
+	{
+		FakePCB *pcb = (FakePCB *)aux;
+		FakeOS_resetProcArgs(os, pcb);
+		os->ops->enqueue(os->schedule_args, os, pcb);
+	}
+
+	// the new scheduler goes on with the adapted quantum
+	if (os->tuner)
+		QuantumTuner_apply(os->tuner, os);
+}
+
+/**
+ * @brief Allocate an empty process with the next free pid
+ *
+ * @param os
+ * @return FakeProcess*
+ */
+static FakeProcess *FakeOS_allocProcess(FakeOS *os)
+{
+    // Allocate memory for the new process
+    FakeProcess *new_process = (FakeProcess *)MemStats_alloc(MEM_PROCESS, sizeof(FakeProcess));
+    if (!new_process)
+        assert(0 && "malloc failed creating process");
+
+    new_process->list.next = new_process->list.prev = 0;
+    new_process->pid = os->next_pid++;
+    new_process->arrival_time = 0;
+    new_process->priority = NORMAL;
+    new_process->source = -1;
+    List_init(&new_process->events);
+
+    return new_process;
+}
+
+/**
+ * @brief Append an event to the events of a process
+ *
+ * @param p The process
+ * @param type The resource of the event
+ * @param duration The duration of the event, in ticks
+ */
+static void FakeOS_addEvent(FakeProcess *p, ResourceType type, SimTime duration)
+{
+    ProcessEvent *new_event = (ProcessEvent *)MemStats_alloc(MEM_EVENT, sizeof(ProcessEvent));
+    if (!new_event)
+        assert(0 && "malloc failed creating event");
+
+    new_event->type = type;
+    new_event->duration = duration;
+    new_event->list.next = new_event->list.prev = 0;
+    List_pushBack(&p->events, (ListItem *)new_event);
 }
 
 /**
  * @brief Create a process and put it in the list of processes to be created
  *
  * @param os The fake OS instance
- * @param proc_num The process number to create
+ * @param proc_file The trace file of the process
  */
 void FakeOS_createProcess(FakeOS *os, const char *proc_file)
 {
-    static unsigned int pid = 1;
     char line[256];
+    char source[64];
+    int64_t time;
 
     // Read the process file
     FILE *file = fopen(proc_file, "r");
     assert(file && "file not found");
 
-    // Allocate memory for the new process
-    FakeProcess *new_process = (FakeProcess *)malloc(sizeof(FakeProcess));
-    if (!new_process)
-        assert(0 && "malloc failed creating process");
-
-    new_process->pid = pid++;
+    FakeProcess *new_process = FakeOS_allocProcess(os);
 
     while (fgets(line, sizeof(line), file))
     {
-        if (line[0] == '#' || line[0] == '\n')
+        // the header tells the profile the process was generated from
+        if (line[0] == '#')
+        {
+            char *from = strstr(line, "From:");
+            if (from && sscanf(from, "From: %63s", source) == 1)
+                new_process->source = Accounting_sourceId(&os->acct, source);
+            continue;
+        }
+        if (line[0] == '\n')
             continue;
 
         // Find the position of comment if present
@@ -235,41 +445,76 @@ void FakeOS_createProcess(FakeOS *os, const char *proc_file)
             *comment_pos = '\0'; // Truncate the line at the comment
         }
 
-        // Parse the line
+        // Parse the line, the times are in ms or have their unit (see TraceTime_parse)
         if (strncmp(line, "Arrival", 7) == 0)
-            sscanf(line, "Arrival %d", &new_process->arrival_time);
+        {
+            if ((time = TraceTime_parse(line + 7, NULL)) >= 0)
+                new_process->arrival_time = Timebase_fromNs(os->ticks_per_ms, time);
+        }
 
         else if (strncmp(line, "Priority", 8) == 0)
-            sscanf(line, "Priority %d", &new_process->priority);
+            sscanf(line, "Priority %d", (int *)&new_process->priority);
 
-        else if (strncmp(line, "CPU", 3) == 0 || strncmp(line, "IO", 2) == 0)
-        {
-            ProcessEvent *new_event = (ProcessEvent *)malloc(sizeof(ProcessEvent));
-            if (!new_event)
-                assert(0 && "malloc failed creating event");
-
-            // Determina il tipo di evento e salva il valore
-            if (strncmp(line, "CPU", 3) == 0)
-            {
-                new_event->type = CPU;
-                sscanf(line, "CPU %d", &new_event->duration);
-            }
-            else
-            {
-                new_event->type = IO;
-                sscanf(line, "IO %d", &new_event->duration);
-            }
-            
-            // Inizializza i puntatori della lista
-            new_event->list.next = new_event->list.prev = 0;
-            List_pushBack(&new_process->events, (ListItem *)new_event);
-        }
+        // Determina il tipo di evento e salva il valore
+        else if (strncmp(line, "CPU", 3) == 0 && (time = TraceTime_parse(line + 3, NULL)) >= 0)
+            FakeOS_addEvent(new_process, CPU, Timebase_fromNs(os->ticks_per_ms, time));
+
+        else if (strncmp(line, "IO", 2) == 0 && (time = TraceTime_parse(line + 2, NULL)) >= 0)
+            FakeOS_addEvent(new_process, IO, Timebase_fromNs(os->ticks_per_ms, time));
     }
 
     fclose(file);
     List_pushBack(&os->processes, (ListItem *)new_process);
 
-    printf(ANSI_GREEN "\t[+] process created\n" ANSI_RESET);
+    OS_LOG(os, ANSI_GREEN "\t[+] process created\n" ANSI_RESET);
+}
+
+/**
+ * @brief Move the processes of the stream arriving at the current time in the list of processes to be created.
+ *        The stream is in arrival order, so only the arrivals of this step are taken from it
+ *
+ * @param os The fake OS instance
+ */
+void FakeOS_streamProcesses(FakeOS *os)
+{
+    TraceProc *tp;
+    int64_t arrival;
+
+    while ((arrival = TraceStream_peekArrival(os->stream)) >= 0 && Timebase_fromNs(os->ticks_per_ms, arrival) == os->timer)
+    {
+        tp = TraceStream_next(os->stream);
+
+        FakeProcess *new_process = FakeOS_allocProcess(os);
+        new_process->arrival_time = os->timer;
+        new_process->priority = tp->priority;
+        new_process->source = Accounting_sourceId(&os->acct, tp->source_type);
+        for (int i = 0; i < tp->num_bursts; i++)
+            FakeOS_addEvent(new_process, (tp->bursts[i].type == TRACE_CPU) ? CPU : IO,
+                            Timebase_fromNs(os->ticks_per_ms, tp->bursts[i].duration));
+
+        List_pushBack(&os->processes, (ListItem *)new_process);
+    }
+}
+
+/**
+ * @brief Remember a process that entered the ready set, for the wakeup preemption of the step
+ *
+ * @param os
+ * @param pcb
+ */
+static void FakeOS_wakeup(FakeOS *os, FakePCB *pcb)
+{
+	ProcessEvent *e = (ProcessEvent *)pcb->events.first;
+	if (!e || e->type != CPU)
+		return;
+
+	if (os->num_woken == os->max_woken)
+	{
+		os->max_woken = os->max_woken ? os->max_woken * 2 : 16;
+		if (!(os->woken = (FakePCB **)realloc(os->woken, os->max_woken * sizeof(FakePCB *))))
+			assert(0 && "realloc failed growing the woken processes");
+	}
+	os->woken[os->num_woken++] = pcb;
 }
 
 /**
@@ -282,8 +527,9 @@ void FakeOS_createPcb(FakeOS *os, FakeProcess *p)
 {
 	// sanity check
 	assert(p->arrival_time == os->timer && "time mismatch in creation");
-	// we check that in the list of PCBs there is no
-	// pcb having the same pid
+	// the pids are handed out once by FakeOS_allocProcess, checking it is enough:
+	// the ready and waiting lists aren't scanned on every arrival
+	assert(p->pid > 0 && (unsigned int)p->pid < os->next_pid && "pid not allocated");
 	int i = -1;
 	while (++i < os->cores)
 	{
@@ -291,51 +537,43 @@ void FakeOS_createPcb(FakeOS *os, FakeProcess *p)
 		assert((!running || running->pid != p->pid) && "pid taken");
 	}
 
-	ListItem *aux = os->ready.first;
-	while (aux)
-	{
-		FakePCB *pcb = (FakePCB *)aux;
-		assert(pcb->pid != p->pid && "pid taken");
-		aux = aux->next;
-	}
-
-	aux = os->waiting.first;
-	while (aux)
-	{
-		FakePCB *pcb = (FakePCB *)aux;
-		assert(pcb->pid != p->pid && "pid taken");
-		aux = aux->next;
-	}
-
 	// all fine, no such pcb exists, we can create it
-	FakePCB *new_pcb = (FakePCB *)malloc(sizeof(FakePCB));
+	FakePCB *new_pcb = (FakePCB *)MemStats_alloc(MEM_PCB, sizeof(FakePCB));
 	if (!new_pcb)
 		assert(0 && "malloc failed creating pcb");
 	new_pcb->list.next = new_pcb->list.prev = 0;
 	new_pcb->pid = p->pid;
+	new_pcb->id = PCBTable_alloc(&os->pcbs);
 	new_pcb->events = p->events;
 	new_pcb->priority = p->priority;
+	new_pcb->source = p->source;
+	new_pcb->home_node = -1;
+	new_pcb->remote_passes = 0;
 	new_pcb->duration = 0;
 	new_pcb->quantum_used = 0;
-	new_pcb->stats = FakeProcess_initiStats();
-	FakeProcess_setArgs(new_pcb, os->scheduler);
+	FakeOS_hot(os, new_pcb)->burst = 0;
+	FakeOS_hot(os, new_pcb)->ready_since = 0;
+	FakeProcess_initiStats(FakeOS_cold(os, new_pcb));
+	FakeProcess_setArgs(FakeOS_hot(os, new_pcb), new_pcb, os->ops);
 	FakeOS_procUpdateStats(os, new_pcb, ARRIVAL_TIME); 
      
 	assert(new_pcb->events.first && "process without events");
 
 	FakeOS_enqueueProcess(os, new_pcb);
+	if (os->wakeup_rank)
+		FakeOS_wakeup(os, new_pcb);
 }
 
 /**
- * @brief Destroy a PCB and free its memory
+ * @brief Destroy a PCB, free its memory and its slot in the table
  *
+ * @param os
  * @param pcb
  */
-void FakeOS_destroyPCB(FakePCB *pcb)
+void FakeOS_destroyPCB(FakeOS *os, FakePCB *pcb)
 {
-	if (pcb->args)
-		free(pcb->args);
-	free(pcb);	
+	PCBTable_release(&os->pcbs, pcb->id);
+	MemStats_free(MEM_PCB, pcb, sizeof(FakePCB));
 }
 
 /**
@@ -347,37 +585,61 @@ void FakeOS_destroyPCB(FakePCB *pcb)
  */
 void FakeOS_procUpdateStats(FakeOS *os, FakePCB *pcb, ProcStatsType type)
 {
+	ProcessStats *stats = FakeOS_cold(os, pcb);
+
 	switch (type)
 	{
 	case ARRIVAL_TIME:
-		FakeProcess_arrivalTime(pcb, os->timer);
+		FakeProcess_arrivalTime(stats, os->timer);
 		break;
 	case READY_ENQUEUE:
-		FakeProcess_lastEnqueuedTime(pcb, os->timer);
+		FakeProcess_lastEnqueuedTime(FakeOS_hot(os, pcb), os->timer);
 		break;
 	case COMPLETE_TIME:
-		FakeProcess_completeTime(pcb, os->timer);
+		FakeProcess_completeTime(stats, os->timer);
 	case TURNAROUND_TIME:
-		FakeProcess_turnaroundTime(pcb, os->timer);
+		FakeProcess_turnaroundTime(stats, os->timer);
 		break;
 	case WAITING_TIME:
-		FakeProcess_waitingTime(pcb, os->timer);
+		FakeProcess_waitingTime(stats, FakeOS_hot(os, pcb), os->timer);
 	case RESPONSE_TIME:
-		FakeProcess_responseTime(pcb, os->timer);
+		if (os->tuner && !stats->response_time)
+			QuantumTuner_observeResponse(os->tuner, os->timer - stats->arrival_time);
+		FakeProcess_responseTime(stats, os->timer);
 		break;
 	default:
 		assert(0 && "illegal stat type");
 	}
 }
 
+/**
+ * @brief Feed the statistics of a terminated process to the histograms of the OS
+ *
+ * @param os
+ * @param pcb
+ */
+void FakeOS_recordStats(FakeOS *os, FakePCB *pcb)
+{
+	ProcessStats *stats = FakeOS_cold(os, pcb);
+
+	Accounting_terminated(&os->acct, pcb, stats);
+	if (os->report)
+		Report_process(os->report, os, pcb);
+	os->stats.completed++;
+	LatencyHist_record(&os->stats.turnaround, stats->turnaround_time);
+	LatencyHist_record(&os->stats.waiting, stats->waiting_time);
+	LatencyHist_record(&os->stats.response, stats->response_time);
+}
+
 /**
  * @brief Enqueue a process in the ready or waiting list
  *
  * @param os
  * @param pcb
- * @param old_event_type
+ * @param enqueue enqueue hook of the scheduler, a constant in the specialized steps
  */
-void FakeOS_enqueueProcess(FakeOS *os, FakePCB *pcb)
+static inline __attribute__((always_inline))
+void FakeOS_enqueueWith(FakeOS *os, FakePCB *pcb, SchedEnqueueFn enqueue)
 {
 	if (pcb->events.first)
 	{
@@ -385,19 +647,16 @@ void FakeOS_enqueueProcess(FakeOS *os, FakePCB *pcb)
 		switch (e->type)
 		{
 		case CPU:
-			if (os->scheduler == MLFQ)
-				MLFQ_enqueue(os, pcb);
-			else if (os->scheduler == MLQ)
-				MLQ_enqueue(os, pcb);
-			else
-				List_pushBack(&os->ready, (ListItem *)pcb);
+			// the key of the burst sits with the others, the picks don't follow the events
+			FakeOS_hot(os, pcb)->burst = e->duration;
+			enqueue(os->schedule_args, os, pcb);
 			FakeOS_procUpdateStats(os, pcb, READY_ENQUEUE);
-			printf(ANSI_ORANGE "\t\t[!] move to ready\n" ANSI_RESET);
+			OS_LOG(os, ANSI_ORANGE "\t\t[!] move to ready\n" ANSI_RESET);
 			break;
 		case IO:
 			// if the process requires I/O, we put it in the waiting list and increment the priority
 			List_pushBack(&os->waiting, (ListItem *)pcb);
-			printf(ANSI_YELLOW "\t\t[!] move to waiting\n" ANSI_RESET);
+			OS_LOG(os, ANSI_YELLOW "\t\t[!] move to waiting\n" ANSI_RESET);
 			break;
 		default:
 			assert(0 && "illegal resource");
@@ -405,21 +664,176 @@ void FakeOS_enqueueProcess(FakeOS *os, FakePCB *pcb)
 	}
 	else
 	{
-		List_pushBack(&os->terminated_stats, (ListItem *)pcb->stats);
 		FakeOS_procUpdateStats(os, pcb, COMPLETE_TIME);
-		FakeOS_destroyPCB(pcb);
-		printf(ANSI_RED "\t\t[-] end process\n" ANSI_RESET);
+		FakeOS_recordStats(os, pcb);
+		FakeOS_destroyPCB(os, pcb);
+		OS_LOG(os, ANSI_RED "\t\t[-] end process\n" ANSI_RESET);
 	}
 }
 
+void FakeOS_enqueueProcess(FakeOS *os, FakePCB *pcb)
+{
+	FakeOS_enqueueWith(os, pcb, os->ops->enqueue);
+}
+
 /**
- * @brief Simulate a step of the fake OS process scheduler
+ * @brief Take a running process off its core and put it back in the ready set.
+ *        The rest of the slice it was running goes back into its burst
  *
  * @param os
+ * @param core
  */
-void FakeOS_simStep(FakeOS *os)
+static void FakeOS_preempt(FakeOS *os, int core)
+{
+	FakePCB *pcb = os->running[core];
+	ProcessEvent *e = (ProcessEvent *)pcb->events.first;
+	ProcessEvent *next = (ProcessEvent *)e->list.next;
+
+	os->running[core] = 0;
+	if (pcb->quantum_used && next && next->type == CPU)
+	{
+		next->duration += e->duration;
+		List_popFront(&pcb->events);
+		MemStats_free(MEM_EVENT, e, sizeof(ProcessEvent));
+	}
+	pcb->quantum_used = 0;
+	os->wakeup_preemptions++;
+	OS_LOG(os, ANSI_ORANGE "\t[!] PID: %2d preempted on Core: %2d\n" ANSI_RESET, pcb->pid, core);
+
+	FakeOS_enqueueProcess(os, pcb);
+}
+
+/**
+ * @brief Wakeup preemption: the processes that entered the ready set in this step, best first,
+ *        take an idle core if there is one, else preempt the worst running process that ranks
+ *        worse and has run at least the granularity. The scheduler then fills the freed cores
+ *
+ * @param os
+ */
+static void FakeOS_wakeupPreempt(FakeOS *os)
+{
+	int n = os->num_woken;
+	double ranks[n];
+	int idle = idleCores(os->running, os->cores);
+
+	// insertion sort by rank, stable: the woken processes of a step are few
+	for (int i = 0; i < n; i++)
+	{
+		FakePCB *pcb = os->woken[i];
+		double rank = os->wakeup_rank(os->schedule_args, os, pcb);
+		int j = i;
+		for (; j > 0 && ranks[j - 1] > rank; j--)
+		{
+			ranks[j] = ranks[j - 1];
+			os->woken[j] = os->woken[j - 1];
+		}
+		ranks[j] = rank;
+		os->woken[j] = pcb;
+	}
+
+	for (int i = 0; i < n; i++)
+	{
+		int victim = -1;
+		double worst = ranks[i];
+
+		if (idle)
+		{
+			idle--;
+			continue;
+		}
+		for (unsigned int c = 0; c < os->cores; c++)
+		{
+			FakePCB *pcb = os->running[c];
+			double rank;
+			if (!pcb || pcb->duration < os->wakeup_granularity)
+				continue;
+			if ((rank = os->wakeup_rank(os->schedule_args, os, pcb)) > worst)
+			{
+				worst = rank;
+				victim = c;
+			}
+		}
+		// the next ones rank no better, they wouldn't find a victim either
+		if (victim < 0)
+			break;
+		FakeOS_preempt(os, victim);
+	}
+	os->num_woken = 0;
+}
+
+/**
+ * @brief Schedule processes on k idle cores: the scheduler picks them from its ready set,
+ *        in a single pass if it has pick_batch, then the dispatcher puts each in running
+ *        and the scheduler can preempt its burst
+ *
+ * @param os
+ * @param k
+ * @param pick
+ * @param pick_batch may be NULL, pick is repeated
+ * @param on_preempt may be NULL
+ * @return int number of processes dispatched
+ */
+static inline __attribute__((always_inline))
+int FakeOS_scheduleWith(FakeOS *os, int k, SchedPickFn pick, SchedPickBatchFn pick_batch, SchedPreemptFn on_preempt)
+{
+	FakePCB *picked[k];
+	int n = 0;
+
+	if (pick_batch)
+		n = pick_batch(os->schedule_args, os, picked, k);
+	else
+		while (n < k && (picked[n] = pick(os->schedule_args, os)))
+			n++;
+
+	for (int i = 0; i < n; i++)
+	{
+		dispatcher(os, picked[i]);
+		if (on_preempt)
+			on_preempt(os->schedule_args, os, picked[i]);
+	}
+	return n;
+}
+
+/**
+ * @brief Schedule a process on an idle core
+ *
+ * @param os
+ */
+void FakeOS_schedule(FakeOS *os)
 {
-	printf("\n************** TIME: %08d **************\n", os->timer);
+	FakeOS_scheduleWith(os, 1, os->ops->pick, NULL, os->ops->on_preempt);
+}
+
+/**
+ * @brief Schedule processes on k idle cores at once
+ *
+ * @param os
+ * @param k at most the number of idle cores
+ * @return int number of processes dispatched
+ */
+int FakeOS_scheduleBatch(FakeOS *os, int k)
+{
+	return FakeOS_scheduleWith(os, k, os->ops->pick, os->ops->pick_batch, os->ops->on_preempt);
+}
+
+/**
+ * @brief Simulate a step of the fake OS process scheduler. It is instantiated once per
+ *        scheduler with constant hooks (see FAKEOS_STEP), so they are inlined in the loop
+ *
+ * @param os
+ * @param enqueue
+ * @param pick
+ * @param pick_batch
+ * @param on_preempt
+ */
+static inline __attribute__((always_inline))
+void FakeOS_step(FakeOS *os, SchedEnqueueFn enqueue, SchedPickFn pick, SchedPickBatchFn pick_batch, SchedPreemptFn on_preempt)
+{
+	OS_LOG(os, "\n************** TIME: %08lld **************\n", (long long)os->timer);
+
+	PROFILE_BEGIN(PROF_ARRIVALS);
+	if (os->stream)
+		FakeOS_streamProcesses(os);
 
 	ListItem *aux = os->processes.first;
 	while (aux)
@@ -435,41 +849,48 @@ void FakeOS_simStep(FakeOS *os)
 		aux = aux->next;
 		if (new_process)
 		{
-			printf(ANSI_CYAN "\t[+] new process coming - pid : %2d\n" ANSI_RESET, new_process->pid);
+			OS_LOG(os, ANSI_CYAN "\t[+] new process coming - pid : %2d\n" ANSI_RESET, new_process->pid);
 			new_process = (FakeProcess *)List_detach(&os->processes, (ListItem *)new_process);
 			FakeOS_createPcb(os, new_process);
-			free(new_process);
+			MemStats_free(MEM_PROCESS, new_process, sizeof(FakeProcess));
 			new_process = 0;
 		}
 	}
+	PROFILE_END(PROF_ARRIVALS);
 
 	/********************************* WAITING QUEUE *********************************/
 	
+	PROFILE_BEGIN(PROF_WAITING);
 	aux = os->waiting.first;
-	printf(ANSI_MAGENTA "\nWAITING QUEUE:\n" ANSI_RESET);
+	OS_LOG(os, ANSI_MAGENTA "\nWAITING QUEUE:\n" ANSI_RESET);
 	while (aux)
 	{
 		FakePCB *pcb = (FakePCB *)aux;
 		aux = aux->next;
 		ProcessEvent *e = (ProcessEvent *)pcb->events.first;
 		assert(e->type == IO);
-		printf(ANSI_MAGENTA "\tPID: %2d - remaining time : %2d\n" ANSI_RESET, pcb->pid, --(e->duration));
+		--(e->duration);
+		OS_LOG(os, ANSI_MAGENTA "\tPID: %2d - remaining time : %2lld\n" ANSI_RESET, pcb->pid, (long long)e->duration);
 		if (e->duration == 0)
 		{
 			List_popFront(&pcb->events);
-			free(e);
+			MemStats_free(MEM_EVENT, e, sizeof(ProcessEvent));
 			List_detach(&os->waiting, (ListItem *)pcb);
 
-			FakeOS_enqueueProcess(os, pcb);
+			// before the enqueue, that ends the process if it has no more events
+			if (os->wakeup_rank)
+				FakeOS_wakeup(os, pcb);
+			FakeOS_enqueueWith(os, pcb, enqueue);
 		}
 	}
+	PROFILE_END(PROF_WAITING);
 
 	/********************************* RUNNING QUEUE *********************************/
 	
+	PROFILE_BEGIN(PROF_RUNNING);
 	FakePCB **running;
 	int i = -1;
-	int cpu_using = 0;
-	printf(ANSI_GREEN "\nRUNNING QUEUE:\n" ANSI_RESET);
+	OS_LOG(os, ANSI_GREEN "\nRUNNING QUEUE:\n" ANSI_RESET);
 	while (++i < os->cores)
 	{
 		running = &os->running[i];
@@ -477,104 +898,206 @@ void FakeOS_simStep(FakeOS *os)
 		// if no process is running, skip this core
 		if (!(*running) || !(*running)->pid)
 		{
-			printf("\tPID: -1 on Core: %d\n", i);
+			OS_LOG(os, "\tPID: -1 on Core: %d\n", i);
 			continue;
 		}
 		if ((*running)->pid)
 		{
-			cpu_using = 1;
+			os->core_busy_time[i]++;
+			os->cpu_busy_time++;
+			FakeOS_cold(os, *running)->cpu_time++;
+			Accounting_running(&os->acct, *running);
 			ProcessEvent *e = (ProcessEvent *)(*running)->events.first;
 			assert(e->type == CPU);
-			printf(ANSI_GREEN "\tPID: %2d on Core: %2d - remaining time : %2d\n" ANSI_RESET, (*running)->pid, i, --(e->duration));
+			e->duration -= os->capacity ? CoreCapacity_retire(os->capacity, i, e->duration) : 1;
+			OS_LOG(os, ANSI_GREEN "\tPID: %2d on Core: %2d - remaining time : %2lld\n" ANSI_RESET, (*running)->pid, i, (long long)e->duration);
 			if (e->duration == 0)
 			{
 				List_popFront(&(*running)->events);
-				free(e);
-				FakeOS_enqueueProcess(os, *running);
+				MemStats_free(MEM_EVENT, e, sizeof(ProcessEvent));
+				// the burst is over when the process blocks or ends, not at the end of a slice
+				if ((os->tuner || os->capacity) &&
+					(!(*running)->events.first || ((ProcessEvent *)(*running)->events.first)->type != CPU))
+				{
+					ProcessStats *ps = FakeOS_cold(os, *running);
+					if (os->tuner)
+						QuantumTuner_observeBurst(os->tuner, ps->cpu_time - ps->burst_start);
+					if (os->capacity)
+						os->capacity->bursts[i]++;
+					ps->burst_start = ps->cpu_time;
+				}
+				FakeOS_enqueueWith(os, *running, enqueue);
 				
 				// set running to 0 to signal that the core is free
 				*running = 0;
 			}
 		}
 	}
-
-	// if at least one core is using the cpu, increment the cpu utilization
-	if (cpu_using)
-		os->cpu_busy_time++;
+	PROFILE_END(PROF_RUNNING);
 
 	/********************************* READY QUEUE *********************************/
 
-	FakeOS_printReadyQueue(os);
+	PROFILE_BEGIN(PROF_READY_PRINT);
+	if (os->verbose)
+		FakeOS_printReadyQueue(os);
+	PROFILE_END(PROF_READY_PRINT);
 
 	/********************************* SCHEDULING *********************************/
 
-	i = -1;
-	while (++i < os->cores)
+	PROFILE_BEGIN(PROF_SCHEDULING);
+	if (os->ops->on_tick)
+		os->ops->on_tick(os->schedule_args, os);
+	if (os->tuner && os->timer >= os->tuner->next_update)
+		QuantumTuner_update(os->tuner, os);
+	// identical cores, as the ones implied by the energy model or the topology, have nothing to migrate
+	if (os->capacity && os->capacity->num_classes > 1)
+		CoreCapacity_migrate(os->capacity, os);
+	if (os->num_woken)
+		FakeOS_wakeupPreempt(os);
+	// the idle cores are filled together, the scheduler picks for all of them at once
+	int idle = idleCores(os->running, os->cores);
+	if (idle)
 	{
-		if (!cpuFull(os->running, os->cores))
-		{
-			(*os->schedule_fn)(os, os->schedule_args);
-		}
+		PROFILE_BEGIN(PROF_SCHEDULE);
+		FakeOS_scheduleWith(os, idle, pick, pick_batch, on_preempt);
+		PROFILE_END(PROF_SCHEDULE);
 	}
+	PROFILE_END(PROF_SCHEDULING);
 
 	// increase the duration of the running processes
+	PROFILE_BEGIN(PROF_TICK);
+	if (os->topology)
+		Topology_tick(os->topology, os);
+	if (os->energy)
+		Energy_tick(os->energy, os);
 	increaseDuration(os);
 	++os->timer;
+
+	if (os->sampler)
+		Sampler_step(os->sampler, os);
+	PROFILE_END(PROF_TICK);
 }
 
+// step of a scheduler, with its hooks resolved at compile time
+#define FAKEOS_STEP(name, enqueue, pick, pick_batch, on_preempt) \
+	static void FakeOS_step##name(FakeOS *os) { FakeOS_step(os, enqueue, pick, pick_batch, on_preempt); }
+
+FAKEOS_STEP(FCFS, sched_enqueue, FCFS_pick, NULL, FCFS_onPreempt)
+FAKEOS_STEP(SJF, sched_enqueue, SJF_pick, SJF_pickBatch, SJF_onPreempt)
+FAKEOS_STEP(Prior, sched_enqueue, Prior_pick, Prior_pickBatch, Prior_onPreempt)
+FAKEOS_STEP(RR, sched_enqueue, RR_pick, NULL, RR_onPreempt)
+FAKEOS_STEP(MLQ, MLQ_enqueue, MLQ_pick, NULL, MLQ_onPreempt)
+FAKEOS_STEP(MLFQ, MLFQ_enqueue, MLFQ_pick, MLFQ_pickBatch, MLFQ_onPreempt)
+
 /**
- * @brief Calculate the statistics of the fake OS
+ * @brief Simulate a step of the fake OS process scheduler, with the step of its scheduler
  *
  * @param os
  */
-void FakeOS_calculateStatistics(FakeOS *os) {
-    int total_turnaround_time = 0;
-    int total_waiting_time = 0;
-    int total_response_time = 0;
-    int total_processes = 0;
+void FakeOS_simStep(FakeOS *os)
+{
+	os->step(os);
+}
 
-    ListItem *item = os->terminated_stats.first;
+/**
+ * @brief Check if the simulation is over: no process is running, ready, waiting or still to arrive
+ *
+ * @param os
+ * @return int 1 if the simulation is over, 0 otherwise
+ */
+int FakeOS_finished(FakeOS *os)
+{
+	int levels[MAX_READY_LEVELS];
+	int num_levels = FakeOS_readyLevels(os, levels);
 
-    // Itera su tutti i processi completati per raccogliere i dati
-    while (item)
-	{
-        ProcessStats *stats = (ProcessStats *)item;
-        
-        // Incrementa i contatori con i dati del processo
-        total_turnaround_time += stats->complete_time - stats->arrival_time;
-        total_waiting_time += stats->waiting_time;
-        total_response_time += stats->response_time;
-        total_processes++;
-        
-        item = item->next;
-    }
+	for (int i = 0; i < os->cores; i++)
+		if (os->running[i])
+			return 0;
+	for (int i = 0; i < num_levels; i++)
+		if (levels[i])
+			return 0;
+
+	return !os->waiting.first &&
+		   !os->processes.first &&
+		   !(os->stream && TraceStream_peekArrival(os->stream) >= 0);
+}
 
-    if (total_processes == 0)
+/**
+ * @brief Print a row of the percentile table
+ *
+ * @param name
+ * @param h
+ */
+static void printPercentiles(const char *name, const LatencyHist *h)
+{
+	printf(ANSI_CYAN "  %-12s %9lu %9lu %9lu %9lu %9lu %9lu %9lu\n" ANSI_RESET, name,
+		(unsigned long)h->min,
+		(unsigned long)LatencyHist_percentile(h, 50),
+		(unsigned long)LatencyHist_percentile(h, 90),
+		(unsigned long)LatencyHist_percentile(h, 95),
+		(unsigned long)LatencyHist_percentile(h, 99),
+		(unsigned long)LatencyHist_percentile(h, 99.9),
+		(unsigned long)h->max);
+}
+
+/**
+ * @brief Calculate the statistics of the fake OS
+ *
+ * @param os
+ */
+void FakeOS_calculateStatistics(FakeOS *os) {
+    SimStats *stats = &os->stats;
+    const char *unit = Timebase_unit(os->ticks_per_ms);
+
+    if (stats->completed == 0)
 	{
         printf("Nessun processo completato.\n");
         return;
     }
 
-    // Calcola le statistiche medie
-    float avg_turnaround_time = (float)total_turnaround_time / total_processes;
-    float avg_waiting_time = (float)total_waiting_time / total_processes;
-    float avg_response_time = (float)total_response_time / total_processes;
-    float cpu_utilization = (float)os->cpu_busy_time / os->timer * 100.0;
-    float throughput = (float)total_processes / (float)os->timer;
+    // Calcola le statistiche medie (double: in us o ns un float non basta per tre decimali)
+    double avg_turnaround_time = LatencyHist_mean(&stats->turnaround);
+    double avg_waiting_time = LatencyHist_mean(&stats->waiting);
+    double avg_response_time = LatencyHist_mean(&stats->response);
+    float cpu_utilization = (float)os->cpu_busy_time / ((float)os->timer * os->cores) * 100.0;
+    // completions per ms, whatever the timebase
+    float throughput = (float)stats->completed / (float)os->timer * os->ticks_per_ms;
 
     // Stampa le statistiche
     printf(ANSI_CYAN "\n\n------------------------------------STATISTICS------------------------------------\n" ANSI_RESET);
-    printf(ANSI_CYAN "Total Time: \t\t\t[%d ms]\n" ANSI_RESET, os->timer);
-	printf(ANSI_CYAN "Turnaround time avrg: \t\t[%.3f ms]\n" ANSI_RESET, avg_turnaround_time);
-    printf(ANSI_CYAN "Waiting time avrg: \t\t[%.3f ms]\n" ANSI_RESET, avg_waiting_time);
-    printf(ANSI_CYAN "Response time avrg: \t\t[%.3f ms] \n" ANSI_RESET, avg_response_time);
+    printf(ANSI_CYAN "Total Time: \t\t\t[%lld %s]\n" ANSI_RESET, (long long)os->timer, unit);
+	printf(ANSI_CYAN "Turnaround time avrg: \t\t[%.3f %s]\n" ANSI_RESET, avg_turnaround_time, unit);
+    printf(ANSI_CYAN "Waiting time avrg: \t\t[%.3f %s]\n" ANSI_RESET, avg_waiting_time, unit);
+    printf(ANSI_CYAN "Response time avrg: \t\t[%.3f %s] \n" ANSI_RESET, avg_response_time, unit);
     printf(ANSI_CYAN "Throughput: \t\t\t[%f]\n" ANSI_RESET, throughput);
     printf(ANSI_CYAN "CPU Used: \t\t\t[%.2f%%]\n" ANSI_RESET, cpu_utilization);
-     
+    printf(ANSI_CYAN "Core Used:\t\t\t" ANSI_RESET);
+    for (unsigned int i = 0; i < os->cores; i++)
+        printf(ANSI_CYAN "[%u: %.2f%%] " ANSI_RESET, i, (float)os->core_busy_time[i] / os->timer * 100.0);
+    printf("\n");
+
+    // Percentili (nell'unita' del timebase), errore relativo < 1/LHIST_SUB_BUCKETS
+    printf(ANSI_CYAN "\nPercentiles [%s]:    %9s %9s %9s %9s %9s %9s %9s\n" ANSI_RESET, unit, "min", "p50", "p90", "p95", "p99", "p99.9", "max");
+    printPercentiles("turnaround", &stats->turnaround);
+    printPercentiles("waiting", &stats->waiting);
+    printPercentiles("response", &stats->response);
+
     // Fairness
-    // for (int i = 0; i < MAX_PRIORITY; ++i) {
-    //     printf("Tempo CPU per priorità %d: %d\n", i, os->priority_cpu_time[i]);
-    // }
+    Accounting_print(&os->acct, unit);
+
+    if (os->tuner)
+        QuantumTuner_print(os->tuner, unit);
+    if (os->wakeup_granularity >= 0)
+        printf(ANSI_CYAN "Wakeup preemptions: \t\t[%u] min granularity %lld %s\n" ANSI_RESET, os->wakeup_preemptions,
+               (long long)os->wakeup_granularity, unit);
+    if (os->capacity && os->capacity->num_classes > 1)
+        CoreCapacity_print(os->capacity, os);
+    if (os->topology)
+        Topology_print(os->topology, os);
+    if (os->energy)
+        Energy_print(os->energy, os);
+    if (os->mem_report)
+        MemStats_print(os->timer, os->ticks_per_ms);
 }
 
 /**
@@ -585,98 +1108,29 @@ void FakeOS_calculateStatistics(FakeOS *os) {
 void FakeOS_destroy(FakeOS *os)
 {
 	free(os->running);
-	if (os->schedule_args)
-	{
-		switch (os->scheduler)
-		{
-			case MLFQ:
-				MLFQ_destroyArgs(os->schedule_args);
-				break;
-			case MLQ:
-				MLQ_destroyArgs(os->schedule_args);
-				break;
-			default:
-				free(os->schedule_args);
-				break;
-		}
-	}
+	free(os->core_busy_time);
+	FakeOS_destroySchedulerArgs(os);
+
+	LatencyHist_destroy(&os->stats.turnaround);
+	LatencyHist_destroy(&os->stats.waiting);
+	LatencyHist_destroy(&os->stats.response);
+	Accounting_destroy(&os->acct);
+	PCBTable_destroy(&os->pcbs);
+	if (os->stream)
+		TraceStream_close(os->stream);
+	free(os->tuner);
+	CoreCapacity_destroy(os->capacity);
+	Energy_destroy(os->energy);
+	free(os->topology);
+	free(os->woken);
 
-	ListItem *aux = os->terminated_stats.first;
-	while (aux)
-	{
-		ProcessStats *stats = (ProcessStats *)aux;
-		aux = aux->next;
-		free(stats);
-	}
 	os->running = 0;
 	os->schedule_args = 0;
-}
-
-
-
-
-int main(int argc, char **argv)
-{
-	FakeOS os;
-
-	if (argc != 5)
-	{
-		printf(usage_buffer, argv[0], argv[0]);
-		return 1;
-	}
-
-	srand(time(NULL));
-
-	int num_cores = atoi(argv[1]);
-	int scheduler = atoi(argv[2]) - 1;
-	int quantum = atoi(argv[3]);
-	const char *traces_folder = argv[4];
-
-	if (num_cores < 1 || scheduler < 0 || scheduler >= MAX_SCHEDULERS)
-	{
-		printf(usage_buffer, argv[0], argv[0]);
-		return 1;
-	}
-
-	FakeOS_init(&os, num_cores);
-	FakeOS_setScheduler(&os, scheduler, quantum);
-
-	// read from traces folder the process and create them
-	DIR *dir;
-	struct dirent *ent;
-	if ((dir = opendir(traces_folder)) == NULL)
-	{
-		perror("Could not open directory");
-		return 1;
-	}
-
-	while ((ent = readdir(dir)) != NULL)
-	{
-		if (ent->d_type == DT_REG)
-		{
-			char filename[256];
-			sprintf(filename, "%s/%s", traces_folder, ent->d_name);
-			printf("Reading from file: %s\n", filename);
-			FakeOS_createProcess(&os, filename);	
-		}
-	}
-	closedir(dir);
-
-	// run the simulation until all processes are terminated and all queues are empty
-	// memcmp returns 0 if the two arrays are equal (in this case, all the pointers are NULL)
-	FakePCB **temp = malloc(sizeof(FakePCB *) * os.cores);
-	memset(temp, 0, sizeof(FakePCB *) * os.cores);
-	while (memcmp(os.running, temp, sizeof(FakePCB *) * os.cores) ||
-		   os.ready.first ||
-		   os.waiting.first ||
-		   os.processes.first)
-	{
-		FakeOS_simStep(&os);
-	}
-	free(temp);
-	temp = 0;
-	FakeOS_calculateStatistics(&os);
-	FakeOS_destroy(&os);
-	
-	return 0;
+	os->stream = 0;
+	os->tuner = 0;
+	os->capacity = 0;
+	os->energy = 0;
+	os->topology = 0;
+	os->woken = 0;
+	os->num_woken = os->max_woken = 0;
 }
@@ -11,10 +11,10 @@ void printProcessEvent(ListItem *item)
 	switch (e->type)
 	{
 	case CPU:
-		printf("CPU: %d\n", e->duration);
+		printf("CPU: %lld\n", (long long)e->duration);
 		break;
 	case IO:
-		printf("IO: %d\n", e->duration);
+		printf("IO: %lld\n", (long long)e->duration);
 		break;
 	default:
 		assert(0 && "illegal resource");
@@ -24,182 +24,241 @@ void printProcessEvent(ListItem *item)
 /**
  * @brief Arguments for the SJF scheduler.
  * 
+ * @param hot The keys of the process to set the arguments in.
  * @param pcb The process control block to set the arguments for.
  */
-void FakeProcess_SJFArgs(FakePCB *pcb)
+void FakeProcess_SJFArgs(PCBHot *hot, FakePCB *pcb)
 {
-	ProcSJFArgs *args = (ProcSJFArgs *)malloc(sizeof(ProcSJFArgs));
-	if (!args)
-		assert(0 && "malloc failed setting process args");
-	args->previousPrediction = 0;
-
-	pcb->args = args;
+	hot->prediction = 0;
 }
 
 /**
  * @brief Arguments for the priority scheduler.
  * 
+ * @param hot The keys of the process to set the arguments in.
  * @param pcb The process control block to set the arguments for.
  */
-void FakeProcess_PriorArgs(FakePCB *pcb)
+void FakeProcess_PriorArgs(PCBHot *hot, FakePCB *pcb)
 {
-	ProcPriorArgs *args = (ProcPriorArgs *)malloc(sizeof(ProcPriorArgs));
-	if (!args)
-		assert(0 && "malloc failed setting process args");
-	args->last_aging = 0;
-	args->curr_priority = pcb->priority;
-
-	pcb->args = args;
+	hot->last_aging = 0;
+	hot->level = pcb->priority;
 }
 
 /**
  * @brief Arguments for the MLQ scheduler.
  * 
+ * @param hot The keys of the process to set the arguments in.
  * @param pcb The process control block to set the arguments for.
  */
-void FakeProcess_MLQArgs(FakePCB *pcb)
+void FakeProcess_MLQArgs(PCBHot *hot, FakePCB *pcb)
 {
-	ProcMLQArgs *args = (ProcMLQArgs *)malloc(sizeof(ProcMLQArgs));
-	if (!args)
-		assert(0 && "malloc failed setting process args");
-	args->queue = pcb->priority;
-
-	pcb->args = args;
+	hot->level = pcb->priority;
 }
 
 /**
  * @brief Arguments for the MLFQ scheduler.
  * 
+ * @param hot The keys of the process to set the arguments in.
  * @param pcb The process control block to set the arguments for.
  */
-void FakeProcess_MLFQArgs(FakePCB *pcb)
+void FakeProcess_MLFQArgs(PCBHot *hot, FakePCB *pcb)
 {
-	ProcMLFQArgs *args = (ProcMLFQArgs *)malloc(sizeof(ProcMLFQArgs));
-	if (!args)
-		assert(0 && "malloc failed setting process args");
-	args->queue = 0;
-	args->last_aging = 0;
-
-	pcb->args = args;
+	hot->level = 0;
+	hot->last_aging = 0;
 }
 
 /**
  * @brief populate the arguments of the process 
  * 
+ * @param hot keys of the process, the burst and the enqueue time are the OS's and are kept
  * @param pcb 
- * @param scheduler 
+ * @param ops operations of the scheduler, the arguments stay 0 if it has no per process state
  */
-void FakeProcess_setArgs(FakePCB *pcb, SchedulerType scheduler)
+void FakeProcess_setArgs(PCBHot *hot, FakePCB *pcb, const struct SchedOps *ops)
 {
-	switch (scheduler)
-	{
-	case SJF_PREDICT:
-	case SJF_PREDICT_PREEMPTIVE:
-		FakeProcess_SJFArgs(pcb);
-		break;
-	case PRIORITY:
-	case PRIORITY_PREEMPTIVE:
-		FakeProcess_PriorArgs(pcb);
-		break;
-	case MLQ:
-		FakeProcess_MLQArgs(pcb);
-		break;
-	case MLFQ:
-		FakeProcess_MLFQArgs(pcb);
-		break;
-	default:
-		pcb->args = NULL;
-		return ;
-	}
+	hot->level = 0;
+	hot->prediction = 0;
+	hot->last_aging = 0;
+	if (ops->proc_init)
+		ops->proc_init(hot, pcb);
 }
 
 /**
  * @brief Initialize the statistics of the process
  * 
- * @return ProcessStats* 
+ * @param stats 
  */
-ProcessStats *FakeProcess_initiStats()
+void FakeProcess_initiStats(ProcessStats *stats)
 {
-	ProcessStats *stats = (ProcessStats *)malloc(sizeof(ProcessStats));
-	if (!stats)
-		assert(0 && "malloc failed setting process stats");
-	
-	stats->list.next = stats->list.prev = 0;
 	stats->arrival_time = 0;
 	stats->waiting_time = 0;
-	stats->last_ready_enqueue = 0;
 	stats->turnaround_time = 0;
 	stats->response_time = 0;
 	stats->complete_time = 0;
-
-	return stats;
+	stats->cpu_time = 0;
+	stats->burst_start = 0;
 }
 
 /**
  * @brief Update the arrival time of the process, the time the process arrived in the system
  * 
- * @param pcb 
+ * @param stats 
  * @param timer 
  */
-void FakeProcess_arrivalTime(FakePCB *pcb, unsigned int timer)
+void FakeProcess_arrivalTime(ProcessStats *stats, SimTime timer)
 {
-	pcb->stats->arrival_time = timer;
+	stats->arrival_time = timer;
 }
 
 /**
  * @brief Update the last enqueued time of the process, the last time the process was in the ready queue
  * 
- * @param pcb 
+ * @param hot 
  * @param timer 
  */
-void FakeProcess_lastEnqueuedTime(FakePCB *pcb, unsigned int timer)
+void FakeProcess_lastEnqueuedTime(PCBHot *hot, SimTime timer)
 {
-	pcb->stats->last_ready_enqueue = timer;
+	hot->ready_since = timer;
 }
 
 /**
  * @brief Update the waiting time of the process, how long the process has been waiting in the ready queue
  * 
- * @param pcb 
+ * @param stats 
+ * @param hot 
  * @param timer 
  */
-void FakeProcess_waitingTime(FakePCB *pcb, unsigned int timer)
+void FakeProcess_waitingTime(ProcessStats *stats, const PCBHot *hot, SimTime timer)
 {
-	if (pcb->stats->last_ready_enqueue)
-		pcb->stats->waiting_time += timer - pcb->stats->last_ready_enqueue;
+	if (hot->ready_since)
+		stats->waiting_time += timer - hot->ready_since;
 }
 
 /**
  * @brief Update the complete time of the process, the time the process completed execution
  * 
- * @param pcb 
+ * @param stats 
  * @param timer 
  */
-void FakeProcess_completeTime(FakePCB *pcb, unsigned int timer)
+void FakeProcess_completeTime(ProcessStats *stats, SimTime timer)
 {
-	pcb->stats->complete_time = timer;
+	stats->complete_time = timer;
 }
 
 /**
  * @brief Update the turnaround time of the process, the time the process effectively spent in the system
  * 
- * @param pcb 
+ * @param stats 
  * @param timer 
  */
-void FakeProcess_turnaroundTime(FakePCB *pcb, unsigned int timer)
+void FakeProcess_turnaroundTime(ProcessStats *stats, SimTime timer)
 {
-	pcb->stats->turnaround_time = pcb->stats->complete_time - pcb->stats->arrival_time;
+	stats->turnaround_time = stats->complete_time - stats->arrival_time;
 }
 
 /**
  * @brief Update the response time of the process, the time the process took to start executing
  * 
- * @param pcb 
+ * @param stats 
  * @param timer 
  */
-void FakeProcess_responseTime(FakePCB *pcb, unsigned int timer)
+void FakeProcess_responseTime(ProcessStats *stats, SimTime timer)
+{
+	if (!stats->response_time)
+		stats->response_time = timer - stats->arrival_time;
+}
+
+/**
+ * @brief Initialize an empty table of PCB slots
+ * 
+ * @param table 
+ */
+void PCBTable_init(PCBTable *table)
+{
+	table->hot = 0;
+	table->cold = 0;
+	table->free_ids = 0;
+	table->num_free = 0;
+	table->size = 0;
+	table->capacity = 0;
+}
+
+/**
+ * @brief Take a slot for a new PCB, the last released one if any. The arrays double when full,
+ *        the slots are reached by id so they can move
+ * 
+ * @param table 
+ * @return int the id of the slot, its keys and statistics are to be initialized
+ */
+int PCBTable_alloc(PCBTable *table)
+{
+	if (table->num_free)
+		return table->free_ids[--table->num_free];
+
+	if (table->size == table->capacity)
+	{
+		int old = table->capacity;
+
+		table->capacity = table->capacity ? table->capacity * 2 : 64;
+		table->hot = (PCBHot *)MemStats_realloc(MEM_PCB_KEYS, table->hot, old * sizeof(PCBHot), table->capacity * sizeof(PCBHot));
+		table->cold = (ProcessStats *)MemStats_realloc(MEM_PROCESS_STATS, table->cold, old * sizeof(ProcessStats),
+													  table->capacity * sizeof(ProcessStats));
+		table->free_ids = (int *)realloc(table->free_ids, table->capacity * sizeof(int));
+		if (!table->hot || !table->cold || !table->free_ids)
+			assert(0 && "realloc failed growing the pcb table");
+	}
+	return table->size++;
+}
+
+/**
+ * @brief Give back the slot of a destroyed PCB
+ * 
+ * @param table 
+ * @param id 
+ */
+void PCBTable_release(PCBTable *table, int id)
 {
-	if (!pcb->stats->response_time)
-		pcb->stats->response_time = timer - pcb->stats->arrival_time;
+	assert(id >= 0 && id < table->size && "id not allocated");
+	table->free_ids[table->num_free++] = id;
 }
 
+/**
+ * @brief Give a restored table the capacity and the ids it had when it was saved: the ids not
+ *        taken by the restored PCBs are released, so the table grows when the saved one would
+ * 
+ * @param table with the restored PCBs only
+ * @param capacity saved
+ * @param size saved
+ */
+void PCBTable_restore(PCBTable *table, int capacity, int size)
+{
+	assert(table->num_free == 0 && table->size <= size && size <= capacity && table->capacity <= capacity &&
+		   "pcb table larger than the saved one");
+	if (table->capacity < capacity)
+	{
+		int old = table->capacity;
+
+		table->capacity = capacity;
+		table->hot = (PCBHot *)MemStats_realloc(MEM_PCB_KEYS, table->hot, old * sizeof(PCBHot), capacity * sizeof(PCBHot));
+		table->cold = (ProcessStats *)MemStats_realloc(MEM_PROCESS_STATS, table->cold, old * sizeof(ProcessStats),
+													  capacity * sizeof(ProcessStats));
+		table->free_ids = (int *)realloc(table->free_ids, capacity * sizeof(int));
+		if (!table->hot || !table->cold || !table->free_ids)
+			assert(0 && "realloc failed growing the pcb table");
+	}
+	while (table->size < size)
+		table->free_ids[table->num_free++] = table->size++;
+}
+
+/**
+ * @brief Free the arrays of the table
+ * 
+ * @param table 
+ */
+void PCBTable_destroy(PCBTable *table)
+{
+	MemStats_free(MEM_PCB_KEYS, table->hot, table->capacity * sizeof(PCBHot));
+	MemStats_free(MEM_PROCESS_STATS, table->cold, table->capacity * sizeof(ProcessStats));
+	free(table->free_ids);
+	PCBTable_init(table);
+}
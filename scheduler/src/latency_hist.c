@@ -0,0 +1,161 @@
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "../include/latency_hist.h"
+
+/**
+ * @brief Index of the bucket holding a value
+ *
+ * @param value
+ * @return int
+ */
+static inline int bucketIndex(uint64_t value)
+{
+	if (value < 2 * LHIST_SUB_BUCKETS)
+		return (int)value;
+
+	int msb = 63 - __builtin_clzll(value);
+	int shift = msb - LHIST_SUB_BITS;
+
+	return (shift + 1) * LHIST_SUB_BUCKETS + (int)((value >> shift) - LHIST_SUB_BUCKETS);
+}
+
+/**
+ * @brief Smallest value falling in a bucket
+ *
+ * @param index
+ * @return uint64_t
+ */
+static inline uint64_t bucketLow(int index)
+{
+	if (index < 2 * LHIST_SUB_BUCKETS)
+		return index;
+
+	int shift = index / LHIST_SUB_BUCKETS - 1;
+	return (uint64_t)(index % LHIST_SUB_BUCKETS + LHIST_SUB_BUCKETS) << shift;
+}
+
+/**
+ * @brief Initialize an empty histogram
+ *
+ * @param h
+ */
+void LatencyHist_init(LatencyHist *h)
+{
+	if (!(h->buckets = (uint64_t *)calloc(LHIST_BUCKETS, sizeof(uint64_t))))
+		assert(0 && "malloc failed creating latency histogram");
+	h->count = 0;
+	h->sum = 0;
+	h->min = UINT64_MAX;
+	h->max = 0;
+}
+
+/**
+ * @brief Empty the histogram, keeping its memory
+ *
+ * @param h
+ */
+void LatencyHist_reset(LatencyHist *h)
+{
+	memset(h->buckets, 0, LHIST_BUCKETS * sizeof(uint64_t));
+	h->count = 0;
+	h->sum = 0;
+	h->min = UINT64_MAX;
+	h->max = 0;
+}
+
+/**
+ * @brief Free the memory of the histogram
+ *
+ * @param h
+ */
+void LatencyHist_destroy(LatencyHist *h)
+{
+	free(h->buckets);
+	h->buckets = 0;
+}
+
+/**
+ * @brief Record a value in O(1)
+ *
+ * @param h
+ * @param value
+ */
+void LatencyHist_record(LatencyHist *h, uint64_t value)
+{
+	h->buckets[bucketIndex(value)]++;
+	h->count++;
+	h->sum += value;
+	if (value < h->min)
+		h->min = value;
+	if (value > h->max)
+		h->max = value;
+}
+
+/**
+ * @brief Add the values of src to dst
+ *
+ * @param dst
+ * @param src
+ */
+void LatencyHist_merge(LatencyHist *dst, const LatencyHist *src)
+{
+	for (int i = 0; i < LHIST_BUCKETS; i++)
+		dst->buckets[i] += src->buckets[i];
+	dst->count += src->count;
+	dst->sum += src->sum;
+	if (src->min < dst->min)
+		dst->min = src->min;
+	if (src->max > dst->max)
+		dst->max = src->max;
+}
+
+/**
+ * @brief Exact mean of the recorded values
+ *
+ * @param h
+ * @return double
+ */
+double LatencyHist_mean(const LatencyHist *h)
+{
+	return h->count ? (double)h->sum / h->count : 0.0;
+}
+
+/**
+ * @brief Value below which percentile% of the recorded values fall.
+ *        The result is the middle of the bucket, clamped to the recorded min and max
+ *
+ * @param h
+ * @param percentile in [0, 100]
+ * @return uint64_t
+ */
+uint64_t LatencyHist_percentile(const LatencyHist *h, double percentile)
+{
+	if (!h->count)
+		return 0;
+
+	// rank of the wanted value, at least the first one
+	uint64_t rank = (uint64_t)(percentile / 100.0 * h->count + 0.5);
+	if (rank < 1)
+		rank = 1;
+	if (rank > h->count)
+		rank = h->count;
+
+	uint64_t seen = 0;
+	for (int i = 0; i < LHIST_BUCKETS; i++)
+	{
+		seen += h->buckets[i];
+		if (seen >= rank)
+		{
+			uint64_t low = bucketLow(i);
+			uint64_t value = low + (bucketLow(i + 1) - low) / 2;
+			if (value < h->min)
+				value = h->min;
+			if (value > h->max)
+				value = h->max;
+			return value;
+		}
+	}
+	return h->max;
+}
@@ -0,0 +1,568 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <time.h>
+#include <getopt.h>
+#include <dirent.h>
+#include <signal.h>
+
+#include "../include/fake_os.h"
+#include "../include/checkpoint.h"
+#include "../include/branch.h"
+#include "../include/replica.h"
+#include "../include/telemetry.h"
+
+char usage_buffer[] = "Usage: %s [options] <num_cores> <scheduler> <quantum> <traces_folder> \n\
+       %s [options] --restore <checkpoint> \n\
+\n\
+<num_cores>: Number of cores to simulate the processes on. \n\
+<scheduler>: The scheduling algorithm to use: \n\
+	1: First Come First Served (FCFS) \n\
+	2: First Come First Served (FCFS) preemptive \n\
+	3: Shortest Job First (SJF) with prediction \n\
+	4: Shortest Job First (SJF) preemptive with prediction \n\
+	5: Shortest Job First (SJF) no prediction \n\
+	6: Shortest Remaining Time First (SRTF) (a sjf with preemptive)\n\
+	7: Priority \n\
+	8: Priority preemptive \n\
+	9: Round Robin (RR) \n\
+	10: Multi-Level Queue (MLQ) \n\
+	11: Multi-Level Feedback Queue (MLFQ) \n\
+<quantum>: The quantum to use for the scheduling algorithm, in ms or with a unit (see --timebase). \n\
+<traces_folder>: The path to the folder containing the traces. Not needed in pipeline mode. \n\
+\n\
+Options: \n\
+	--pipeline <histogram_folder>: generate the processes in memory from the histograms, no trace file is read \n\
+	--procs <num_process>: processes generated in pipeline mode (default 100) \n\
+	--bursts <num_burst_per_process>: bursts per generated process (default 10) \n\
+	--seed <seed>: seed of the generated processes (default current time) \n\
+	--window <num_process>: processes generated at a time, their arrivals are spread on %d ms (default all) \n\
+	--timeseries <file>: write per interval core busy time, ready and waiting queue lengths and completions (csv) \n\
+	--interval <ms>: length of a time series interval (default 100) \n\
+	--slo <class>:p<percentile>:<ms>: response time objective of a priority class, e.g. HIGH:p99:200 (repeatable) \n\
+	--format <json|csv>: write configuration, statistics, per process records and timings to --output \n\
+	--output <file>: file of the structured output (csv also writes <file>.processes.csv) \n\
+	--quiet: don't print the trace of every simulation step \n\
+	--checkpoint <file>: on SIGTERM or SIGINT save the state of the simulation in <file> and exit with status 2 \n\
+	--checkpoint-every <ms>: also save it every <ms> of simulated time \n\
+	--restore <file>: resume the simulation saved in <file>, with its outputs; the other options are ignored \n\
+	              except --quiet, --memory, --telemetry and the checkpoint ones \n\
+	--branch-at <ms>: simulate up to <ms>, then fork the simulation in the --variant schedulers and compare how they end \n\
+	--variant <scheduler>:<quantum>: a branch, scheduler by number or name, e.g. 9:20 or MLFQ:10 (repeatable) \n\
+	--replicas <n>: pipeline mode only, simulate n workloads with seeds seed..seed+n-1 under the scheduler and \n\
+	              every --variant, in memory, and print the metrics with their 95%% confidence intervals \n\
+	              and the paired differences of the variants with the scheduler \n\
+	--threads <n>: threads running the replicas (default one per cpu) \n\
+	--adaptive-quantum <percentile>[:<min>:<max>]: RR, MLQ and MLFQ only, every %d ms set the quantum to the \n\
+	              running estimate of this percentile of the CPU bursts, within the bounds (default \n\
+	              quantum/4 and quantum*8), e.g. 80 or 80:5:200 or 80:500us:20ms \n\
+	--response-target <ms>: with --adaptive-quantum, scale the quantum to keep the response time below <ms> \n\
+	--wakeup-preemption <ms>: preemptive SJF, SRTF and priority only, a process that arrives or ends its I/O \n\
+	              preempts the worst running process if it ranks better and that one has run at least <ms> \n\
+	--core-speeds <s0>,<s1>,...: burst units retired per ms by each core, <n>x<speed> for n cores, e.g. \n\
+	              2x2.0,2x1.0: long bursts go to the fast cores, short ones to the slow cores \n\
+	--energy <governor>: energy model of the cores with P-states and C-states, the governor sets the \n\
+	              frequency: performance, powersave, ondemand or schedutil \n\
+	--topology <sockets>x<nodes>x<cores>[x<smt>][:<penalty>[:<period>]]: NUMA layout of the cores, e.g. \n\
+	              2x1x8x2; a burst away from the home node of the process is up to <penalty> times slower \n\
+	              (default %.1f), the processes are placed on their node and balanced every <period> (default \n\
+	              %d ms, 0 never) \n\
+	--numa-flat: with --topology, place the processes on the first idle core whatever its node \n\
+	--timebase <ms|us|ns>: length of a step of the simulation (default ms). The times of the quantum and of \n\
+	              the options are in ms, or take a unit: ns, us, ms or s, e.g. 500us or 1.5ms \n\
+	--telemetry <name>: publish the live state of the simulation in the shared memory segment /dev/shm/<name> \n\
+	              every %d ms of wall time, read it with disastros_telemetry <name>. SIGUSR1 prints it on \n\
+	              stderr, with or without the segment \n\
+	--memory: print the allocations and the live bytes of the processes, events, PCBs and scheduler \n\
+	              arguments, the peak resident memory and the allocations per simulated second \n\
+\n\
+Example: %s 4 3 10 traces_folder \n\
+\n\
+This will simulate a 4 core system using the SJF with prediction scheduling algorithm and a quantum of 10 using the traces in the traces_folder. \
+\n";
+
+static double elapsed(struct timespec *start)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static void usage(char *prog)
+{
+	printf(usage_buffer, prog, prog, ARRIVAL_WINDOW, QT_PERIOD, TOPO_PENALTY, TOPO_BALANCE_PERIOD, TELEMETRY_PERIOD_MS, prog);
+}
+
+/**
+ * @brief Parse the time of an option in ticks, left as it is if the option is not given
+ *
+ * @param ticks_per_ms
+ * @param arg NULL if the option is not given
+ * @param ticks
+ * @return int 0, -1 if arg is not a time
+ */
+static int parseTime(SimTime ticks_per_ms, const char *arg, SimTime *ticks)
+{
+	return arg ? Timebase_parse(ticks_per_ms, arg, ticks) : 0;
+}
+
+static volatile sig_atomic_t stop_requested = 0;     // the signal received
+
+static void requestStop(int sig)
+{
+	(void)sig;
+	stop_requested = sig;
+}
+
+static volatile sig_atomic_t dump_requested = 0;
+
+static void requestDump(int sig)
+{
+	(void)sig;
+	dump_requested = 1;
+}
+
+int main(int argc, char **argv)
+{
+	FakeOS os;
+	int opt;
+	const char *histogram_folder = NULL;
+	int num_procs = 100;
+	int num_bursts = 10;
+	int window = 0;
+	uint64_t seed = (uint64_t)time(NULL);
+	const char *timeseries = NULL;
+	const char *timebase = "ms";
+	const char *interval_arg = "100";
+	SimTime interval;
+	const char *slos[MAX_SLOS];
+	int num_slos = 0;
+	const char *format = NULL;
+	const char *output = NULL;
+	int quiet = 0;
+	const char *checkpoint = NULL;
+	const char *checkpoint_every_arg = NULL;
+	SimTime checkpoint_every = 0;
+	const char *restore = NULL;
+	const char *branch_at_arg = NULL;
+	SimTime branch_at = -1;
+	const char *variant_args[MAX_BRANCHES];
+	BranchVariant variants[MAX_BRANCHES];
+	int num_variants = 0;
+	int replicas = 0;
+	int threads = 0;
+	const char *adaptive_quantum = NULL;
+	const char *response_target_arg = NULL;
+	SimTime response_target = 0;
+	const char *wakeup_arg = NULL;
+	SimTime wakeup_granularity = -1;
+	const char *core_speeds = NULL;
+	const char *energy = NULL;
+	const char *topology = NULL;
+	int numa_flat = 0;
+	const char *telemetry_name = NULL;
+	int mem_report = 0;
+	struct timespec phase_start;
+
+	static struct option long_options[] = {
+		{"pipeline", required_argument, 0, 'p'},
+		{"procs", required_argument, 0, 'n'},
+		{"bursts", required_argument, 0, 'b'},
+		{"seed", required_argument, 0, 's'},
+		{"window", required_argument, 0, 'w'},
+		{"timeseries", required_argument, 0, 'T'},
+		{"interval", required_argument, 0, 'i'},
+		{"slo", required_argument, 0, 'S'},
+		{"format", required_argument, 0, 'f'},
+		{"output", required_argument, 0, 'o'},
+		{"quiet", no_argument, 0, 'q'},
+		{"checkpoint", required_argument, 0, 'c'},
+		{"checkpoint-every", required_argument, 0, 'e'},
+		{"restore", required_argument, 0, 'r'},
+		{"branch-at", required_argument, 0, 'B'},
+		{"variant", required_argument, 0, 'V'},
+		{"replicas", required_argument, 0, 'R'},
+		{"threads", required_argument, 0, 't'},
+		{"adaptive-quantum", required_argument, 0, 'A'},
+		{"response-target", required_argument, 0, 'G'},
+		{"wakeup-preemption", required_argument, 0, 'W'},
+		{"core-speeds", required_argument, 0, 'C'},
+		{"energy", required_argument, 0, 'E'},
+		{"topology", required_argument, 0, 'N'},
+		{"numa-flat", no_argument, 0, 'F'},
+		{"timebase", required_argument, 0, 'U'},
+		{"telemetry", required_argument, 0, 'L'},
+		{"memory", no_argument, 0, 'M'},
+		{0, 0, 0, 0}
+	};
+
+	while ((opt = getopt_long(argc, argv, "p:n:b:s:w:T:i:S:f:o:qc:e:r:B:V:R:t:A:G:W:C:E:N:FU:L:M", long_options, NULL)) != -1)
+	{
+		switch (opt)
+		{
+		case 'p':
+			histogram_folder = optarg;
+			break;
+		case 'n':
+			num_procs = atoi(optarg);
+			break;
+		case 'b':
+			num_bursts = atoi(optarg);
+			break;
+		case 's':
+			seed = strtoull(optarg, NULL, 10);
+			break;
+		case 'w':
+			window = atoi(optarg);
+			break;
+		case 'T':
+			timeseries = optarg;
+			break;
+		case 'i':
+			interval_arg = optarg;
+			break;
+		case 'S':
+			if (num_slos == MAX_SLOS)
+			{
+				usage(argv[0]);
+				return 1;
+			}
+			slos[num_slos++] = optarg;
+			break;
+		case 'f':
+			format = optarg;
+			break;
+		case 'o':
+			output = optarg;
+			break;
+		case 'q':
+			quiet = 1;
+			break;
+		case 'c':
+			checkpoint = optarg;
+			break;
+		case 'e':
+			checkpoint_every_arg = optarg;
+			break;
+		case 'r':
+			restore = optarg;
+			break;
+		case 'B':
+			branch_at_arg = optarg;
+			break;
+		case 'V':
+			if (num_variants == MAX_BRANCHES)
+			{
+				printf("Invalid variant: %s\n", optarg);
+				usage(argv[0]);
+				return 1;
+			}
+			variant_args[num_variants++] = optarg;
+			break;
+		case 'R':
+			replicas = atoi(optarg);
+			break;
+		case 't':
+			threads = atoi(optarg);
+			break;
+		case 'A':
+			adaptive_quantum = optarg;
+			break;
+		case 'G':
+			response_target_arg = optarg;
+			break;
+		case 'W':
+			wakeup_arg = optarg;
+			break;
+		case 'C':
+			core_speeds = optarg;
+			break;
+		case 'E':
+			energy = optarg;
+			break;
+		case 'N':
+			topology = optarg;
+			break;
+		case 'F':
+			numa_flat = 1;
+			break;
+		case 'U':
+			timebase = optarg;
+			break;
+		case 'L':
+			telemetry_name = optarg;
+			break;
+		case 'M':
+			mem_report = 1;
+			break;
+		default:
+			usage(argv[0]);
+			return 1;
+		}
+	}
+
+	// the times are converted to ticks of the timebase once the options are all read
+	SimTime ticks_per_ms = Timebase_ticksPerMs(timebase);
+	if (ticks_per_ms < 0 || Timebase_parse(ticks_per_ms, interval_arg, &interval) < 0 ||
+		parseTime(ticks_per_ms, branch_at_arg, &branch_at) < 0 ||
+		parseTime(ticks_per_ms, response_target_arg, &response_target) < 0 ||
+		parseTime(ticks_per_ms, wakeup_arg, &wakeup_granularity) < 0)
+	{
+		usage(argv[0]);
+		return 1;
+	}
+	for (int i = 0; i < num_variants; i++)
+	{
+		if (Branch_parseVariant(variant_args[i], ticks_per_ms, &variants[i]) < 0)
+		{
+			printf("Invalid variant: %s\n", variant_args[i]);
+			usage(argv[0]);
+			return 1;
+		}
+	}
+
+	// the branches and the replicas would all write on the same output files
+	if (argc - optind != (restore ? 0 : histogram_folder ? 3 : 4) || (checkpoint_every_arg && !checkpoint) ||
+		(num_variants && branch_at < 0 && !replicas) || (branch_at >= 0 && (!num_variants || format || timeseries)) ||
+		(replicas && (replicas < 2 || replicas > MAX_REPLICAS || !histogram_folder || branch_at >= 0 ||
+					  format || timeseries || checkpoint || restore || telemetry_name || mem_report)) ||
+		(response_target && !adaptive_quantum) || (numa_flat && !topology))
+	{
+		usage(argv[0]);
+		return 1;
+	}
+
+	srand(time(NULL));
+	clock_gettime(CLOCK_MONOTONIC, &phase_start);
+
+	if (restore)
+	{
+		if (Checkpoint_restore(&os, restore) < 0)
+		{
+			printf("Could not restore the checkpoint %s\n", restore);
+			return 1;
+		}
+		os.verbose = !quiet;
+		os.mem_report = mem_report;
+		OS_LOG(&os, "Restored %s at time %lld\n", restore, (long long)os.timer);
+	}
+	else
+	{
+		int num_cores = atoi(argv[optind]);
+		int scheduler = atoi(argv[optind + 1]) - 1;
+		SimTime quantum;
+		const char *traces_folder = histogram_folder ? NULL : argv[optind + 3];
+
+		if (Timebase_parse(ticks_per_ms, argv[optind + 2], &quantum) < 0 ||
+			num_cores < 1 || scheduler < 0 || scheduler >= MAX_SCHEDULERS || num_procs < 1 || num_bursts < 1 || interval < 1 ||
+			(format && (!output || (strcmp(format, "json") && strcmp(format, "csv")))))
+		{
+			usage(argv[0]);
+			return 1;
+		}
+		CoreCapacity *capacity = NULL;
+		if (core_speeds && !(capacity = CoreCapacity_create(core_speeds, num_cores)))
+		{
+			printf("Invalid core speeds: %s (one per core, at most %d different)\n", core_speeds, MAX_CORE_CLASSES);
+			usage(argv[0]);
+			return 1;
+		}
+		if (energy && Energy_governor(energy) < 0)
+		{
+			CoreCapacity_destroy(capacity);
+			printf("Invalid governor: %s\n", energy);
+			usage(argv[0]);
+			return 1;
+		}
+		Topology *topo = topology ? Topology_create(topology, num_cores, ticks_per_ms) : NULL;
+		if (topology && !topo)
+		{
+			CoreCapacity_destroy(capacity);
+			printf("Invalid topology: %s (as many cores as <num_cores>, at most %d nodes)\n", topology, MAX_NODES);
+			usage(argv[0]);
+			return 1;
+		}
+		free(topo);
+
+		if (replicas)
+		{
+			// the replicas create their own from the spec
+			CoreCapacity_destroy(capacity);
+			ReplicaConfig config = {
+				histogram_folder, num_cores, num_procs, num_bursts, window, seed, replicas, threads, ticks_per_ms,
+				adaptive_quantum, response_target, wakeup_granularity, core_speeds, energy, topology, numa_flat
+			};
+			BranchVariant schedulers[MAX_BRANCHES + 1] = {{scheduler, quantum}};
+
+			for (int i = 0; i < num_variants; i++)
+				schedulers[i + 1] = variants[i];
+			Replica_run(&config, schedulers, num_variants + 1);
+			return 0;
+		}
+
+		FakeOS_init(&os, num_cores);
+		os.ticks_per_ms = ticks_per_ms;
+		FakeOS_setScheduler(&os, scheduler, quantum);
+		os.verbose = !quiet;
+		os.mem_report = mem_report;
+		os.capacity = capacity;
+		if (energy)
+			FakeOS_setEnergy(&os, energy);
+		if (topology)
+		{
+			FakeOS_setTopology(&os, topology);
+			os.topology->flat = numa_flat;
+		}
+		if (adaptive_quantum)
+		{
+			if (!os.ops->set_quantum || !(os.tuner = QuantumTuner_create(adaptive_quantum, quantum, response_target, ticks_per_ms)))
+			{
+				printf("Invalid adaptive quantum: %s (RR, MLQ and MLFQ only)\n", adaptive_quantum);
+				usage(argv[0]);
+				return 1;
+			}
+		}
+		if (wakeup_granularity >= 0 && FakeOS_setWakeupPreemption(&os, wakeup_granularity) < 0)
+		{
+			printf("Wakeup preemption needs a preemptive SJF, SRTF or priority scheduler\n");
+			usage(argv[0]);
+			return 1;
+		}
+		for (int i = 0; i < num_slos; i++)
+		{
+			if (Accounting_addSlo(&os.acct, slos[i], ticks_per_ms) < 0)
+			{
+				printf("Invalid SLO: %s\n", slos[i]);
+				usage(argv[0]);
+				return 1;
+			}
+		}
+		if (timeseries)
+			os.sampler = Sampler_open(&os, timeseries, interval);
+		if (format)
+		{
+			RunConfig config = {
+				num_cores, scheduler, quantum, timebase, traces_folder, histogram_folder,
+				num_procs, num_bursts, window, seed
+			};
+			os.report = Report_open(strcmp(format, "json") ? REPORT_CSV : REPORT_JSON, output, &config);
+		}
+
+		if (histogram_folder)
+		{
+			// pipeline mode: the processes are generated lazily, in arrival order
+			OS_LOG(&os, "Generating %d processes from %s with seed %llu\n", num_procs, histogram_folder, (unsigned long long)seed);
+			os.stream = TraceStream_open(histogram_folder, num_procs, num_bursts, seed, window);
+		}
+		else
+		{
+			// read from traces folder the process and create them
+			DIR *dir;
+			struct dirent *ent;
+			if ((dir = opendir(traces_folder)) == NULL)
+			{
+				perror("Could not open directory");
+				return 1;
+			}
+
+			while ((ent = readdir(dir)) != NULL)
+			{
+				if (ent->d_type == DT_REG)
+				{
+					char filename[512];
+					snprintf(filename, sizeof(filename), "%s/%s", traces_folder, ent->d_name);
+					OS_LOG(&os, "Reading from file: %s\n", filename);
+					FakeOS_createProcess(&os, filename);
+				}
+			}
+			closedir(dir);
+		}
+	}
+
+	if (os.report)
+		Report_phase(os.report, "load", elapsed(&phase_start));
+	clock_gettime(CLOCK_MONOTONIC, &phase_start);
+
+	// a restored simulation keeps the timebase it was saved with
+	if (parseTime(os.ticks_per_ms, checkpoint_every_arg, &checkpoint_every) < 0)
+	{
+		usage(argv[0]);
+		FakeOS_destroy(&os);
+		return 1;
+	}
+	// the telemetry segment is removed on the way out
+	if (checkpoint || telemetry_name)
+	{
+		signal(SIGTERM, requestStop);
+		signal(SIGINT, requestStop);
+	}
+	Telemetry *telemetry = Telemetry_open(telemetry_name, &os);
+	if (!telemetry)
+	{
+		printf("Invalid telemetry: %s (a name like /disastros)\n", telemetry_name);
+		usage(argv[0]);
+		FakeOS_destroy(&os);
+		return 1;
+	}
+	signal(SIGUSR1, requestDump);
+
+	// run the simulation until all processes are terminated and all queues are empty
+	SimTime last_checkpoint = os.timer;
+	while (!FakeOS_finished(&os))
+	{
+		if (dump_requested)
+		{
+			dump_requested = 0;
+			Telemetry_dump(telemetry, &os, stderr);
+		}
+		if (branch_at >= 0 && os.timer == branch_at)
+		{
+			Telemetry_close(telemetry, &os);
+			Branch_run(&os, variants, num_variants);
+			FakeOS_destroy(&os);
+			return 0;
+		}
+
+		if (stop_requested && !checkpoint)
+		{
+			Telemetry_close(telemetry, &os);
+			signal(stop_requested, SIG_DFL);
+			raise(stop_requested);
+		}
+
+		// checkpoints are taken between two steps
+		if (stop_requested || (checkpoint_every && os.timer % checkpoint_every == 0 && os.timer != last_checkpoint))
+		{
+			if (Checkpoint_save(&os, checkpoint) < 0)
+				printf("Could not save the checkpoint %s\n", checkpoint);
+			last_checkpoint = os.timer;
+			if (stop_requested)
+			{
+				printf("Simulation stopped at time %lld, resume it with --restore %s\n", (long long)os.timer, checkpoint);
+				Telemetry_close(telemetry, &os);
+				return 2;
+			}
+		}
+		FakeOS_simStep(&os);
+		Telemetry_step(telemetry, &os);
+	}
+	Telemetry_close(telemetry, &os);
+
+	if (os.sampler)
+		Sampler_close(os.sampler, &os);
+	if (os.report)
+		Report_phase(os.report, "simulate", elapsed(&phase_start));
+	clock_gettime(CLOCK_MONOTONIC, &phase_start);
+
+	FakeOS_calculateStatistics(&os);
+	if (os.report)
+	{
+		Report_phase(os.report, "statistics", elapsed(&phase_start));
+		Report_close(os.report, &os);
+		os.report = 0;
+	}
+	FakeOS_destroy(&os);
+
+	return 0;
+}
@@ -0,0 +1,91 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <sys/resource.h>
+
+#include "../include/fake_os.h"
+#include "../include/mem_stats.h"
+
+__thread MemStats mem_stats;
+
+static const char *type_names[MAX_MEM_TYPES] = {
+	"process",
+	"event",
+	"slice",
+	"pcb",
+	"pcb_keys",
+	"process_stats",
+	"sched_args",
+};
+
+const char *MemStats_name(MemType type)
+{
+	return type_names[type];
+}
+
+/**
+ * @brief Count an allocation already accounted as another type, e.g. a slice, that is an event
+ *
+ * @param type
+ * @param size bytes
+ */
+void MemStats_count(MemType type, size_t size)
+{
+	mem_stats.type[type].allocs++;
+	mem_stats.type[type].bytes += size;
+}
+
+/**
+ * @brief Allocations of the thread, every type but the ones only counted
+ *
+ * @return uint64_t
+ */
+uint64_t MemStats_allocs(void)
+{
+	uint64_t allocs = 0;
+
+	for (int i = 0; i < MAX_MEM_TYPES; i++)
+		if (i != MEM_SLICE)
+			allocs += mem_stats.type[i].allocs;
+	return allocs;
+}
+
+/**
+ * @brief Peak resident memory of the process
+ *
+ * @return long kB
+ */
+long MemStats_maxRss(void)
+{
+	struct rusage usage;
+
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_maxrss;
+}
+
+/**
+ * @brief Print the allocations by type, the peaks and the allocations per simulated second
+ *
+ * @param timer simulated time of the run
+ * @param ticks_per_ms
+ */
+void MemStats_print(SimTime timer, SimTime ticks_per_ms)
+{
+	double seconds = (double)timer / ticks_per_ms / 1000.0;
+
+	printf(ANSI_CYAN "\nMemory:          %12s %12s %14s %12s %12s\n" ANSI_RESET, "allocs", "frees", "bytes", "live", "peak");
+	for (int i = 0; i < MAX_MEM_TYPES; i++)
+	{
+		MemCounters *c = &mem_stats.type[i];
+
+		if (i == MEM_SLICE)
+			printf(ANSI_CYAN "  %-14s %12llu %12s %14llu %12s %12s\n" ANSI_RESET, type_names[i],
+				   (unsigned long long)c->allocs, "-", (unsigned long long)c->bytes, "-", "-");
+		else
+			printf(ANSI_CYAN "  %-14s %12llu %12llu %14llu %12lld %12lld\n" ANSI_RESET, type_names[i],
+				   (unsigned long long)c->allocs, (unsigned long long)c->frees, (unsigned long long)c->bytes,
+				   (long long)c->live, (long long)c->peak);
+	}
+	printf(ANSI_CYAN "Peak live bytes: \t\t[%lld]\n" ANSI_RESET, (long long)mem_stats.peak);
+	printf(ANSI_CYAN "Peak resident memory: \t\t[%ld kB]\n" ANSI_RESET, MemStats_maxRss());
+	printf(ANSI_CYAN "Allocations per sim second: \t[%.1f]\n" ANSI_RESET, seconds > 0 ? MemStats_allocs() / seconds : 0.0);
+}
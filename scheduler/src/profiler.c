@@ -0,0 +1,217 @@
+#ifdef SIM_PROFILE
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define PROF_HAS_TSC 1
+#endif
+
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#define PROF_HAS_PERF 1
+#endif
+
+#include "../include/profiler.h"
+
+/*
+ * Every phase accumulates its calls, its ticks (TSC cycles, or ns where there is no TSC) and,
+ * if perf_event_open is allowed, the cycles, instructions and cache misses of the thread.
+ * The counters are a single perf group so a phase boundary costs one read().
+ * Phases can nest (FakeOS_schedule inside the scheduling loop): each keeps its own start snapshot.
+ * The state is global, the profiler measures the thread running the simulation.
+ */
+
+#define PROF_COUNTERS 3
+
+typedef struct
+{
+	unsigned long calls;
+	uint64_t ticks;
+	uint64_t counters[PROF_COUNTERS];
+	uint64_t start_ticks;
+	uint64_t start_counters[PROF_COUNTERS];
+} PhaseStats;
+
+static const char *phase_names[MAX_PROF_PHASES] = {
+	"arrivals",
+	"waiting queue",
+	"running cores",
+	"ready print",
+	"scheduling",
+	"  schedule",
+	"tick",
+};
+
+static const char *counter_names[PROF_COUNTERS] = {"cycles", "instructions", "cache misses"};
+
+static PhaseStats phases[MAX_PROF_PHASES];
+static int initialized = 0;
+static int perf_fd = -1;
+static uint64_t start_ticks;
+static struct timespec start_time;
+
+static inline uint64_t Profiler_ticks(void)
+{
+#ifdef PROF_HAS_TSC
+	return __rdtsc();
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+#endif
+}
+
+#ifdef PROF_HAS_PERF
+static int Profiler_openCounter(uint64_t config, int group)
+{
+	struct perf_event_attr attr;
+
+	memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.type = PERF_TYPE_HARDWARE;
+	attr.config = config;
+	attr.disabled = (group == -1);
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	attr.read_format = PERF_FORMAT_GROUP;
+
+	return syscall(__NR_perf_event_open, &attr, 0, -1, group, 0);
+}
+#endif
+
+/**
+ * @brief Open the hardware counters, if allowed, and register the summary at exit
+ */
+static void Profiler_init(void)
+{
+	initialized = 1;
+	clock_gettime(CLOCK_MONOTONIC, &start_time);
+	start_ticks = Profiler_ticks();
+	atexit(Profiler_print);
+
+#ifdef PROF_HAS_PERF
+	static const uint64_t configs[PROF_COUNTERS] = {
+		PERF_COUNT_HW_CPU_CYCLES,
+		PERF_COUNT_HW_INSTRUCTIONS,
+		PERF_COUNT_HW_CACHE_MISSES,
+	};
+
+	if ((perf_fd = Profiler_openCounter(configs[0], -1)) < 0)
+		return;
+	for (int i = 1; i < PROF_COUNTERS; i++)
+	{
+		if (Profiler_openCounter(configs[i], perf_fd) < 0)
+		{
+			close(perf_fd);
+			perf_fd = -1;
+			return;
+		}
+	}
+	ioctl(perf_fd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+	ioctl(perf_fd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+}
+
+static inline void Profiler_readCounters(uint64_t *values)
+{
+	// group read format: number of counters followed by their values
+	uint64_t buf[1 + PROF_COUNTERS];
+
+	if (read(perf_fd, buf, sizeof(buf)) != sizeof(buf))
+	{
+		memset(values, 0, PROF_COUNTERS * sizeof(uint64_t));
+		return;
+	}
+	memcpy(values, &buf[1], PROF_COUNTERS * sizeof(uint64_t));
+}
+
+/**
+ * @brief Start timing a phase
+ *
+ * @param phase
+ */
+void Profiler_begin(ProfPhase phase)
+{
+	PhaseStats *p = &phases[phase];
+
+	if (!initialized)
+		Profiler_init();
+	if (perf_fd >= 0)
+		Profiler_readCounters(p->start_counters);
+	p->start_ticks = Profiler_ticks();
+}
+
+/**
+ * @brief Stop timing a phase and accumulate its cost
+ *
+ * @param phase
+ */
+void Profiler_end(ProfPhase phase)
+{
+	PhaseStats *p = &phases[phase];
+	uint64_t ticks = Profiler_ticks();
+
+	p->ticks += ticks - p->start_ticks;
+	p->calls++;
+	if (perf_fd >= 0)
+	{
+		uint64_t values[PROF_COUNTERS];
+		Profiler_readCounters(values);
+		for (int i = 0; i < PROF_COUNTERS; i++)
+			p->counters[i] += values[i] - p->start_counters[i];
+	}
+}
+
+/**
+ * @brief Print the summary of the phases, called at exit
+ */
+void Profiler_print(void)
+{
+	struct timespec now;
+	uint64_t total = 0;
+	double ns_per_tick;
+
+	if (!initialized)
+		return;
+
+	// ticks are converted to ns with the rate measured over the whole run
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	ns_per_tick = ((now.tv_sec - start_time.tv_sec) * 1e9 + (now.tv_nsec - start_time.tv_nsec)) /
+				  (double)(Profiler_ticks() - start_ticks);
+
+	for (int i = 0; i < MAX_PROF_PHASES; i++)
+		if (i != PROF_SCHEDULE)
+			total += phases[i].ticks;
+
+	fprintf(stderr, "\nSIMULATION PROFILE:\n");
+	fprintf(stderr, "%-16s %12s %12s %10s %7s", "phase", "calls", "total ms", "ns/call", "%");
+	if (perf_fd >= 0)
+		fprintf(stderr, " %14s %14s %14s %6s", counter_names[0], counter_names[1], counter_names[2], "IPC");
+	fprintf(stderr, "\n");
+
+	for (int i = 0; i < MAX_PROF_PHASES; i++)
+	{
+		PhaseStats *p = &phases[i];
+		double ns = p->ticks * ns_per_tick;
+
+		fprintf(stderr, "%-16s %12lu %12.3f %10.1f %6.2f%%", phase_names[i], p->calls, ns / 1e6,
+				p->calls ? ns / p->calls : 0, total ? p->ticks * 100.0 / total : 0);
+		if (perf_fd >= 0)
+			fprintf(stderr, " %14llu %14llu %14llu %6.2f", (unsigned long long)p->counters[0],
+					(unsigned long long)p->counters[1], (unsigned long long)p->counters[2],
+					p->counters[0] ? (double)p->counters[1] / p->counters[0] : 0);
+		fprintf(stderr, "\n");
+	}
+	if (perf_fd < 0)
+		fprintf(stderr, "hardware counters not available (perf_event_open)\n");
+}
+
+#endif
@@ -0,0 +1,184 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#include "../include/fake_os.h"
+#include "../include/quantum_tuner.h"
+
+/*
+ * The percentile is tracked by stochastic approximation: at every burst the estimate moves
+ * up by QT_GAIN * p of itself if the burst is longer, down by QT_GAIN * (1 - p) if it is not,
+ * so it settles where a fraction p of the bursts is shorter. It costs O(1) per burst, needs
+ * no memory of the samples and follows a workload that changes over time. The quantum is
+ * recomputed every QT_PERIOD ms, the step only compares the time with next_update.
+ */
+
+/**
+ * @brief Create a tuner from a spec <percentile>[:<min>:<max>], e.g. 80 or 80:5:200 or
+ *        80:500us:20ms: the bounds are in ms or take a unit, as the times of the options.
+ *        The default bounds are a quarter and eight times the initial quantum
+ *
+ * @param spec
+ * @param quantum initial quantum, in ticks
+ * @param response_target response time target in ticks, 0 for none
+ * @param ticks_per_ms timebase of the simulation
+ * @return QuantumTuner* NULL if the spec is not valid
+ */
+QuantumTuner *QuantumTuner_create(const char *spec, SimTime quantum, SimTime response_target, SimTime ticks_per_ms)
+{
+	QuantumTuner *qt;
+	double percentile;
+	SimTime min_quantum = quantum / 4 > 0 ? quantum / 4 : 1;
+	SimTime max_quantum = quantum * 8;
+	char bound[32];
+	int len, n;
+
+	if (sscanf(spec, "%lf%n", &percentile, &len) != 1)
+		return NULL;
+	spec += len;
+	if (*spec == ':')
+	{
+		// the min bound ends at the next colon, the max bound is the rest
+		if ((n = strcspn(++spec, ":")) >= (int)sizeof(bound) || spec[n] != ':')
+			return NULL;
+		snprintf(bound, sizeof(bound), "%.*s", n, spec);
+		if (Timebase_parse(ticks_per_ms, bound, &min_quantum) < 0 ||
+			Timebase_parse(ticks_per_ms, spec + n + 1, &max_quantum) < 0)
+			return NULL;
+	}
+	else if (*spec)
+		return NULL;
+	if (percentile <= 0 || percentile >= 100 || quantum < 1 || min_quantum < 1 || max_quantum < min_quantum ||
+		response_target < 0)
+		return NULL;
+
+	if (!(qt = (QuantumTuner *)calloc(1, sizeof(QuantumTuner))))
+		assert(0 && "calloc failed");
+	qt->percentile = percentile;
+	qt->min_quantum = min_quantum;
+	qt->max_quantum = max_quantum;
+	qt->response_target = response_target;
+	qt->period = QT_PERIOD * ticks_per_ms;
+	qt->quantum = quantum;
+	qt->burst_estimate = quantum;
+	qt->factor = 1.0;
+	qt->next_update = qt->period;
+	return qt;
+}
+
+/**
+ * @brief Feed the length of a CPU burst that ended with the process blocking or terminating
+ *
+ * @param qt
+ * @param burst time the process ran since it last blocked
+ */
+void QuantumTuner_observeBurst(QuantumTuner *qt, SimTime burst)
+{
+	double p = qt->percentile / 100.0;
+
+	if (burst > qt->burst_estimate)
+		qt->burst_estimate += QT_GAIN * p * qt->burst_estimate;
+	else
+		qt->burst_estimate -= QT_GAIN * (1 - p) * qt->burst_estimate;
+	if (qt->burst_estimate < 1)
+		qt->burst_estimate = 1;
+	qt->bursts++;
+}
+
+/**
+ * @brief Feed the response time of a process, at its first dispatch
+ *
+ * @param qt
+ * @param response time from the arrival to the first dispatch
+ */
+void QuantumTuner_observeResponse(QuantumTuner *qt, SimTime response)
+{
+	if (qt->responses++ == 0)
+		qt->response_avg = response;
+	else
+		qt->response_avg += QT_EWMA * (response - qt->response_avg);
+}
+
+/**
+ * @brief Round a quantum to the bounds of the tuner
+ *
+ * @param qt
+ * @param quantum
+ * @return SimTime
+ */
+static SimTime QuantumTuner_clamp(const QuantumTuner *qt, double quantum)
+{
+	if (quantum < qt->min_quantum)
+		return qt->min_quantum;
+	if (quantum > qt->max_quantum)
+		return qt->max_quantum;
+	return (SimTime)(quantum + 0.5);
+}
+
+/**
+ * @brief Give the quantum in use to the scheduler, if it has a quantum to adapt
+ *
+ * @param qt
+ * @param os
+ */
+void QuantumTuner_apply(QuantumTuner *qt, FakeOS *os)
+{
+	if (os->ops->set_quantum)
+		os->ops->set_quantum(os->schedule_args, qt->quantum);
+}
+
+/**
+ * @brief Recompute the quantum from the estimate of the bursts and the feedback loop.
+ *        It changes only if the new value is off by more than QT_HYSTERESIS
+ *
+ * @param qt
+ * @param os
+ */
+void QuantumTuner_update(QuantumTuner *qt, FakeOS *os)
+{
+	SimTime quantum;
+
+	qt->next_update = os->timer + qt->period;
+	if (!qt->bursts)
+		return;
+
+	if (qt->response_target && qt->responses)
+	{
+		if (qt->response_avg > qt->response_target)
+			qt->factor *= 1 - QT_FEEDBACK_STEP;
+		else if (qt->response_avg < qt->response_target * (1 - QT_HYSTERESIS))
+			qt->factor *= 1 + QT_FEEDBACK_STEP;
+		if (qt->factor < QT_MIN_FACTOR)
+			qt->factor = QT_MIN_FACTOR;
+		if (qt->factor > QT_MAX_FACTOR)
+			qt->factor = QT_MAX_FACTOR;
+	}
+
+	// the feedback scales the quantum within the bounds, even when the estimate is out of them
+	quantum = QuantumTuner_clamp(qt, QuantumTuner_clamp(qt, qt->burst_estimate) * qt->factor);
+
+	if (quantum != qt->quantum && llabs(quantum - qt->quantum) > qt->quantum * QT_HYSTERESIS)
+	{
+		OS_LOG(os, ANSI_GREY "\t[~] quantum %lld -> %lld\n" ANSI_RESET, (long long)qt->quantum, (long long)quantum);
+		qt->quantum = quantum;
+		qt->changes++;
+		QuantumTuner_apply(qt, os);
+	}
+}
+
+/**
+ * @brief Print the state of the tuner at the end of the simulation
+ *
+ * @param qt
+ * @param unit of the times, the one of the timebase
+ */
+void QuantumTuner_print(const QuantumTuner *qt, const char *unit)
+{
+	printf(ANSI_CYAN "\nAdaptive quantum: \t\t[%lld %s] p%g of the bursts %.1f %s, bounds [%lld, %lld], %u changes\n" ANSI_RESET,
+		   (long long)qt->quantum, unit, qt->percentile, qt->burst_estimate, unit, (long long)qt->min_quantum,
+		   (long long)qt->max_quantum, qt->changes);
+	if (qt->response_target)
+		printf(ANSI_CYAN "Response target: \t\t[%lld %s] average %.1f %s, feedback factor %.2f\n" ANSI_RESET,
+			   (long long)qt->response_target, unit, qt->response_avg, unit, qt->factor);
+}
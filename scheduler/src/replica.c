@@ -0,0 +1,342 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "../include/fake_os.h"
+#include "../include/replica.h"
+
+/*
+ * Monte Carlo replication: every replica is an independent workload generated from the same
+ * histograms with its own seed, simulated under each scheduler. The histograms are loaded once
+ * and shared read only by all the streams; the simulations run in memory on a pool of threads,
+ * each one on its own FakeOS, and nothing is written on disk. Every metric is summarized over
+ * the replicas with a 95% confidence interval, and every scheduler is compared with the first
+ * one on the paired differences of the same replicas, which cancels most of the variance of
+ * the workload.
+ */
+
+#define REPLICA_METRICS 10     // the last one, the energy, only with the energy model
+
+static const char *metric_names[REPLICA_METRICS] = {
+	"total", "cpu %", "turn avg", "turn p99", "wait avg", "wait p99", "resp avg", "resp p99", "jain", "energy [J]",
+};
+
+typedef struct
+{
+	const ReplicaConfig *config;
+	const BranchVariant *schedulers;
+	int num_schedulers;
+	TraceHistograms *histograms;
+	BranchResult *results; // job = replica * num_schedulers + scheduler
+	int num_metrics;
+	int next_job;          // next job to hand out, shared by the workers
+} ReplicaWork;
+
+typedef struct
+{
+	double mean;
+	double stddev;
+	double half;    // half width of the 95% confidence interval of the mean
+	double min;
+	double max;
+} ReplicaSummary;
+
+/**
+ * @brief Name of a metric as printed, the total time with the unit of the timebase
+ *
+ * @param config
+ * @param metric index in metric_names
+ * @param buf
+ * @param size
+ * @return const char*
+ */
+static const char *metricName(const ReplicaConfig *config, int metric, char *buf, size_t size)
+{
+	if (metric)
+		return metric_names[metric];
+	snprintf(buf, size, "%s [%s]", metric_names[0], Timebase_unit(config->ticks_per_ms));
+	return buf;
+}
+
+/**
+ * @brief Value of a metric in the outcome of a run
+ *
+ * @param r
+ * @param metric index in metric_names
+ * @return double
+ */
+static double metricValue(const BranchResult *r, int metric)
+{
+	switch (metric)
+	{
+	case 0: return r->total_time;
+	case 1: return r->cpu_used;
+	case 2: return r->turnaround_mean;
+	case 3: return (double)r->turnaround_p99;
+	case 4: return r->waiting_mean;
+	case 5: return (double)r->waiting_p99;
+	case 6: return r->response_mean;
+	case 7: return (double)r->response_p99;
+	case 8: return r->jain;
+	default: return r->energy;
+	}
+}
+
+/**
+ * @brief Two sided 95% critical value of the Student t distribution
+ *
+ * @param df degrees of freedom
+ * @return double
+ */
+static double tCritical(int df)
+{
+	static const double t95[30] = {
+		12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+		2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+		2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042,
+	};
+
+	if (df <= 30)
+		return t95[df - 1];
+	if (df <= 40)
+		return 2.021;
+	if (df <= 60)
+		return 2.000;
+	if (df <= 120)
+		return 1.980;
+	return 1.960;
+}
+
+/**
+ * @brief Mean, standard deviation and confidence interval of a sample (n >= 2)
+ *
+ * @param x
+ * @param n
+ * @param s
+ */
+static void summarize(const double *x, int n, ReplicaSummary *s)
+{
+	double sum = 0, sq = 0;
+
+	s->min = s->max = x[0];
+	for (int i = 0; i < n; i++)
+	{
+		sum += x[i];
+		if (x[i] < s->min)
+			s->min = x[i];
+		if (x[i] > s->max)
+			s->max = x[i];
+	}
+	s->mean = sum / n;
+	for (int i = 0; i < n; i++)
+		sq += (x[i] - s->mean) * (x[i] - s->mean);
+	s->stddev = sqrt(sq / (n - 1));
+	s->half = tCritical(n - 1) * s->stddev / sqrt(n);
+}
+
+/**
+ * @brief Simulate a job: the workload of its replica under its scheduler
+ *
+ * @param work
+ * @param job
+ */
+static void Replica_simulate(ReplicaWork *work, int job)
+{
+	const ReplicaConfig *config = work->config;
+	const BranchVariant *variant = &work->schedulers[job % work->num_schedulers];
+	int replica = job / work->num_schedulers;
+	FakeOS os;
+
+	FakeOS_init(&os, config->cores);
+	os.ticks_per_ms = config->ticks_per_ms;
+	FakeOS_setScheduler(&os, variant->scheduler, variant->quantum);
+	os.verbose = 0;
+	if (config->adaptive_quantum && os.ops->set_quantum)
+		os.tuner = QuantumTuner_create(config->adaptive_quantum, variant->quantum, config->response_target, config->ticks_per_ms);
+	if (config->wakeup_granularity >= 0)
+		FakeOS_setWakeupPreemption(&os, config->wakeup_granularity);
+	if (config->core_speeds)
+		os.capacity = CoreCapacity_create(config->core_speeds, config->cores);
+	if (config->energy)
+		FakeOS_setEnergy(&os, config->energy);
+	if (config->topology && FakeOS_setTopology(&os, config->topology) == 0)
+		os.topology->flat = config->numa_flat;
+	os.stream = TraceStream_openShared(work->histograms, config->num_procs, config->num_bursts,
+									   config->seed + replica, config->window);
+
+	while (!FakeOS_finished(&os))
+		FakeOS_simStep(&os);
+
+	Branch_result(&os, &work->results[job]);
+	FakeOS_destroy(&os);
+}
+
+static void *Replica_worker(void *arg)
+{
+	ReplicaWork *work = (ReplicaWork *)arg;
+	int jobs = work->config->replicas * work->num_schedulers;
+	int job;
+
+	// a job is a whole simulation, one at a time keeps the threads balanced
+	while ((job = __atomic_fetch_add(&work->next_job, 1, __ATOMIC_RELAXED)) < jobs)
+		Replica_simulate(work, job);
+	return NULL;
+}
+
+/**
+ * @brief Name of a scheduler configuration, e.g. RR:20
+ *
+ * @param config
+ * @param variant
+ * @param name
+ * @param size
+ */
+static void variantName(const ReplicaConfig *config, const BranchVariant *variant, char *name, size_t size)
+{
+	char quantum[32];
+
+	Timebase_format(quantum, sizeof(quantum), config->ticks_per_ms, variant->quantum);
+	snprintf(name, size, "%s:%s", print_scheduler(variant->scheduler), quantum);
+}
+
+/**
+ * @brief Print the summary of every metric of every scheduler
+ *
+ * @param work
+ * @param samples buffer of config->replicas values
+ */
+static void Replica_printSummary(ReplicaWork *work, double *samples)
+{
+	int n = work->config->replicas;
+
+	for (int s = 0; s < work->num_schedulers; s++)
+	{
+		char name[64], metric[32];
+
+		variantName(work->config, &work->schedulers[s], name, sizeof(name));
+		printf(ANSI_CYAN "\n  %-16s %12s %10s %10s %12s %12s\n" ANSI_RESET, name, "mean", "ci95 +-", "stddev", "min", "max");
+		for (int m = 0; m < work->num_metrics; m++)
+		{
+			ReplicaSummary sum;
+
+			for (int r = 0; r < n; r++)
+				samples[r] = metricValue(&work->results[r * work->num_schedulers + s], m);
+			summarize(samples, n, &sum);
+			printf(ANSI_CYAN "    %-14s %12.3f %10.3f %10.3f %12.3f %12.3f\n" ANSI_RESET, metricName(work->config, m, metric, sizeof(metric)),
+				   sum.mean, sum.half, sum.stddev, sum.min, sum.max);
+		}
+	}
+}
+
+/**
+ * @brief Print the paired differences of every scheduler with the first one.
+ *        A difference is marked when its confidence interval doesn't contain 0
+ *
+ * @param work
+ * @param samples buffer of config->replicas values
+ */
+static void Replica_printDifferences(ReplicaWork *work, double *samples)
+{
+	int n = work->config->replicas;
+	char base[64];
+
+	variantName(work->config, &work->schedulers[0], base, sizeof(base));
+	for (int s = 1; s < work->num_schedulers; s++)
+	{
+		char name[64], metric[32];
+
+		variantName(work->config, &work->schedulers[s], name, sizeof(name));
+		printf(ANSI_CYAN "\n  %s - %s\n" ANSI_RESET, name, base);
+		printf(ANSI_CYAN "    %-14s %12s %10s %10s\n" ANSI_RESET, "", "diff", "ci95 +-", "diff %");
+		for (int m = 0; m < work->num_metrics; m++)
+		{
+			ReplicaSummary diff;
+			double base_mean = 0;
+
+			for (int r = 0; r < n; r++)
+			{
+				double b = metricValue(&work->results[r * work->num_schedulers], m);
+				samples[r] = metricValue(&work->results[r * work->num_schedulers + s], m) - b;
+				base_mean += b / n;
+			}
+			summarize(samples, n, &diff);
+			printf(ANSI_CYAN "    %-14s %12.3f %10.3f", metricName(work->config, m, metric, sizeof(metric)), diff.mean, diff.half);
+			if (base_mean != 0)
+				printf(" %+9.2f%%", diff.mean * 100.0 / base_mean);
+			else
+				printf(" %10s", "-");
+			printf(" %s\n" ANSI_RESET, fabs(diff.mean) > diff.half ? "*" : "");
+		}
+	}
+}
+
+/**
+ * @brief Simulate config->replicas workloads under every scheduler on a pool of threads,
+ *        then print the summary of the metrics and the paired differences with schedulers[0]
+ *
+ * @param config
+ * @param schedulers
+ * @param num_schedulers
+ */
+void Replica_run(const ReplicaConfig *config, const BranchVariant *schedulers, int num_schedulers)
+{
+	ReplicaWork work = {
+		config, schedulers, num_schedulers, NULL, NULL, config->energy ? REPLICA_METRICS : REPLICA_METRICS - 1, 0
+	};
+	int jobs = config->replicas * num_schedulers;
+	int num_threads = config->threads > 0 ? config->threads : (int)sysconf(_SC_NPROCESSORS_ONLN);
+	struct timespec start, end;
+	double *samples;
+
+	assert(config->replicas >= 2 && config->replicas <= MAX_REPLICAS && "replicas out of range");
+	assert(num_schedulers > 0 && "no scheduler");
+
+#ifdef SIM_PROFILE
+	// the state of the profiler is global
+	num_threads = 1;
+#endif
+	if (num_threads < 1)
+		num_threads = 1;
+	if (num_threads > jobs)
+		num_threads = jobs;
+
+	if ((work.results = (BranchResult *)calloc(jobs, sizeof(BranchResult))) == NULL)
+		assert(0 && "calloc failed");
+	if ((samples = (double *)malloc(config->replicas * sizeof(double))) == NULL)
+		assert(0 && "malloc failed");
+	work.histograms = TraceHistograms_load(config->histogram_folder);
+
+	pthread_t threads[num_threads];
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (int i = 0; i < num_threads; i++)
+	{
+		if (pthread_create(&threads[i], NULL, Replica_worker, &work) != 0)
+			assert(0 && "pthread_create failed");
+	}
+	for (int i = 0; i < num_threads; i++)
+		pthread_join(threads[i], NULL);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	printf(ANSI_CYAN "\n\n------------------------------------MONTE CARLO------------------------------------\n" ANSI_RESET);
+	printf(ANSI_CYAN "%d replicas of %d processes on %d cores, seeds %llu..%llu, %d runs on %d threads in %.2f s\n" ANSI_RESET,
+		   config->replicas, config->num_procs, config->cores, (unsigned long long)config->seed,
+		   (unsigned long long)(config->seed + config->replicas - 1), jobs, num_threads,
+		   (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9);
+
+	Replica_printSummary(&work, samples);
+	if (num_schedulers > 1)
+	{
+		printf(ANSI_CYAN "\nPaired differences (* the 95%% interval excludes 0):\n" ANSI_RESET);
+		Replica_printDifferences(&work, samples);
+	}
+
+	TraceHistograms_destroy(work.histograms);
+	free(work.results);
+	free(samples);
+}
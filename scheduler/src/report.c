@@ -0,0 +1,413 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <sys/resource.h>
+
+#include "../include/fake_os.h"
+
+/*
+ * Small writer shared by the two formats: objects and arrays nest up to REPORT_MAX_DEPTH,
+ * JSON writes them as they are, CSV flattens the path of every value in <section>,<metric>
+ * (e.g. statistics,turnaround.p99,1234).
+ */
+
+/**
+ * @brief Write a JSON string: quotes and backslashes escaped, control characters as \u00XX
+ *
+ * @param out
+ * @param str
+ */
+static void writeString(FILE *out, const char *str)
+{
+	fputc('"', out);
+	for (; str && *str; str++)
+	{
+		if (*str == '"' || *str == '\\')
+			fprintf(out, "\\%c", *str);
+		else if ((unsigned char)*str < 0x20)
+			fprintf(out, "\\u%04x", (unsigned char)*str);
+		else
+			fputc(*str, out);
+	}
+	fputc('"', out);
+}
+
+/**
+ * @brief Write a CSV field (RFC 4180): quoted only if it holds a comma, a quote or a line break,
+ *        the quotes doubled
+ *
+ * @param out
+ * @param str
+ */
+static void writeCsvField(FILE *out, const char *str)
+{
+	if (!str[strcspn(str, ",\"\r\n")])
+	{
+		fputs(str, out);
+		return;
+	}
+	fputc('"', out);
+	for (; *str; str++)
+	{
+		if (*str == '"')
+			fputc('"', out);
+		fputc(*str, out);
+	}
+	fputc('"', out);
+}
+
+/**
+ * @brief Start a new element at the current depth: separator and key in JSON
+ *
+ * @param r
+ * @param key key of the element, NULL inside arrays
+ */
+static void beginElement(Report *r, const char *key)
+{
+	if (r->format == REPORT_JSON)
+	{
+		fprintf(r->out, "%s\n%*s", r->first[r->depth] ? "" : ",", 2 * r->depth, "");
+		if (key)
+		{
+			writeString(r->out, key);
+			fprintf(r->out, ": ");
+		}
+	}
+	r->first[r->depth] = 0;
+}
+
+/**
+ * @brief Write the CSV path of a value: the outermost key is the section, the others the metric
+ *
+ * @param r
+ * @param key
+ */
+static void writePath(Report *r, const char *key)
+{
+	char metric[512];
+	int len = 0;
+
+	if (r->depth < 2)
+	{
+		fputc(',', r->out);
+		writeCsvField(r->out, key);
+		fputc(',', r->out);
+		return;
+	}
+	writeCsvField(r->out, r->keys[2]);
+	fputc(',', r->out);
+	// the keys can be names of sources, the metric is quoted as a whole
+	for (int i = 3; i <= r->depth && len < (int)sizeof(metric); i++)
+		len += snprintf(metric + len, sizeof(metric) - len, "%s.", r->keys[i]);
+	if (len < (int)sizeof(metric))
+		snprintf(metric + len, sizeof(metric) - len, "%s", key);
+	writeCsvField(r->out, metric);
+	fputc(',', r->out);
+}
+
+static void beginNested(Report *r, const char *key, char open)
+{
+	assert(r->depth + 1 < REPORT_MAX_DEPTH && "report nested too deep");
+	beginElement(r, key);
+	if (r->format == REPORT_JSON)
+		fputc(open, r->out);
+	r->depth++;
+	r->keys[r->depth] = key;
+	r->first[r->depth] = 1;
+}
+
+static void endNested(Report *r, char close)
+{
+	r->depth--;
+	if (r->format == REPORT_JSON)
+		fprintf(r->out, "\n%*s%c", 2 * r->depth, "", close);
+}
+
+static void beginObject(Report *r, const char *key) { beginNested(r, key, '{'); }
+static void endObject(Report *r) { endNested(r, '}'); }
+static void beginArray(Report *r, const char *key) { beginNested(r, key, '['); }
+static void endArray(Report *r) { endNested(r, ']'); }
+
+static void kvInt(Report *r, const char *key, uint64_t value)
+{
+	beginElement(r, key);
+	if (r->format == REPORT_CSV)
+		writePath(r, key);
+	fprintf(r->out, "%lu", (unsigned long)value);
+	if (r->format == REPORT_CSV)
+		fputc('\n', r->out);
+}
+
+static void kvNum(Report *r, const char *key, double value)
+{
+	beginElement(r, key);
+	if (r->format == REPORT_CSV)
+		writePath(r, key);
+	fprintf(r->out, "%.6f", value);
+	if (r->format == REPORT_CSV)
+		fputc('\n', r->out);
+}
+
+static void kvStr(Report *r, const char *key, const char *value)
+{
+	beginElement(r, key);
+	if (r->format == REPORT_CSV)
+		writePath(r, key);
+	if (value && r->format == REPORT_CSV)
+		writeCsvField(r->out, value);
+	else if (value)
+		writeString(r->out, value);
+	else
+		fputs((r->format == REPORT_JSON) ? "null" : "", r->out);
+	if (r->format == REPORT_CSV)
+		fputc('\n', r->out);
+}
+
+// null in JSON, an empty value in CSV
+static void kvNull(Report *r, const char *key) { kvStr(r, key, NULL); }
+
+/**
+ * @brief Open the structured output and write the configuration of the run
+ *
+ * @param format
+ * @param filename
+ * @param config
+ * @return Report*
+ */
+Report *Report_open(ReportFormat format, const char *filename, const RunConfig *config)
+{
+	Report *r = (Report *)malloc(sizeof(Report));
+	if (!r)
+		assert(0 && "malloc failed creating report");
+
+	r->format = format;
+	r->depth = 0;
+	r->first[0] = 1;
+	r->keys[0] = NULL;
+	r->num_phases = 0;
+	r->procs_out = NULL;
+	if (!(r->out = fopen(filename, "w")))
+		assert(0 && "could not open output file");
+	if (!(r->filename = strdup(filename)))
+		assert(0 && "malloc failed creating report");
+
+	if (format == REPORT_JSON)
+	{
+		fputc('{', r->out);
+		r->depth = 1;
+		r->first[1] = 1;
+	}
+	else
+	{
+		char procs_filename[512];
+		snprintf(procs_filename, sizeof(procs_filename), "%s.processes.csv", filename);
+		if (!(r->procs_out = fopen(procs_filename, "w")))
+			assert(0 && "could not open output file");
+		fprintf(r->out, "section,metric,value\n");
+		fprintf(r->procs_out, "pid,priority,source,arrival,complete,turnaround,waiting,response,cpu\n");
+		r->depth = 1;
+	}
+
+	beginObject(r, "config");
+	kvInt(r, "cores", config->cores);
+	kvStr(r, "scheduler", print_scheduler(config->scheduler));
+	kvInt(r, "quantum", config->quantum);
+	kvStr(r, "timebase", config->timebase);
+	kvStr(r, "traces_folder", config->traces_folder);
+	kvStr(r, "histogram_folder", config->histogram_folder);
+	if (config->histogram_folder)
+	{
+		kvInt(r, "procs", config->procs);
+		kvInt(r, "bursts", config->bursts);
+		kvInt(r, "window", config->window);
+		kvInt(r, "seed", config->seed);
+	}
+	endObject(r);
+
+	if (format == REPORT_JSON)
+		beginArray(r, "processes");
+
+	return r;
+}
+
+/**
+ * @brief Write the record of a terminated process
+ *
+ * @param r
+ * @param os
+ * @param pcb
+ */
+void Report_process(Report *r, FakeOS *os, FakePCB *pcb)
+{
+	ProcessStats *st = FakeOS_cold(os, pcb);
+	const char *source = (pcb->source >= 0) ? os->acct.source_names[pcb->source] : "";
+
+	if (r->format == REPORT_CSV)
+	{
+		fprintf(r->procs_out, "%d,%s,", pcb->pid, print_priority(pcb->priority));
+		writeCsvField(r->procs_out, source);
+		fprintf(r->procs_out, ",%lld,%lld,%lld,%lld,%lld,%lld\n", (long long)st->arrival_time, (long long)st->complete_time, (long long)st->turnaround_time,
+			(long long)st->waiting_time, (long long)st->response_time, (long long)st->cpu_time);
+		return;
+	}
+
+	beginElement(r, NULL);
+	fprintf(r->out, "{\"pid\": %d, \"priority\": \"%s\", \"source\": ", pcb->pid, print_priority(pcb->priority));
+	writeString(r->out, source);
+	fprintf(r->out, ", \"arrival\": %lld, \"complete\": %lld, \"turnaround\": %lld, \"waiting\": %lld, \"response\": %lld, \"cpu\": %lld}",
+		(long long)st->arrival_time, (long long)st->complete_time, (long long)st->turnaround_time,
+		(long long)st->waiting_time, (long long)st->response_time, (long long)st->cpu_time);
+}
+
+/**
+ * @brief Record the wall time of a phase of the simulator
+ *
+ * @param r
+ * @param name
+ * @param seconds
+ */
+void Report_phase(Report *r, const char *name, double seconds)
+{
+	assert(r->num_phases < REPORT_MAX_PHASES && "too many phases");
+	r->phase_names[r->num_phases] = name;
+	r->phase_seconds[r->num_phases] = seconds;
+	r->num_phases++;
+}
+
+static void writeHist(Report *r, const char *key, const LatencyHist *h)
+{
+	beginObject(r, key);
+	kvNum(r, "mean", LatencyHist_mean(h));
+	kvInt(r, "min", h->count ? h->min : 0);
+	kvInt(r, "p50", LatencyHist_percentile(h, 50));
+	kvInt(r, "p90", LatencyHist_percentile(h, 90));
+	kvInt(r, "p95", LatencyHist_percentile(h, 95));
+	kvInt(r, "p99", LatencyHist_percentile(h, 99));
+	kvInt(r, "p999", LatencyHist_percentile(h, 99.9));
+	kvInt(r, "max", h->max);
+	endObject(r);
+}
+
+static void writeClass(Report *r, const char *key, const ClassStats *cs)
+{
+	beginObject(r, key);
+	kvInt(r, "completed", cs->completed);
+	kvInt(r, "cpu_time", cs->cpu_time);
+	kvNum(r, "waiting_avg", cs->completed ? (double)cs->waiting_time / cs->completed : 0.0);
+	kvInt(r, "max_starvation", cs->max_starvation);
+	kvNum(r, "jain", Accounting_jain(cs, 1));
+	writeHist(r, "response", &cs->response);
+	endObject(r);
+}
+
+/**
+ * @brief Write the statistics, the fairness accounting and the timings, then close the output
+ *
+ * @param r
+ * @param os
+ */
+void Report_close(Report *r, FakeOS *os)
+{
+	SimStats *stats = &os->stats;
+	Accounting *acct = &os->acct;
+	struct rusage usage;
+	char name[32];
+
+	if (r->format == REPORT_JSON)
+		endArray(r);
+
+	beginObject(r, "statistics");
+	kvInt(r, "total_time", os->timer);
+	kvInt(r, "completed", stats->completed);
+	kvNum(r, "throughput", os->timer ? (double)stats->completed / os->timer * os->ticks_per_ms : 0.0);
+	kvNum(r, "cpu_used", os->timer ? (double)os->cpu_busy_time / ((double)os->timer * os->cores) * 100.0 : 0.0);
+	beginObject(r, "core_used");
+	for (unsigned int i = 0; i < os->cores; i++)
+	{
+		snprintf(name, sizeof(name), "%u", i);
+		kvNum(r, name, os->timer ? (double)os->core_busy_time[i] / os->timer * 100.0 : 0.0);
+	}
+	endObject(r);
+	writeHist(r, "turnaround", &stats->turnaround);
+	writeHist(r, "waiting", &stats->waiting);
+	writeHist(r, "response", &stats->response);
+	endObject(r);
+
+	beginObject(r, "fairness");
+	beginObject(r, "classes");
+	for (int i = 0; i < MAX_PRIORITY; i++)
+		writeClass(r, print_priority(i), &acct->priority[i]);
+	endObject(r);
+	beginObject(r, "sources");
+	for (int i = 0; i < acct->num_sources; i++)
+		writeClass(r, acct->source_names[i], &acct->source[i]);
+	endObject(r);
+	kvNum(r, "jain_processes", Accounting_jain(acct->priority, MAX_PRIORITY));
+	kvNum(r, "jain_classes", Accounting_jainClasses(acct->priority, MAX_PRIORITY));
+	kvNum(r, "jain_sources", Accounting_jainClasses(acct->source, acct->num_sources));
+	beginObject(r, "slos");
+	for (int i = 0; i < acct->num_slos; i++)
+	{
+		SloTarget *slo = &acct->slos[i];
+		uint64_t value = LatencyHist_percentile(&acct->priority[slo->priority].response, slo->percentile);
+
+		snprintf(name, sizeof(name), "%d", i);
+		beginObject(r, name);
+		kvStr(r, "class", print_priority(slo->priority));
+		kvNum(r, "percentile", slo->percentile);
+		kvInt(r, "threshold", slo->threshold);
+		// a class without completions has no percentile, the SLO is neither met nor violated
+		if (acct->priority[slo->priority].completed)
+		{
+			kvInt(r, "value", value);
+			kvInt(r, "met", value <= (uint64_t)slo->threshold);
+		}
+		else
+		{
+			kvNull(r, "value");
+			kvNull(r, "met");
+		}
+		endObject(r);
+	}
+	endObject(r);
+	endObject(r);
+
+	beginObject(r, "memory");
+	for (int i = 0; i < MAX_MEM_TYPES; i++)
+	{
+		MemCounters *c = &mem_stats.type[i];
+
+		beginObject(r, MemStats_name(i));
+		kvInt(r, "allocs", c->allocs);
+		kvInt(r, "bytes", c->bytes);
+		// the slices are freed as events
+		if (i != MEM_SLICE)
+		{
+			kvInt(r, "frees", c->frees);
+			kvInt(r, "live", c->live);
+			kvInt(r, "peak", c->peak);
+		}
+		endObject(r);
+	}
+	kvInt(r, "peak_live_bytes", mem_stats.peak);
+	kvNum(r, "allocs_per_sim_second", os->timer ? MemStats_allocs() / ((double)os->timer / os->ticks_per_ms / 1000.0) : 0.0);
+	endObject(r);
+
+	getrusage(RUSAGE_SELF, &usage);
+	beginObject(r, "timings");
+	for (int i = 0; i < r->num_phases; i++)
+		kvNum(r, r->phase_names[i], r->phase_seconds[i]);
+	kvNum(r, "user_cpu", usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6);
+	kvNum(r, "sys_cpu", usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6);
+	kvInt(r, "max_rss_kb", usage.ru_maxrss);
+	endObject(r);
+
+	if (r->format == REPORT_JSON)
+		fprintf(r->out, "\n}\n");
+	fclose(r->out);
+	if (r->procs_out)
+		fclose(r->procs_out);
+	free(r->filename);
+	free(r);
+}
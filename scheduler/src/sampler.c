@@ -0,0 +1,100 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#include "../include/fake_os.h"
+
+/**
+ * @brief Open the time series file and write its header
+ *
+ * @param os The fake OS instance, the scheduler must be already set
+ * @param filename The file of the time series
+ * @param interval Length of an interval in ticks
+ * @return Sampler*
+ */
+Sampler *Sampler_open(FakeOS *os, const char *filename, SimTime interval)
+{
+	int levels[MAX_READY_LEVELS];
+	int num_levels = FakeOS_readyLevels(os, levels);
+
+	assert(interval > 0 && "empty sampling interval");
+
+	Sampler *sampler = (Sampler *)malloc(sizeof(Sampler));
+	if (!sampler)
+		assert(0 && "malloc failed creating sampler");
+	if (!(sampler->last_core_busy = (SimTime *)calloc(os->cores, sizeof(SimTime))))
+		assert(0 && "malloc failed creating sampler");
+	if (!(sampler->out = fopen(filename, "w")))
+		assert(0 && "could not open time series file");
+	if (!(sampler->filename = strdup(filename)))
+		assert(0 && "malloc failed creating sampler");
+
+	sampler->interval = interval;
+	sampler->start = os->timer;
+	sampler->cores = os->cores;
+	sampler->last_completed = os->stats.completed;
+
+	// one column per core and per ready level
+	fprintf(sampler->out, "time");
+	for (unsigned int i = 0; i < os->cores; i++)
+		fprintf(sampler->out, ",busy_core%u", i);
+	for (int i = 0; i < num_levels; i++)
+		fprintf(sampler->out, ",ready_q%d", i);
+	fprintf(sampler->out, ",waiting,completed\n");
+
+	return sampler;
+}
+
+/**
+ * @brief Write the row of the interval [sampler->start, os->timer)
+ *
+ * @param sampler
+ * @param os
+ */
+static void Sampler_emit(Sampler *sampler, FakeOS *os)
+{
+	int levels[MAX_READY_LEVELS];
+	int num_levels = FakeOS_readyLevels(os, levels);
+
+	fprintf(sampler->out, "%lld", (long long)sampler->start);
+	for (unsigned int i = 0; i < sampler->cores; i++)
+	{
+		fprintf(sampler->out, ",%lld", (long long)(os->core_busy_time[i] - sampler->last_core_busy[i]));
+		sampler->last_core_busy[i] = os->core_busy_time[i];
+	}
+	for (int i = 0; i < num_levels; i++)
+		fprintf(sampler->out, ",%d", levels[i]);
+	fprintf(sampler->out, ",%d,%u\n", os->waiting.size, os->stats.completed - sampler->last_completed);
+
+	sampler->last_completed = os->stats.completed;
+	sampler->start = os->timer;
+}
+
+/**
+ * @brief Called after every simulation step, writes a row when an interval is over
+ *
+ * @param sampler
+ * @param os
+ */
+void Sampler_step(Sampler *sampler, FakeOS *os)
+{
+	if (os->timer - sampler->start >= sampler->interval)
+		Sampler_emit(sampler, os);
+}
+
+/**
+ * @brief Write the last (partial) interval and close the file
+ *
+ * @param sampler
+ * @param os
+ */
+void Sampler_close(Sampler *sampler, FakeOS *os)
+{
+	if (os->timer > sampler->start)
+		Sampler_emit(sampler, os);
+	fclose(sampler->out);
+	free(sampler->filename);
+	free(sampler->last_core_busy);
+	free(sampler);
+}
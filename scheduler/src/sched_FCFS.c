@@ -5,33 +5,35 @@
 #include <limits.h>
 
 #include "../include/fake_os.h"
+#include "../include/sched_inline.h"
 
-void *FCFSArgs(int quantum, SchedulerType scheduler)
+void *FCFSArgs(SimTime quantum, SchedulerType scheduler)
 {
-    SchedFCFSArgs *args = (SchedFCFSArgs *)malloc(sizeof(SchedFCFSArgs));
+    SchedFCFSArgs *args = (SchedFCFSArgs *)MemStats_alloc(MEM_SCHED_ARGS, sizeof(SchedFCFSArgs));
     if (!args)
         assert(0 && "malloc failed setting scheduler arguments");
+    List_init(&args->ready);
     args->quantum = (scheduler == FCFS_PREEMPTIVE) ? quantum : 0;
     args->preemptive = (scheduler == FCFS_PREEMPTIVE);
     return args;
 }
 
-void schedFCFS(struct FakeOS *os, void *args_)
+/**
+ * @brief Free the arguments of the FCFS scheduler.
+ *
+ * @param args_ The arguments of the FCFS scheduler.
+ */
+void FCFS_destroyArgs(void *args_)
 {
-    // look for the first process in ready
-    // if none, return
-    if (!os->ready.first)
-        return;
-
-    SchedFCFSArgs *args = (SchedFCFSArgs *)args_;
-    FakePCB *pcb = (FakePCB *)List_popFront(&os->ready);
-    pcb->duration = 0;
-
-    // put it in running list (first empty slot)
-    dispatcher(os, pcb);
+    MemStats_free(MEM_SCHED_ARGS, args_, sizeof(SchedFCFSArgs));
+}
 
-	/*********************** FCFS Preemptive ***********************/
-    // Preempt the current CPU burst event if it exceeds the given quantum
-	if (args->preemptive)
-        sched_preemption(pcb, args->quantum);
-};
\ No newline at end of file
+const SchedOps FCFS_ops = {
+    .init = FCFSArgs,
+    .destroy = FCFS_destroyArgs,
+    .enqueue = sched_enqueue,
+    .pick = FCFS_pick,
+    .on_preempt = FCFS_onPreempt,
+    .stats = sched_levels,
+    .print = sched_printQueue,
+};
@@ -5,35 +5,46 @@
 #include <limits.h>
 
 #include "../include/fake_os.h"
+#include "../include/sched_inline.h"
 
-void *RRArgs(int quantum, SchedulerType scheduler)
+void *RRArgs(SimTime quantum, SchedulerType scheduler)
 {
-    SchedRRArgs *args = (SchedRRArgs *)malloc(sizeof(SchedRRArgs));
+    SchedRRArgs *args = (SchedRRArgs *)MemStats_alloc(MEM_SCHED_ARGS, sizeof(SchedRRArgs));
     if (!args)
         assert(0 && "malloc failed setting scheduler arguments");
+    List_init(&args->ready);
     args->quantum = quantum;
     return args;
 }
 
-
-void schedRR(struct FakeOS *os, void *args_)
+/**
+ * @brief Change the quantum, for the next dispatches
+ *
+ * @param args_ The arguments of the RR scheduler.
+ * @param quantum The new quantum.
+ */
+void RR_setQuantum(void *args_, SimTime quantum)
 {
-    // look for the first process in ready
-    // if none, return
-    if (!os->ready.first)
-        return;
-
-    SchedRRArgs *args = (SchedRRArgs *)args_;
-    FakePCB *pcb = NULL;
-
-    // take the first process in ready queue 
-    pcb = (FakePCB *)List_popFront(&os->ready);
-    pcb->duration = 0;
+    ((SchedRRArgs *)args_)->quantum = quantum;
+}
 
-    // put it in running list (first empty slot)
-    dispatcher(os, pcb);
+/**
+ * @brief Free the arguments of the RR scheduler.
+ *
+ * @param args_ The arguments of the RR scheduler.
+ */
+void RR_destroyArgs(void *args_)
+{
+    MemStats_free(MEM_SCHED_ARGS, args_, sizeof(SchedRRArgs));
+}
 
-	/*********************** RR Preemptive ***********************/
-    // Preempt the current CPU burst event if it exceeds the given quantum
-    sched_preemption(pcb, args->quantum);
-};
\ No newline at end of file
+const SchedOps RR_ops = {
+    .init = RRArgs,
+    .destroy = RR_destroyArgs,
+    .enqueue = sched_enqueue,
+    .pick = RR_pick,
+    .on_preempt = RR_onPreempt,
+    .stats = sched_levels,
+    .print = sched_printQueue,
+    .set_quantum = RR_setQuantum,
+};
@@ -17,9 +17,21 @@ void dispatcher(FakeOS *os, FakePCB *pcb)
 {
     int i = 0;
 	FakePCB **running = os->running;
-	while (running[i])
-		++i;
+	// the nodes are chosen by the home of the process, the cores of different speeds by its burst
+	if (os->topology)
+		i = Topology_place(os->topology, os, pcb);
+	else if (os->capacity)
+		i = CoreCapacity_place(os->capacity, os, pcb);
+	else
+		while (running[i])
+			++i;
+	if (os->capacity)
+		CoreCapacity_observe(os->capacity, pcb);
 	running[i] = pcb;   
+    // the run time and the slice flag are of this dispatch (see FakeOS_preempt)
+    pcb->duration = 0;
+    pcb->quantum_used = 0;
+    Accounting_dispatch(&os->acct, pcb, os->timer - FakeOS_hot(os, pcb)->ready_since);
     FakeOS_procUpdateStats(os, pcb, WAITING_TIME); 
 
 #ifdef _SBS_DEBUG_
@@ -38,7 +50,7 @@ void dispatcher(FakeOS *os, FakePCB *pcb)
  * @param pcb Pointer to the FakePCB structure representing the process.
  * @param quantum The maximum duration of a CPU burst.
  */
-void sched_preemption(FakePCB *pcb, int quantum)
+void sched_preemption(FakePCB *pcb, SimTime quantum)
 {
     assert(pcb->events.first);
     ProcessEvent *event = (ProcessEvent *)pcb->events.first;
@@ -47,9 +59,10 @@ void sched_preemption(FakePCB *pcb, int quantum)
     if (event->duration > quantum) 
     {
         // Create a new CPU burst event for the remaining duration
-        ProcessEvent *newEvent = (ProcessEvent *)malloc(sizeof(ProcessEvent));
+        ProcessEvent *newEvent = (ProcessEvent *)MemStats_alloc(MEM_EVENT, sizeof(ProcessEvent));
         if (!newEvent)
             assert(0 && "malloc failed creating new CPU burst event");
+        MemStats_count(MEM_SLICE, sizeof(ProcessEvent));
         newEvent->list.prev = newEvent->list.next = 0;
         newEvent->type = CPU;
         // Set the duration of the new CPU burst event to the quantum
@@ -65,28 +78,36 @@ void sched_preemption(FakePCB *pcb, int quantum)
 }
 
 /**
- * @brief Comparison function to sort processes by the duration of their next CPU burst.
+ * @brief Ready set of the single queue schedulers: a single level.
  *
- * @param a First list item to compare.
- * @param b Second list item to compare.
- * @return int Negative if a < b, zero if a == b, positive if a > b.
+ * @param args_ The arguments of the scheduler.
+ * @param levels Array to fill.
+ * @return int 1
  */
-int cmp(ListItem *a, ListItem *b)
+int sched_levels(void *args_, ListHead **levels)
 {
-	FakePCB *procA = (FakePCB *)a;
-	FakePCB *procB = (FakePCB *)b;
-
-	// Ensure both processes have events
-	assert(procA->events.first);
-	assert(procB->events.first);
-
-	ProcessEvent *eventA = (ProcessEvent *)procA->events.first;
-	ProcessEvent *eventB = (ProcessEvent *)procB->events.first;
+	levels[0] = (ListHead *)args_;
+	return 1;
+}
 
-	// Ensure both events are CPU events
-	assert(eventA->type == CPU);
-	assert(eventB->type == CPU);
+/**
+ * @brief Print the ready list of the single queue schedulers.
+ *
+ * @param args_ The arguments of the scheduler.
+ * @param os The fake OS instance.
+ */
+void sched_printQueue(void *args_, FakeOS *os)
+{
+	ListItem *aux = ((ListHead *)args_)->first;
 
-	return eventA->duration - eventB->duration;
+	printf(ANSI_BLUE "\nREADY QUEUE:\n" ANSI_RESET);
+	while (aux)
+	{
+		FakePCB *pcb = (FakePCB *)aux;
+		ProcessEvent *e = (ProcessEvent *)pcb->events.first;
+		assert(e->type == CPU);
+		printf(ANSI_BLUE "\tPID: %2d - CPU_burst: %3lld - Priority: %-8s\n" ANSI_RESET, 
+			pcb->pid, (long long)e->duration, print_priority(pcb->priority));
+		aux = aux->next;
+	}
 }
-
@@ -0,0 +1,309 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <sched.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "../include/fake_os.h"
+#include "../include/telemetry.h"
+
+_Static_assert(MAX_READY_LEVELS <= TELEMETRY_LEVELS, "the ready levels don't fit the telemetry segment");
+
+static double secondsBetween(const struct timespec *from, const struct timespec *to)
+{
+	return (to->tv_sec - from->tv_sec) + (to->tv_nsec - from->tv_nsec) / 1e9;
+}
+
+static void latency(TelemetryLatency *l, const LatencyHist *h)
+{
+	l->mean = LatencyHist_mean(h);
+	l->p50 = LatencyHist_percentile(h, 50);
+	l->p90 = LatencyHist_percentile(h, 90);
+	l->p99 = LatencyHist_percentile(h, 99);
+	l->max = h->count ? h->max : 0;
+}
+
+/**
+ * @brief Fill a snapshot with the state of the simulation
+ *
+ * @param t
+ * @param os
+ * @param snap
+ * @param now wall time of the snapshot
+ */
+static void Telemetry_snapshot(Telemetry *t, FakeOS *os, TelemetrySnapshot *snap, const struct timespec *now)
+{
+	int levels[MAX_READY_LEVELS];
+
+	memset(snap, 0, sizeof(*snap));
+	snap->pid = getpid();
+	snprintf(snap->scheduler, sizeof(snap->scheduler), "%s", print_scheduler(os->scheduler));
+	snprintf(snap->unit, sizeof(snap->unit), "%s", Timebase_unit(os->ticks_per_ms));
+	snap->timer = os->timer;
+	snap->ticks_per_ms = os->ticks_per_ms;
+	snap->cores = os->cores;
+	for (unsigned int i = 0; i < os->cores; i++)
+		snap->running += os->running[i] != NULL;
+	snap->waiting = os->waiting.size;
+	snap->num_levels = FakeOS_readyLevels(os, levels);
+	for (int i = 0; i < snap->num_levels; i++)
+		snap->ready[i] = levels[i];
+	snap->created = os->next_pid - 1;
+	snap->completed = os->stats.completed;
+	snap->cpu_used = os->timer ? (double)os->cpu_busy_time / ((double)os->timer * os->cores) * 100.0 : 0.0;
+	snap->wall_seconds = secondsBetween(&t->start, now);
+	snap->sim_ms_per_sec = t->rate;
+	latency(&snap->turnaround, &os->stats.turnaround);
+	latency(&snap->waiting_time, &os->stats.waiting);
+	latency(&snap->response, &os->stats.response);
+	snap->publications = t->publications;
+}
+
+/**
+ * @brief Create the publisher and its shared memory segment, with a first publication
+ *
+ * @param name of the segment, e.g. /disastros; NULL for the snapshots on demand only
+ * @param os
+ * @return Telemetry* NULL if the segment can't be created
+ */
+Telemetry *Telemetry_open(const char *name, FakeOS *os)
+{
+	Telemetry *t;
+	int fd;
+
+	if (!(t = (Telemetry *)calloc(1, sizeof(Telemetry))))
+		assert(0 && "calloc failed");
+	clock_gettime(CLOCK_MONOTONIC, &t->start);
+	t->last = t->start;
+	t->last_timer = os->timer;
+	if (!name)
+		return t;
+
+	if ((fd = shm_open(name, O_CREAT | O_RDWR, 0644)) < 0)
+	{
+		free(t);
+		return NULL;
+	}
+	if (ftruncate(fd, sizeof(TelemetryPage)) < 0 ||
+		(t->page = (TelemetryPage *)mmap(NULL, sizeof(TelemetryPage), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)) == MAP_FAILED)
+	{
+		close(fd);
+		shm_unlink(name);
+		free(t);
+		return NULL;
+	}
+	close(fd);
+	if (!(t->name = strdup(name)))
+		assert(0 && "strdup failed");
+
+	// a reader that finds the magic finds a whole header
+	t->page->seq = 0;
+	t->page->version = TELEMETRY_VERSION;
+	t->page->size = sizeof(TelemetryPage);
+	__atomic_store_n(&t->page->magic, TELEMETRY_MAGIC, __ATOMIC_RELEASE);
+	Telemetry_publish(t, os);
+	return t;
+}
+
+/**
+ * @brief Publish if TELEMETRY_PERIOD_MS of wall time passed since the last publication
+ *
+ * @param t
+ * @param os
+ */
+void Telemetry_tick(Telemetry *t, FakeOS *os)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	if (secondsBetween(&t->last, &now) * 1000.0 >= TELEMETRY_PERIOD_MS)
+		Telemetry_publish(t, os);
+}
+
+/**
+ * @brief Write a snapshot in the segment. It is built outside of the write section,
+ *        which is a copy of the snapshot
+ *
+ * @param t
+ * @param os
+ */
+void Telemetry_publish(Telemetry *t, FakeOS *os)
+{
+	TelemetrySnapshot snap;
+	struct timespec now;
+	double seconds;
+	uint32_t seq;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	if ((seconds = secondsBetween(&t->last, &now)) > 0)
+		t->rate = (double)(os->timer - t->last_timer) / os->ticks_per_ms / seconds;
+	t->last = now;
+	t->last_timer = os->timer;
+	t->publications++;
+	if (!t->page)
+		return;
+
+	Telemetry_snapshot(t, os, &snap, &now);
+	seq = t->page->seq;
+	__atomic_store_n(&t->page->seq, seq + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	memcpy(&t->page->snap, &snap, sizeof(snap));
+	__atomic_store_n(&t->page->seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Print a snapshot of the simulation now (SIGUSR1), the rate is the one of the last period
+ *
+ * @param t
+ * @param os
+ * @param out
+ */
+void Telemetry_dump(Telemetry *t, FakeOS *os, FILE *out)
+{
+	TelemetrySnapshot snap;
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	// without a segment there are no periods, the rate is the one since the start
+	if (!t->page && secondsBetween(&t->start, &now) > 0)
+		t->rate = (double)os->timer / os->ticks_per_ms / secondsBetween(&t->start, &now);
+	Telemetry_snapshot(t, os, &snap, &now);
+	Telemetry_print(&snap, out);
+	fflush(out);
+}
+
+/**
+ * @brief Publish the final state, marked as finished, and remove the segment.
+ *        The readers still attached keep their mapping
+ *
+ * @param t
+ * @param os
+ */
+void Telemetry_close(Telemetry *t, FakeOS *os)
+{
+	if (!t)
+		return;
+	if (t->page)
+	{
+		Telemetry_publish(t, os);
+		__atomic_store_n(&t->page->snap.finished, 1, __ATOMIC_RELEASE);
+		munmap(t->page, sizeof(TelemetryPage));
+		shm_unlink(t->name);
+	}
+	free(t->name);
+	free(t);
+}
+
+/**
+ * @brief Map the segment of a simulator, read only
+ *
+ * @param name
+ * @return const TelemetryPage* NULL if there is none or it is of another version
+ */
+const TelemetryPage *Telemetry_attach(const char *name)
+{
+	TelemetryPage *page;
+	struct stat st;
+	int fd;
+
+	if ((fd = shm_open(name, O_RDONLY, 0)) < 0)
+		return NULL;
+	if (fstat(fd, &st) < 0 || st.st_size < (off_t)sizeof(TelemetryPage) ||
+		(page = (TelemetryPage *)mmap(NULL, sizeof(TelemetryPage), PROT_READ, MAP_SHARED, fd, 0)) == MAP_FAILED)
+	{
+		close(fd);
+		return NULL;
+	}
+	close(fd);
+	if (__atomic_load_n(&page->magic, __ATOMIC_ACQUIRE) != TELEMETRY_MAGIC || page->version != TELEMETRY_VERSION ||
+		page->size != sizeof(TelemetryPage))
+	{
+		munmap(page, sizeof(TelemetryPage));
+		return NULL;
+	}
+	return page;
+}
+
+/**
+ * @brief Copy the last snapshot published, retrying while the simulator writes it
+ *
+ * @param page
+ * @param snap
+ * @return int 0, -1 if no whole copy was read in TELEMETRY_READ_TRIES tries
+ */
+int Telemetry_read(const TelemetryPage *page, TelemetrySnapshot *snap)
+{
+	for (int i = 0; i < TELEMETRY_READ_TRIES; i++)
+	{
+		uint32_t seq = __atomic_load_n(&page->seq, __ATOMIC_ACQUIRE);
+
+		if (!(seq & 1))
+		{
+			memcpy(snap, (const void *)&page->snap, sizeof(*snap));
+			__atomic_thread_fence(__ATOMIC_ACQUIRE);
+			if (__atomic_load_n(&page->seq, __ATOMIC_RELAXED) == seq)
+				return 0;
+		}
+		sched_yield();
+	}
+	return -1;
+}
+
+void Telemetry_detach(const TelemetryPage *page)
+{
+	munmap((void *)page, sizeof(TelemetryPage));
+}
+
+static void printLatency(const char *name, const TelemetryLatency *l, FILE *out)
+{
+	fprintf(out, "  %-12s %12.1f %10lu %10lu %10lu %10lu\n", name, l->mean, (unsigned long)l->p50,
+			(unsigned long)l->p90, (unsigned long)l->p99, (unsigned long)l->max);
+}
+
+/**
+ * @brief Print a snapshot in full
+ *
+ * @param snap
+ * @param out
+ */
+void Telemetry_print(const TelemetrySnapshot *snap, FILE *out)
+{
+	fprintf(out, "\n------------------------------------TELEMETRY------------------------------------\n");
+	fprintf(out, "pid %d, %s on %u cores%s\n", snap->pid, snap->scheduler, snap->cores, snap->finished ? ", finished" : "");
+	fprintf(out, "time: %lld %s, %.1f s of wall time, %.1f simulated ms/s\n", (long long)snap->timer, snap->unit,
+			snap->wall_seconds, snap->sim_ms_per_sec);
+	fprintf(out, "processes: %lu arrived, %lu completed, %u running, %u waiting, ready", (unsigned long)snap->created,
+			(unsigned long)snap->completed, snap->running, snap->waiting);
+	for (int i = 0; i < snap->num_levels && i < TELEMETRY_LEVELS; i++)
+		fprintf(out, " %u", snap->ready[i]);
+	fprintf(out, "\ncpu used: %.2f%%\n", snap->cpu_used);
+	fprintf(out, "  %-12s %9s[%s] %10s %10s %10s %10s\n", "", "mean", snap->unit, "p50", "p90", "p99", "max");
+	printLatency("turnaround", &snap->turnaround, out);
+	printLatency("waiting", &snap->waiting_time, out);
+	printLatency("response", &snap->response, out);
+}
+
+/**
+ * @brief Print a snapshot as a row of a stream
+ *
+ * @param snap
+ * @param out
+ * @param header print the names of the columns first
+ */
+void Telemetry_printRow(const TelemetrySnapshot *snap, FILE *out, int header)
+{
+	unsigned int ready = 0;
+
+	if (header)
+		fprintf(out, "%14s %10s %8s %8s %8s %10s %12s %10s\n", "time", "sim ms/s", "running", "ready", "waiting",
+				"completed", "resp mean", "resp p99");
+	for (int i = 0; i < snap->num_levels && i < TELEMETRY_LEVELS; i++)
+		ready += snap->ready[i];
+	fprintf(out, "%14lld %10.1f %8u %8u %8u %10lu %12.1f %10lu\n", (long long)snap->timer, snap->sim_ms_per_sec,
+			snap->running, ready, snap->waiting, (unsigned long)snap->completed, snap->response.mean,
+			(unsigned long)snap->response.p99);
+}
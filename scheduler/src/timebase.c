@@ -0,0 +1,95 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "../include/timebase.h"
+
+// the units of the tick, the coarsest first
+static const struct
+{
+	const char *unit;
+	SimTime ticks_per_ms;
+} timebases[] = {{"ms", 1}, {"us", 1000}, {"ns", NS_PER_MS}};
+
+#define NUM_TIMEBASES (int)(sizeof(timebases) / sizeof(timebases[0]))
+
+/**
+ * @brief Ticks in a ms of a timebase
+ *
+ * @param unit ms, us or ns
+ * @return int the ticks, -1 if the unit is unknown
+ */
+int Timebase_ticksPerMs(const char *unit)
+{
+	for (int i = 0; i < NUM_TIMEBASES; i++)
+		if (!strcmp(unit, timebases[i].unit))
+			return timebases[i].ticks_per_ms;
+	return -1;
+}
+
+/**
+ * @brief Name of the unit of a timebase, as printed next to the times
+ *
+ * @param ticks_per_ms
+ * @return const char*
+ */
+const char *Timebase_unit(SimTime ticks_per_ms)
+{
+	for (int i = 0; i < NUM_TIMEBASES; i++)
+		if (timebases[i].ticks_per_ms == ticks_per_ms)
+			return timebases[i].unit;
+	return "ticks";
+}
+
+/**
+ * @brief A time of the traces in ticks, rounded to the nearest one. A time that isn't zero
+ *        is at least a tick, a burst shorter than the tick still takes a step
+ *
+ * @param ticks_per_ms
+ * @param ns
+ * @return SimTime
+ */
+SimTime Timebase_fromNs(SimTime ticks_per_ms, int64_t ns)
+{
+	SimTime tick_ns = NS_PER_MS / ticks_per_ms;
+	SimTime ticks = (ns + tick_ns / 2) / tick_ns;
+
+	return (ns > 0 && ticks == 0) ? 1 : ticks;
+}
+
+/**
+ * @brief Parse a time of the options, a number with an optional unit (ns, us, ms or s), in ms
+ *        without the unit, e.g. 10 or 250us
+ *
+ * @param ticks_per_ms
+ * @param str
+ * @param ticks set to the time in ticks
+ * @return int 0, -1 if str is not a time
+ */
+int Timebase_parse(SimTime ticks_per_ms, const char *str, SimTime *ticks)
+{
+	char *end;
+	int64_t ns = TraceTime_parse(str, &end);
+
+	while (ns >= 0 && isspace((unsigned char)*end))
+		end++;
+	if (ns < 0 || *end)
+		return -1;
+	*ticks = Timebase_fromNs(ticks_per_ms, ns);
+	return 0;
+}
+
+/**
+ * @brief Write a time in ticks as the options take it, e.g. 10 for 10 ms or 250us
+ *
+ * @param buf
+ * @param size
+ * @param ticks_per_ms
+ * @param ticks
+ * @return int the length of the text, as snprintf
+ */
+int Timebase_format(char *buf, int size, SimTime ticks_per_ms, SimTime ticks)
+{
+	return TraceTime_format(buf, size, ticks * (NS_PER_MS / ticks_per_ms));
+}
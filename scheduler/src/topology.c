@@ -0,0 +1,268 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#include "../include/fake_os.h"
+#include "../include/topology.h"
+
+/**
+ * @brief Create the topology from a spec <sockets>x<nodes per socket>x<cores per node>[x<smt>]
+ *        [:<penalty>[:<balance period>]], e.g. 2x1x8x2 or 2x2x4:1.8:50 or 2x2x4:1.8:500us: the
+ *        period is in ms or takes a unit, as the times of the options
+ *
+ * @param spec
+ * @param cores number of cores of the OS, the logical ones
+ * @param ticks_per_ms timebase of the simulation
+ * @return Topology* NULL if the spec is not valid or doesn't have as many cores
+ */
+Topology *Topology_create(const char *spec, int cores, SimTime ticks_per_ms)
+{
+	Topology *topo;
+	int sockets, nodes_per_socket, cores_per_node, smt = 1;
+	SimTime balance_period = TOPO_BALANCE_PERIOD * ticks_per_ms;
+	double penalty = TOPO_PENALTY;
+	int len;
+
+	if (sscanf(spec, "%dx%dx%d%n", &sockets, &nodes_per_socket, &cores_per_node, &len) != 3)
+		return NULL;
+	spec += len;
+	if (*spec == 'x' && sscanf(spec, "x%d%n", &smt, &len) == 1)
+		spec += len;
+	if (*spec == ':' && sscanf(spec, ":%lf%n", &penalty, &len) == 1)
+		spec += len;
+	if (*spec == ':')
+	{
+		if (Timebase_parse(ticks_per_ms, spec + 1, &balance_period) < 0)
+			return NULL;
+		spec += strlen(spec);
+	}
+	if (*spec || sockets < 1 || nodes_per_socket < 1 || cores_per_node < 1 || smt < 1 ||
+		sockets * nodes_per_socket > MAX_NODES || sockets * nodes_per_socket * cores_per_node * smt != cores ||
+		penalty < 1 || balance_period < 0)
+		return NULL;
+
+	if (!(topo = (Topology *)calloc(1, sizeof(Topology))))
+		assert(0 && "calloc failed");
+	topo->sockets = sockets;
+	topo->nodes_per_socket = nodes_per_socket;
+	topo->cores_per_node = cores_per_node;
+	topo->smt = smt;
+	topo->nodes = sockets * nodes_per_socket;
+	topo->penalty = penalty;
+	topo->balance_period = balance_period;
+	topo->next_balance = balance_period;
+	return topo;
+}
+
+/**
+ * @brief Distance of a node from the home node of a process
+ *
+ * @param topo
+ * @param home -1 if the process has none yet
+ * @param node
+ * @return int 0 at home, 1 on another node of the socket, 2 on another socket
+ */
+static int distance(const Topology *topo, int home, int node)
+{
+	if (home < 0 || home == node)
+		return 0;
+	return home / topo->nodes_per_socket == node / topo->nodes_per_socket ? 1 : 2;
+}
+
+/**
+ * @brief Whether an SMT sibling of the core runs a process
+ *
+ * @param topo
+ * @param os
+ * @param core
+ * @return int
+ */
+static int siblingBusy(const Topology *topo, const FakeOS *os, int core)
+{
+	int first = core - core % topo->smt;
+
+	for (int i = first; i < first + topo->smt; i++)
+		if (i != core && os->running[i])
+			return 1;
+	return 0;
+}
+
+/**
+ * @brief Choose the idle core of a process being dispatched, and its home node on its first run
+ *
+ * @param topo
+ * @param os
+ * @param pcb
+ * @return int the core
+ */
+int Topology_place(Topology *topo, FakeOS *os, FakePCB *pcb)
+{
+	int idle[MAX_NODES] = {0};
+	int best = -1, best_score = 0;
+
+	for (int i = 0; i < os->cores; i++)
+		if (!os->running[i])
+			idle[Topology_node(topo, i)]++;
+
+	for (int i = 0; i < os->cores && !(topo->flat && best >= 0); i++)
+	{
+		int node = Topology_node(topo, i);
+		int score;
+
+		if (os->running[i])
+			continue;
+		// a known home wins over the siblings, a new process spreads on the idlest node
+		if (pcb->home_node >= 0)
+			score = distance(topo, pcb->home_node, node) * 2 + siblingBusy(topo, os, i);
+		else
+			score = siblingBusy(topo, os, i) * (os->cores + 1) - idle[node];
+		if (best < 0 || score < best_score)
+		{
+			best = i;
+			best_score = score;
+		}
+	}
+	assert(best >= 0 && "dispatch without an idle core");
+
+	// away from home: a process running on the home node whose home is here swaps with it,
+	// it moves to the idle core and both run at home
+	if (!topo->flat && distance(topo, pcb->home_node, Topology_node(topo, best)))
+	{
+		int per_node = topo->cores_per_node * topo->smt;
+		for (int j = pcb->home_node * per_node; j < (pcb->home_node + 1) * per_node; j++)
+		{
+			if (os->running[j]->home_node != Topology_node(topo, best))
+				continue;
+			OS_LOG(os, ANSI_ORANGE "\t[>] PID: %2d back home from Core: %2d to Core: %2d\n" ANSI_RESET, os->running[j]->pid, j, best);
+			os->running[best] = os->running[j];
+			os->running[j] = 0;
+			os->running[best]->remote_passes = 0;
+			topo->migrations++;
+			best = j;
+			break;
+		}
+	}
+
+	if (pcb->home_node < 0)
+		pcb->home_node = Topology_node(topo, best);
+	return best;
+}
+
+/**
+ * @brief NUMA balancing: the processes running away from home move to an idle core of their
+ *        home node, or swap with a process running there whose home is their node; the ones
+ *        that can't, move their memory after TOPO_MEMORY_PASSES passes
+ *
+ * @param topo
+ * @param os
+ */
+static void Topology_balance(Topology *topo, FakeOS *os)
+{
+	int per_node = topo->cores_per_node * topo->smt;
+
+	for (int i = 0; i < os->cores; i++)
+	{
+		FakePCB *pcb = os->running[i];
+		int node = Topology_node(topo, i);
+		int to = -1;
+
+		if (!pcb || pcb->home_node < 0 || pcb->home_node == node)
+		{
+			if (pcb)
+				pcb->remote_passes = 0;
+			continue;
+		}
+
+		for (int j = pcb->home_node * per_node; j < (pcb->home_node + 1) * per_node; j++)
+			if (!os->running[j] && (to < 0 || siblingBusy(topo, os, j) < siblingBusy(topo, os, to)))
+				to = j;
+		if (to < 0)
+			for (int j = pcb->home_node * per_node; j < (pcb->home_node + 1) * per_node && to < 0; j++)
+				if (os->running[j]->home_node == node)
+					to = j;
+
+		if (to >= 0)
+		{
+			OS_LOG(os, ANSI_ORANGE "\t[>] PID: %2d back home from Core: %2d to Core: %2d\n" ANSI_RESET, pcb->pid, i, to);
+			os->running[i] = os->running[to];
+			os->running[to] = pcb;
+			pcb->remote_passes = 0;
+			topo->migrations += os->running[i] ? 2 : 1;
+		}
+		else if (++pcb->remote_passes >= TOPO_MEMORY_PASSES)
+		{
+			pcb->home_node = node;
+			pcb->remote_passes = 0;
+			topo->memory_migrations++;
+		}
+	}
+}
+
+/**
+ * @brief Once per step after scheduling: the balancing pass when it is due, then the speed of
+ *        every core for the process it runs in this tick
+ *
+ * @param topo
+ * @param os with a CoreCapacity, the slowdown is applied to its cores
+ */
+void Topology_tick(Topology *topo, FakeOS *os)
+{
+	if (topo->balance_period && os->timer >= topo->next_balance)
+	{
+		Topology_balance(topo, os);
+		topo->next_balance += topo->balance_period;
+	}
+
+	for (int i = 0; i < os->cores; i++)
+	{
+		FakePCB *pcb = os->running[i];
+		double *scale = &os->capacity->scale[i];
+		int node = Topology_node(topo, i);
+		int d;
+
+		if (!pcb)
+		{
+			*scale = 1.0;
+			continue;
+		}
+		d = distance(topo, pcb->home_node, node);
+		*scale = d == 0 ? 1.0 : d == 1 ? 2.0 / (1.0 + topo->penalty) : 1.0 / topo->penalty;
+		if (siblingBusy(topo, os, i))
+			*scale *= TOPO_SMT_SHARE;
+		if (d)
+			topo->remote_ticks[node]++;
+		else
+			topo->local_ticks[node]++;
+	}
+}
+
+/**
+ * @brief Print the utilization and the share of local time of every node
+ *
+ * @param topo
+ * @param os
+ */
+void Topology_print(const Topology *topo, const FakeOS *os)
+{
+	int per_node = topo->cores_per_node * topo->smt;
+	SimTime local = 0, remote = 0;
+
+	printf(ANSI_CYAN "\n%-14s %9s %9s %9s %9s\n" ANSI_RESET, "NUMA nodes:", "socket", "cores", "used", "local");
+	for (int n = 0; n < topo->nodes; n++)
+	{
+		SimTime busy = 0;
+
+		for (int i = n * per_node; i < (n + 1) * per_node; i++)
+			busy += os->core_busy_time[i];
+		local += topo->local_ticks[n];
+		remote += topo->remote_ticks[n];
+		printf(ANSI_CYAN "  node %-7d %9d %9d %8.2f%% %8.2f%%\n" ANSI_RESET, n, n / topo->nodes_per_socket, per_node,
+			   (double)busy / ((double)os->timer * per_node) * 100.0,
+			   topo->local_ticks[n] + topo->remote_ticks[n] ? topo->local_ticks[n] * 100.0 / (topo->local_ticks[n] + topo->remote_ticks[n]) : 100.0);
+	}
+	printf(ANSI_CYAN "NUMA: \t\t\t\t[%dx%dx%dx%d] penalty %.2f, local %.2f%%, %s placement, migrations %u, memory migrations %u\n" ANSI_RESET,
+		   topo->sockets, topo->nodes_per_socket, topo->cores_per_node, topo->smt, topo->penalty,
+		   local + remote ? local * 100.0 / (local + remote) : 100.0, topo->flat ? "flat" : "node aware",
+		   topo->migrations, topo->memory_migrations);
+}
@@ -0,0 +1,101 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <unistd.h>
+
+#include "../include/fake_os.h"
+#include "../include/checkpoint.h"
+
+#define TEST_PROCS 300
+#define TEST_BURSTS 6
+#define TEST_SEED 11
+#define TEST_CHECKPOINT "checkpoint_test.ckpt"
+
+static void startRun(FakeOS *os, const char *histogram_folder, SchedulerType scheduler)
+{
+    FakeOS_init(os, 2);
+    FakeOS_setScheduler(os, scheduler, 15);
+    os->verbose = 0;
+    os->stream = TraceStream_open(histogram_folder, TEST_PROCS, TEST_BURSTS, TEST_SEED, 40);
+}
+
+static void assertSameHist(const LatencyHist *a, const LatencyHist *b)
+{
+    assert(a->count == b->count && a->sum == b->sum && a->min == b->min && a->max == b->max);
+    assert(memcmp(a->buckets, b->buckets, LHIST_BUCKETS * sizeof(uint64_t)) == 0);
+}
+
+// Funzione di test per verificare che una simulazione ripresa da un checkpoint finisca come quella ininterrotta
+void test_checkpointRestore(const char *histogram_folder, SchedulerType scheduler) {
+    FakeOS full, first, resumed;
+
+    startRun(&full, histogram_folder, scheduler);
+    while (!FakeOS_finished(&full))
+        FakeOS_simStep(&full);
+
+    // interrompe a metà, salva e riprende in un nuovo OS
+    startRun(&first, histogram_folder, scheduler);
+    while (!FakeOS_finished(&first) && first.timer < full.timer / 2)
+        FakeOS_simStep(&first);
+    assert(Checkpoint_save(&first, TEST_CHECKPOINT) == 0);
+
+    assert(Checkpoint_restore(&resumed, TEST_CHECKPOINT) == 0);
+    resumed.verbose = 0;
+    assert(resumed.timer == first.timer && resumed.stats.completed == first.stats.completed);
+    while (!FakeOS_finished(&resumed))
+        FakeOS_simStep(&resumed);
+
+    assert(resumed.timer == full.timer);
+    assert(resumed.stats.completed == full.stats.completed);
+    assert(resumed.cpu_busy_time == full.cpu_busy_time);
+    assertSameHist(&resumed.stats.turnaround, &full.stats.turnaround);
+    assertSameHist(&resumed.stats.waiting, &full.stats.waiting);
+    assertSameHist(&resumed.stats.response, &full.stats.response);
+    for (int i = 0; i < MAX_PRIORITY; i++)
+        assertSameHist(&resumed.acct.priority[i].response, &full.acct.priority[i].response);
+
+    printf("%-24s checkpoint at %6lld, end at %6lld\n", print_scheduler(scheduler), (long long)first.timer, (long long)resumed.timer);
+
+    FakeOS_destroy(&full);
+    FakeOS_destroy(&first);
+    FakeOS_destroy(&resumed);
+    unlink(TEST_CHECKPOINT);
+}
+
+// Funzione di test per verificare che un file di un'altra versione venga rifiutato
+void test_checkpointVersion(const char *histogram_folder) {
+    FakeOS os, restored;
+    FILE *f;
+    unsigned int version = CHECKPOINT_VERSION + 1;
+
+    startRun(&os, histogram_folder, RR);
+    FakeOS_simStep(&os);
+    assert(Checkpoint_save(&os, TEST_CHECKPOINT) == 0);
+
+    f = fopen(TEST_CHECKPOINT, "r+b");
+    assert(f);
+    fseek(f, 8, SEEK_SET);
+    fwrite(&version, sizeof(version), 1, f);
+    fclose(f);
+
+    assert(Checkpoint_restore(&restored, TEST_CHECKPOINT) < 0);
+
+    FakeOS_destroy(&os);
+    unlink(TEST_CHECKPOINT);
+}
+
+int main(int argc, char **argv) {
+    if (argc != 2)
+    {
+        printf("Usage: %s <path_of_histogram_folder>\n", argv[0]);
+        return 1;
+    }
+
+    for (int s = 0; s < MAX_SCHEDULERS; s++)
+        test_checkpointRestore(argv[1], s);
+    test_checkpointVersion(argv[1]);
+
+    printf("All tests passed!\n");
+    return 0;
+}
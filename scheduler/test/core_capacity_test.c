@@ -0,0 +1,131 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+
+#include "../include/fake_os.h"
+#include "../include/core_capacity.h"
+
+// Funzione di test per verificare il parsing delle velocita' e le classi dei core
+void test_create(void) {
+    CoreCapacity *cap = CoreCapacity_create("1,2x2.5,0.5", 4);
+
+    assert(cap);
+    assert(cap->num_classes == 3);
+    assert(cap->class_speed[0] == 2.5 && cap->class_speed[1] == 1 && cap->class_speed[2] == 0.5);
+    assert(cap->cls[0] == 1 && cap->cls[1] == 0 && cap->cls[2] == 0 && cap->cls[3] == 2);
+    CoreCapacity_destroy(cap);
+
+    // una velocita' per core, positiva
+    assert(!CoreCapacity_create("2x2", 4));
+    assert(!CoreCapacity_create("1,1,1,1,1", 4));
+    assert(!CoreCapacity_create("1,0,1,1", 4));
+    assert(!CoreCapacity_create("1,fast,1,1", 4));
+    assert(!CoreCapacity_create("1,2,3,4,5,6,7,8,9", 9));
+}
+
+// Funzione di test per verificare le unita' di burst eseguite per ms, con le frazioni riportate
+void test_retire(void) {
+    CoreCapacity *cap = CoreCapacity_create("1.5,0.5", 2);
+    int fast = 0, slow = 0;
+
+    for (int i = 0; i < 10; i++) {
+        fast += CoreCapacity_retire(cap, 0, 1000);
+        slow += CoreCapacity_retire(cap, 1, 1000);
+    }
+    assert(fast == 15 && slow == 5);
+    // il burst finisce prima della fine del ms
+    assert(CoreCapacity_retire(cap, 0, 1) == 1);
+    assert(cap->work[0] == 16);
+    CoreCapacity_destroy(cap);
+}
+
+static void setBurst(FakePCB *pcb, ProcessEvent *e, int duration) {
+    List_init(&pcb->events);
+    e->list.prev = e->list.next = 0;
+    e->type = CPU;
+    e->duration = duration;
+    List_pushBack(&pcb->events, (ListItem *)e);
+}
+
+// Funzione di test per verificare il piazzamento: i burst lunghi sul core veloce, i corti sul lento
+void test_place(void) {
+    FakeOS os;
+    FakePCB heavy, light;
+    ProcessEvent e_heavy, e_light;
+
+    FakeOS_init(&os, 2);
+    FakeOS_setScheduler(&os, RR, 10);
+    os.verbose = 0;
+    os.capacity = CoreCapacity_create("1,2", 2);
+    setBurst(&heavy, &e_heavy, 100);
+    setBurst(&light, &e_light, 10);
+
+    // il primo burst fissa la soglia
+    assert(CoreCapacity_place(os.capacity, &os, &heavy) == 1);
+    CoreCapacity_observe(os.capacity, &heavy);
+    assert(os.capacity->threshold == 100);
+    assert(CoreCapacity_place(os.capacity, &os, &light) == 0);
+    assert(CoreCapacity_place(os.capacity, &os, &heavy) == 1);
+
+    // il processo pesante sul core lento sale sul core veloce libero
+    os.running[0] = &heavy;
+    CoreCapacity_migrate(os.capacity, &os);
+    assert(os.running[1] == &heavy && !os.running[0] && os.capacity->upmigrations == 1);
+
+    // quello leggero sul core veloce resta, nessun processo pesante e' pronto
+    os.running[1] = &light;
+    CoreCapacity_migrate(os.capacity, &os);
+    assert(os.running[1] == &light && os.capacity->downmigrations == 0);
+
+    os.running[1] = 0;
+    FakeOS_destroy(&os);
+}
+
+// Funzione di test per verificare la soglia e le migrazioni con una topologia: restano nel nodo
+void test_topology(void) {
+    FakeOS os;
+    FakePCB heavy = {.pid = 1, .source = -1, .home_node = 1}, light = {.pid = 2, .source = -1, .home_node = 1};
+    ProcessEvent e_heavy, e_light;
+
+    FakeOS_init(&os, 4);
+    FakeOS_setScheduler(&os, RR, 10);
+    os.verbose = 0;
+    os.capacity = CoreCapacity_create("2,1,2,1", 4);
+    assert(FakeOS_setTopology(&os, "1x2x2:1.5:50") == 0);
+    setBurst(&heavy, &e_heavy, 100);
+    setBurst(&light, &e_light, 10);
+    heavy.id = PCBTable_alloc(&os.pcbs);
+
+    // il dispatcher piazza per nodo, il burst aggiorna comunque la soglia
+    os.running[2] = &light;
+    dispatcher(&os, &heavy);
+    assert(os.running[3] == &heavy && os.capacity->threshold == 100);
+
+    // il core veloce libero e' sull'altro nodo: il processo pesante resta dov'e'
+    os.running[2] = 0;
+    os.running[3] = 0;
+    os.running[0] = &light;
+    os.running[1] = &heavy;
+    CoreCapacity_migrate(os.capacity, &os);
+    assert(os.running[1] == &heavy && !os.running[2] && os.capacity->upmigrations == 0);
+
+    // sul suo nodo sale sul core veloce
+    os.running[0] = 0;
+    os.running[1] = 0;
+    os.running[3] = &heavy;
+    CoreCapacity_migrate(os.capacity, &os);
+    assert(os.running[2] == &heavy && !os.running[3] && os.capacity->upmigrations == 1);
+
+    os.running[2] = 0;
+    FakeOS_destroy(&os);
+}
+
+int main(int argc, char **argv) {
+    test_create();
+    test_retire();
+    test_place();
+    test_topology();
+
+    printf("core capacity tests passed\n");
+    return 0;
+}
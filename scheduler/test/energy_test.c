@@ -0,0 +1,89 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <assert.h>
+
+#include "../include/fake_os.h"
+#include "../include/energy.h"
+
+// Simula n ms del core 0, occupato o libero
+static void run(FakeOS *os, FakePCB *pcb, int busy, int n) {
+    os->running[0] = busy ? pcb : 0;
+    for (int i = 0; i < n; i++) {
+        Energy_tick(os->energy, os);
+        os->timer++;
+    }
+}
+
+static void init(FakeOS *os, const char *governor) {
+    FakeOS_init(os, 1);
+    FakeOS_setScheduler(os, RR, 10);
+    os->verbose = 0;
+    assert(FakeOS_setEnergy(os, governor) == 0);
+    assert(os->capacity && os->capacity->freq[0] == 1.0);
+}
+
+// Funzione di test per verificare l'energia di un core sempre occupato alla frequenza massima
+void test_busy(void) {
+    FakeOS os;
+    FakePCB pcb;
+
+    init(&os, "performance");
+    run(&os, &pcb, 1, 1000);
+    assert(fabs(Energy_joules(os.energy) - 3.0) < 1e-9);
+    assert(os.energy->core[0].pstate == 0);
+    os.running[0] = 0;
+    FakeOS_destroy(&os);
+
+    assert(!Energy_create("turbo", 1, TIMEBASE_MS));
+}
+
+// Funzione di test per verificare che schedutil scenda alla frequenza che basta all'utilizzo
+void test_schedutil(void) {
+    FakeOS os;
+    FakePCB pcb;
+
+    init(&os, "schedutil");
+    // 3 ms su 10: con il margine basta il 37.5% della frequenza
+    run(&os, &pcb, 1, 3);
+    run(&os, &pcb, 0, EN_GOVERNOR_PERIOD - 3);
+    assert(os.energy->core[0].pstate == MAX_PSTATES - 1);
+    assert(os.capacity->freq[0] < 0.5);
+
+    // a pieno carico torna alla frequenza massima, un passo per periodo
+    run(&os, &pcb, 1, 4 * EN_GOVERNOR_PERIOD);
+    assert(os.energy->core[0].pstate == 0 && os.capacity->freq[0] == 1.0);
+    os.running[0] = 0;
+    FakeOS_destroy(&os);
+}
+
+// Funzione di test per verificare lo stato di idle scelto dalla previsione e il risveglio
+void test_idle(void) {
+    FakeOS os;
+    FakePCB pcb;
+
+    init(&os, "performance");
+    // senza storia il core resta nello stato meno profondo
+    run(&os, &pcb, 0, 100);
+    assert(os.energy->core[0].cstate == 0);
+    run(&os, &pcb, 1, 1);
+    assert(os.energy->core[0].idle_predict == 100 * EN_IDLE_EWMA && os.capacity->stall[0] == 0);
+
+    // un periodo previsto lungo va nello stato piu' profondo, che costa la latenza di uscita
+    run(&os, &pcb, 0, 50);
+    assert(os.energy->core[0].cstate == MAX_CSTATES - 1);
+    run(&os, &pcb, 1, 1);
+    assert(os.capacity->stall[0] > 0 && os.energy->core[0].wakeups == 2);
+    assert(CoreCapacity_retire(os.capacity, 0, 10) == 0);
+    os.running[0] = 0;
+    FakeOS_destroy(&os);
+}
+
+int main(int argc, char **argv) {
+    test_busy();
+    test_schedutil();
+    test_idle();
+
+    printf("energy tests passed\n");
+    return 0;
+}
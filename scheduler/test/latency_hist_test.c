@@ -0,0 +1,73 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+
+#include "../include/latency_hist.h"
+
+static int cmpU64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+// Funzione di test per verificare che i percentili stiano entro l'errore relativo dichiarato
+void test_percentiles(void) {
+    int num_samples = 100000;
+    uint64_t *values = (uint64_t *)malloc(num_samples * sizeof(uint64_t));
+    LatencyHist h;
+
+    LatencyHist_init(&h);
+    for (int i = 0; i < num_samples; i++) {
+        // distribuzione a coda lunga: molti valori piccoli e pochi molto grandi
+        values[i] = (uint64_t)rand() % 100 + ((rand() % 100 == 0) ? (uint64_t)rand() % 1000000 : 0);
+        LatencyHist_record(&h, values[i]);
+    }
+    qsort(values, num_samples, sizeof(uint64_t), cmpU64);
+
+    double percentiles[] = {50, 90, 95, 99, 99.9};
+    for (int i = 0; i < 5; i++) {
+        uint64_t exact = values[(int)(percentiles[i] / 100.0 * num_samples + 0.5) - 1];
+        uint64_t approx = LatencyHist_percentile(&h, percentiles[i]);
+        double error = exact ? (double)llabs((long long)approx - (long long)exact) / exact : approx;
+        printf("p%-5g exact: %8lu approx: %8lu\n", percentiles[i], (unsigned long)exact, (unsigned long)approx);
+        assert(error <= 1.0 / LHIST_SUB_BUCKETS);
+    }
+    assert(h.min == values[0] && h.max == values[num_samples - 1]);
+
+    free(values);
+    LatencyHist_destroy(&h);
+}
+
+// Funzione di test per verificare che il merge equivalga a registrare tutti i valori in un solo istogramma
+void test_merge(void) {
+    LatencyHist a, b, all;
+
+    LatencyHist_init(&a);
+    LatencyHist_init(&b);
+    LatencyHist_init(&all);
+    for (int i = 0; i < 10000; i++) {
+        uint64_t v = (uint64_t)rand() % 50000;
+        LatencyHist_record((i % 2) ? &a : &b, v);
+        LatencyHist_record(&all, v);
+    }
+    LatencyHist_merge(&a, &b);
+
+    assert(a.count == all.count && a.sum == all.sum);
+    assert(a.min == all.min && a.max == all.max);
+    for (int p = 1; p <= 100; p++)
+        assert(LatencyHist_percentile(&a, p) == LatencyHist_percentile(&all, p));
+
+    LatencyHist_destroy(&a);
+    LatencyHist_destroy(&b);
+    LatencyHist_destroy(&all);
+}
+
+int main(int argc, char **argv) {
+    srand(42);
+
+    test_percentiles();
+    test_merge();
+
+    printf("latency histogram tests passed\n");
+    return 0;
+}
@@ -0,0 +1,80 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "../include/fake_os.h"
+#include "../include/mem_stats.h"
+
+// Funzione di test per verificare i contatori di allocazioni, byte vivi e picchi
+void test_counters(void) {
+    MemStats before = mem_stats;
+    void *a = MemStats_alloc(MEM_PROCESS, 100);
+    void *b = MemStats_alloc(MEM_PROCESS, 50);
+    MemCounters *c = &mem_stats.type[MEM_PROCESS];
+
+    assert(c->allocs == before.type[MEM_PROCESS].allocs + 2);
+    assert(c->live == before.type[MEM_PROCESS].live + 150 && mem_stats.live == before.live + 150);
+    MemStats_free(MEM_PROCESS, a, 100);
+    assert(c->frees == before.type[MEM_PROCESS].frees + 1 && c->live == before.type[MEM_PROCESS].live + 50);
+    assert(c->peak >= 150);
+
+    // una realloc libera il vecchio blocco e alloca il nuovo
+    b = MemStats_realloc(MEM_PROCESS, b, 50, 200);
+    assert(c->live == before.type[MEM_PROCESS].live + 200 && c->frees == before.type[MEM_PROCESS].frees + 2);
+    MemStats_free(MEM_PROCESS, b, 200);
+    assert(c->live == before.type[MEM_PROCESS].live && mem_stats.live == before.live);
+
+    // free di NULL non conta nulla
+    MemStats_free(MEM_PROCESS, NULL, 10);
+    assert(c->frees == before.type[MEM_PROCESS].frees + 3);
+}
+
+// Funzione di test per verificare che le slice di sched_preemption siano contate come eventi
+void test_slices(void) {
+    MemStats before = mem_stats;
+    FakePCB pcb;
+    ProcessEvent *e = (ProcessEvent *)MemStats_alloc(MEM_EVENT, sizeof(ProcessEvent));
+
+    memset(&pcb, 0, sizeof(pcb));
+    List_init(&pcb.events);
+    e->list.next = e->list.prev = 0;
+    e->type = CPU;
+    e->duration = 25;
+    List_pushBack(&pcb.events, (ListItem *)e);
+
+    // 25 ms con quanto 10: una slice, il burst piu' corto del quanto non ne crea
+    sched_preemption(&pcb, 10);
+    sched_preemption(&pcb, 100);
+    assert(mem_stats.type[MEM_SLICE].allocs == before.type[MEM_SLICE].allocs + 1);
+    assert(mem_stats.type[MEM_EVENT].allocs == before.type[MEM_EVENT].allocs + 2);
+    assert(mem_stats.type[MEM_EVENT].live == before.type[MEM_EVENT].live + 2 * (int64_t)sizeof(ProcessEvent));
+
+    while (pcb.events.first)
+        MemStats_free(MEM_EVENT, List_popFront(&pcb.events), sizeof(ProcessEvent));
+    assert(mem_stats.type[MEM_EVENT].live == before.type[MEM_EVENT].live);
+    assert(MemStats_allocs() == 2 + (before.type[MEM_EVENT].allocs + before.type[MEM_PROCESS].allocs +
+                                     before.type[MEM_PCB].allocs + before.type[MEM_PCB_KEYS].allocs +
+                                     before.type[MEM_PROCESS_STATS].allocs + before.type[MEM_SCHED_ARGS].allocs));
+}
+
+// Funzione di test per verificare che gli argomenti dello scheduler tornino a zero
+void test_schedArgs(void) {
+    FakeOS os;
+    int64_t live = mem_stats.type[MEM_SCHED_ARGS].live;
+
+    FakeOS_init(&os, 2);
+    FakeOS_setScheduler(&os, MLFQ, 10);
+    assert(mem_stats.type[MEM_SCHED_ARGS].live > live);
+    FakeOS_destroy(&os);
+    assert(mem_stats.type[MEM_SCHED_ARGS].live == live);
+}
+
+int main(int argc, char **argv) {
+    test_counters();
+    test_slices();
+    test_schedArgs();
+
+    printf("memory stats tests passed\n");
+    return 0;
+}
@@ -0,0 +1,136 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+
+#include "../include/fake_os.h"
+#include "../include/quantum_tuner.h"
+
+// Media della stima nella seconda meta' di n burst uniformi in [1, max]
+static double averageEstimate(QuantumTuner *qt, int max, int n) {
+    double sum = 0;
+
+    for (int i = 0; i < n; i++) {
+        QuantumTuner_observeBurst(qt, rand() % max + 1);
+        if (i >= n / 2)
+            sum += qt->burst_estimate;
+    }
+    return sum / (n - n / 2);
+}
+
+// Funzione di test per verificare che la stima segua il percentile dei burst, anche quando la distribuzione cambia.
+// La stima oscilla intorno al percentile (l'isteresi del quanto assorbe l'oscillazione), la sua media no
+void test_estimate(void) {
+    QuantumTuner *qt = QuantumTuner_create("80", 10, 0, TIMEBASE_MS);
+    double percentiles[] = {50, 80, 95};
+    double avg;
+
+    assert(qt);
+    // burst uniformi in [1, 400]: il p80 e' 320
+    avg = averageEstimate(qt, 400, 100000);
+    printf("p80 of U[1,400] exact: 320 estimate: %.1f\n", avg);
+    assert(avg > 320 * 0.95 && avg < 320 * 1.05);
+
+    // il carico cambia: burst uniformi in [1, 40], il p80 e' 32
+    avg = averageEstimate(qt, 40, 100000);
+    printf("p80 of U[1,40]  exact:  32 estimate: %.1f\n", avg);
+    assert(avg > 32 * 0.95 && avg < 32 * 1.05);
+    free(qt);
+
+    for (int i = 0; i < 3; i++) {
+        char spec[16];
+        snprintf(spec, sizeof(spec), "%g", percentiles[i]);
+        qt = QuantumTuner_create(spec, 10, 0, TIMEBASE_MS);
+        avg = averageEstimate(qt, 1000, 100000);
+        printf("p%-4g of U[1,1000] exact: %4.0f estimate: %.1f\n", percentiles[i], percentiles[i] * 10, avg);
+        assert(avg > percentiles[i] * 10 * 0.95 && avg < percentiles[i] * 10 * 1.05);
+        free(qt);
+    }
+}
+
+// Funzione di test per verificare limiti, isteresi e quanto passato allo scheduler RR
+void test_update(void) {
+    FakeOS os;
+    QuantumTuner *qt = QuantumTuner_create("50:5:40", 10, 0, TIMEBASE_MS);
+    SchedRRArgs *args;
+
+    FakeOS_init(&os, 1);
+    FakeOS_setScheduler(&os, RR, 10);
+    os.verbose = 0;
+    args = (SchedRRArgs *)os.schedule_args;
+
+    // nessun burst osservato: il quanto resta quello iniziale
+    QuantumTuner_update(qt, &os);
+    assert(qt->quantum == 10 && args->quantum == 10 && qt->next_update == os.timer + QT_PERIOD);
+
+    // stima dentro i limiti: il quanto la segue
+    qt->burst_estimate = 20;
+    qt->bursts = 1;
+    QuantumTuner_update(qt, &os);
+    assert(qt->quantum == 20 && args->quantum == 20 && qt->changes == 1);
+
+    // differenza sotto l'isteresi: nessun cambio
+    qt->burst_estimate = 20 * (1 + QT_HYSTERESIS) - 1;
+    QuantumTuner_update(qt, &os);
+    assert(qt->quantum == 20 && qt->changes == 1);
+
+    // stima oltre i limiti
+    qt->burst_estimate = 1000;
+    QuantumTuner_update(qt, &os);
+    assert(qt->quantum == 40 && args->quantum == 40);
+    qt->burst_estimate = 1;
+    QuantumTuner_update(qt, &os);
+    assert(qt->quantum == 5 && args->quantum == 5);
+
+    // specifiche non valide
+    assert(!QuantumTuner_create("100", 10, 0, TIMEBASE_MS));
+    assert(!QuantumTuner_create("80:10:5", 10, 0, TIMEBASE_MS));
+    assert(!QuantumTuner_create("80:5", 10, 0, TIMEBASE_MS));
+    assert(!QuantumTuner_create("80:5:40x", 10, 0, TIMEBASE_MS));
+    free(qt);
+
+    // i limiti accettano un'unita', come gli altri tempi delle opzioni
+    qt = QuantumTuner_create("80:500us:2ms", 10000, 0, Timebase_ticksPerMs("us"));
+    assert(qt && qt->min_quantum == 500 && qt->max_quantum == 2000);
+    free(qt);
+    qt = QuantumTuner_create("80:5:40", 10000, 0, Timebase_ticksPerMs("us"));
+    assert(qt && qt->min_quantum == 5000 && qt->max_quantum == 40000);
+    free(qt);
+    FakeOS_destroy(&os);
+}
+
+// Funzione di test per verificare che il feedback accorci il quanto se la risposta supera l'obiettivo e lo allunghi se e' ben sotto
+void test_feedback(void) {
+    FakeOS os;
+    QuantumTuner *qt = QuantumTuner_create("50:1:1000", 10, 100, TIMEBASE_MS);
+
+    FakeOS_init(&os, 1);
+    FakeOS_setScheduler(&os, RR, 10);
+    os.verbose = 0;
+    qt->burst_estimate = 100;
+    qt->bursts = 1;
+
+    QuantumTuner_observeResponse(qt, 500);
+    for (int i = 0; i < 5; i++)
+        QuantumTuner_update(qt, &os);
+    assert(qt->factor < 1 && qt->quantum < 100);
+
+    for (int i = 0; i < 1000; i++)
+        QuantumTuner_observeResponse(qt, 10);
+    for (int i = 0; i < 20; i++)
+        QuantumTuner_update(qt, &os);
+    assert(qt->factor > 1 && qt->factor <= QT_MAX_FACTOR && qt->quantum > 100);
+
+    free(qt);
+    FakeOS_destroy(&os);
+}
+
+int main(int argc, char **argv) {
+    srand(42);
+
+    test_estimate();
+    test_update();
+    test_feedback();
+
+    printf("quantum tuner tests passed\n");
+    return 0;
+}
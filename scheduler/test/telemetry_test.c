@@ -0,0 +1,101 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <unistd.h>
+
+#include "../include/fake_os.h"
+#include "../include/telemetry.h"
+
+static void init(FakeOS *os) {
+    FakeOS_init(os, 2);
+    FakeOS_setScheduler(os, RR, 10);
+    os->verbose = 0;
+}
+
+// Funzione di test per verificare che il lettore veda le pubblicazioni del simulatore
+void test_publish(void) {
+    FakeOS os;
+    Telemetry *t;
+    const TelemetryPage *page;
+    TelemetrySnapshot snap;
+    char name[64];
+
+    init(&os);
+    snprintf(name, sizeof(name), "/disastros_test_%d", (int)getpid());
+    assert((t = Telemetry_open(name, &os)));
+    assert((page = Telemetry_attach(name)));
+
+    // la prima pubblicazione avviene all'apertura
+    assert(Telemetry_read(page, &snap) == 0);
+    assert(snap.pid == getpid() && !snap.finished && snap.timer == 0 && snap.cores == 2);
+    assert(!strcmp(snap.scheduler, print_scheduler(RR)) && !strcmp(snap.unit, "ms"));
+    assert(snap.publications == 1 && (page->seq & 1) == 0);
+
+    os.timer = 500;
+    os.stats.completed = 3;
+    LatencyHist_record(&os.stats.response, 10);
+    LatencyHist_record(&os.stats.response, 30);
+    Telemetry_publish(t, &os);
+    assert(Telemetry_read(page, &snap) == 0);
+    assert(snap.timer == 500 && snap.completed == 3 && snap.publications == 2);
+    assert(snap.response.mean == 20.0 && snap.response.max == 30 && snap.turnaround.max == 0);
+
+    // un periodo non ancora trascorso non pubblica
+    os.timer = 600;
+    Telemetry_tick(t, &os);
+    assert(Telemetry_read(page, &snap) == 0 && snap.timer == 500);
+
+    // alla chiusura l'ultimo stato resta leggibile, il segmento non esiste piu'
+    Telemetry_close(t, &os);
+    assert(Telemetry_read(page, &snap) == 0);
+    assert(snap.finished && snap.timer == 600);
+    assert(!Telemetry_attach(name));
+    Telemetry_detach(page);
+    FakeOS_destroy(&os);
+}
+
+// Funzione di test per verificare che una lettura durante una scrittura venga scartata
+void test_torn(void) {
+    TelemetryPage page;
+    TelemetrySnapshot snap;
+
+    memset(&page, 0, sizeof(page));
+    page.snap.timer = 42;
+    assert(Telemetry_read(&page, &snap) == 0 && snap.timer == 42);
+
+    // seq dispari: il simulatore sta scrivendo, il lettore rinuncia dopo TELEMETRY_READ_TRIES tentativi
+    page.seq = 3;
+    assert(Telemetry_read(&page, &snap) < 0);
+}
+
+// Funzione di test per verificare la telemetria senza segmento, solo per SIGUSR1
+void test_dump(void) {
+    FakeOS os;
+    Telemetry *t;
+    FILE *out = tmpfile();
+    char line[256];
+    int found = 0;
+
+    init(&os);
+    assert(!Telemetry_open("no/slash/allowed", &os));
+    assert((t = Telemetry_open(NULL, &os)) && !t->page);
+    os.timer = 1234;
+    Telemetry_dump(t, &os, out);
+    rewind(out);
+    while (fgets(line, sizeof(line), out))
+        found |= !strncmp(line, "time: 1234 ms", 13);
+    assert(found);
+    fclose(out);
+    Telemetry_close(t, &os);
+    FakeOS_destroy(&os);
+}
+
+int main(int argc, char **argv) {
+    test_publish();
+    test_torn();
+    test_dump();
+
+    printf("telemetry tests passed\n");
+    return 0;
+}
@@ -0,0 +1,69 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "../include/timebase.h"
+
+// Funzione di test per verificare le unita' del timebase
+void test_units(void) {
+    assert(Timebase_ticksPerMs("ms") == 1);
+    assert(Timebase_ticksPerMs("us") == 1000);
+    assert(Timebase_ticksPerMs("ns") == 1000000);
+    assert(Timebase_ticksPerMs("s") == -1);
+    assert(!strcmp(Timebase_unit(TIMEBASE_MS), "ms") && !strcmp(Timebase_unit(1000), "us"));
+}
+
+// Funzione di test per verificare la conversione dei tempi delle tracce in tick
+void test_fromNs(void) {
+    // arrotonda al tick piu' vicino
+    assert(Timebase_fromNs(1, 10 * NS_PER_MS) == 10);
+    assert(Timebase_fromNs(1, 1499999) == 1 && Timebase_fromNs(1, 1500000) == 2);
+    assert(Timebase_fromNs(1000, 250000) == 250);
+    assert(Timebase_fromNs(NS_PER_MS, 7) == 7);
+
+    // un burst piu' corto del tick dura comunque un tick, uno nullo resta nullo
+    assert(Timebase_fromNs(1, 1) == 1 && Timebase_fromNs(1000, 400) == 1);
+    assert(Timebase_fromNs(1, 0) == 0);
+
+    // un mese in ns sta in 64 bit
+    assert(Timebase_fromNs(NS_PER_MS, 30LL * 24 * 3600 * 1000 * NS_PER_MS) == 30LL * 24 * 3600 * 1000 * NS_PER_MS);
+}
+
+// Funzione di test per verificare il parsing e la scrittura dei tempi delle opzioni
+void test_parse(void) {
+    SimTime ticks;
+    char buf[32];
+
+    // senza unita' il tempo e' in ms
+    assert(Timebase_parse(1, "10", &ticks) == 0 && ticks == 10);
+    assert(Timebase_parse(1000, "10", &ticks) == 0 && ticks == 10000);
+    assert(Timebase_parse(1000, "250us", &ticks) == 0 && ticks == 250);
+    assert(Timebase_parse(1000, "1.5ms", &ticks) == 0 && ticks == 1500);
+    assert(Timebase_parse(1, "2s", &ticks) == 0 && ticks == 2000);
+    assert(Timebase_parse(NS_PER_MS, "3ns ", &ticks) == 0 && ticks == 3);
+
+    assert(Timebase_parse(1, "", &ticks) < 0);
+    assert(Timebase_parse(1, "-5", &ticks) < 0);
+    assert(Timebase_parse(1, "10x", &ticks) < 0);
+    assert(Timebase_parse(1, "10 ms", &ticks) < 0);
+    assert(Timebase_parse(1, "10msec", &ticks) < 0);
+
+    // i ms interi restano come prima, il resto prende l'unita'
+    Timebase_format(buf, sizeof(buf), 1, 20);
+    assert(!strcmp(buf, "20"));
+    Timebase_format(buf, sizeof(buf), 1000, 500);
+    assert(!strcmp(buf, "500us"));
+    Timebase_format(buf, sizeof(buf), NS_PER_MS, 1500);
+    assert(!strcmp(buf, "1500ns"));
+    assert(Timebase_parse(NS_PER_MS, buf, &ticks) == 0 && ticks == 1500);
+}
+
+int main(int argc, char **argv) {
+    test_units();
+    test_fromNs();
+    test_parse();
+
+    printf("timebase tests passed\n");
+    return 0;
+}
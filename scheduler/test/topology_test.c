@@ -0,0 +1,102 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+
+#include "../include/fake_os.h"
+#include "../include/topology.h"
+
+static void init(FakeOS *os, const char *spec) {
+    FakeOS_init(os, 4);
+    FakeOS_setScheduler(os, RR, 10);
+    os->verbose = 0;
+    assert(FakeOS_setTopology(os, spec) == 0);
+    assert(os->capacity);
+}
+
+static void clear(FakeOS *os) {
+    for (int i = 0; i < os->cores; i++)
+        os->running[i] = 0;
+    FakeOS_destroy(os);
+}
+
+// Funzione di test per verificare il parsing della topologia
+void test_create(void) {
+    Topology *topo = Topology_create("2x2x2x2:1.8:50", 16, TIMEBASE_MS);
+
+    assert(topo && topo->nodes == 4 && topo->smt == 2);
+    assert(topo->penalty == 1.8 && topo->balance_period == 50);
+    assert(Topology_node(topo, 3) == 0 && Topology_node(topo, 4) == 1 && Topology_node(topo, 15) == 3);
+    free(topo);
+
+    assert(!Topology_create("2x1x8", 8, TIMEBASE_MS));
+    assert(!Topology_create("2x1", 2, TIMEBASE_MS));
+    assert(!Topology_create("2x1x2:0.5", 4, TIMEBASE_MS));
+    assert(!Topology_create("2x1x2x", 4, TIMEBASE_MS));
+    assert(!Topology_create("2x1x2:1.5:50x", 4, TIMEBASE_MS));
+
+    // il periodo di bilanciamento accetta un'unita', in tick del timebase
+    topo = Topology_create("2x1x2:1.5:500us", 4, Timebase_ticksPerMs("us"));
+    assert(topo && topo->balance_period == 500 && topo->next_balance == 500);
+    free(topo);
+    topo = Topology_create("2x1x2", 4, Timebase_ticksPerMs("us"));
+    assert(topo && topo->balance_period == TOPO_BALANCE_PERIOD * 1000);
+    free(topo);
+}
+
+// Funzione di test per verificare il piazzamento: primo tocco, nodo di casa e scambio
+void test_place(void) {
+    FakeOS os;
+    FakePCB a = {.home_node = -1}, b = {.home_node = 1}, p = {.home_node = 1}, q = {.home_node = 0}, d = {.home_node = 0};
+
+    init(&os, "2x1x2");
+    // il primo processo sceglie il nodo e ci resta legato
+    assert(Topology_place(os.topology, &os, &a) == 0 && a.home_node == 0);
+    os.running[0] = &a;
+    // un nuovo processo va sul nodo con piu' core liberi
+    a.home_node = -1;
+    assert(Topology_place(os.topology, &os, &a) == 2 && a.home_node == 1);
+    assert(Topology_place(os.topology, &os, &b) == 2);
+
+    // lontano da casa scambia con chi sul suo nodo ha casa sul core libero
+    os.running[0] = &p;
+    os.running[1] = &q;
+    os.running[2] = &b;
+    assert(Topology_place(os.topology, &os, &d) == 0);
+    assert(os.running[3] == &p && !os.running[0] && os.topology->migrations == 1);
+    clear(&os);
+}
+
+// Funzione di test per verificare il rallentamento remoto e il bilanciamento
+void test_tick(void) {
+    FakeOS os;
+    FakePCB p = {.home_node = 1}, r = {.home_node = 1};
+
+    init(&os, "2x1x2:2:0");
+    os.running[0] = &p;
+    Topology_tick(os.topology, &os);
+    assert(os.capacity->scale[0] == 0.5 && os.capacity->scale[1] == 1.0);
+    assert(os.topology->remote_ticks[0] == 1);
+    os.running[0] = 0;
+    FakeOS_destroy(&os);
+
+    init(&os, "2x1x2x1:2:1");
+    os.running[0] = &p;
+    os.running[2] = &r;
+    os.running[3] = &r;
+    os.timer = 1;
+    // nessun core libero a casa: dopo TOPO_MEMORY_PASSES passate la memoria si sposta
+    for (int i = 0; i < TOPO_MEMORY_PASSES; i++, os.timer++)
+        Topology_tick(os.topology, &os);
+    assert(p.home_node == 0 && os.topology->memory_migrations == 1);
+    assert(os.running[0] == &p && os.capacity->scale[0] == 1.0);
+    clear(&os);
+}
+
+int main(int argc, char **argv) {
+    test_create();
+    test_place();
+    test_tick();
+
+    printf("topology tests passed\n");
+    return 0;
+}
@@ -0,0 +1,104 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <getopt.h>
+#include <signal.h>
+#include <time.h>
+
+#include "../include/telemetry.h"
+
+/*
+ * Reader of the live telemetry of a simulation (disastros --telemetry <name>): it maps the
+ * shared memory segment read only and prints the last snapshot published, or streams one row
+ * per period until the simulation is over. The simulator never waits for it.
+ */
+
+#define MAX_FOLLOW_ROWS 20 // rows between two headers
+
+static char usage_buffer[] = "Usage: %s [options] <name> \n\
+\n\
+<name>: the segment of the simulation, as given to disastros --telemetry \n\
+\n\
+Options: \n\
+	--follow <ms>: print a row every <ms> until the simulation is over \n\
+\n";
+
+static void sleepMs(int ms)
+{
+	struct timespec ts = {ms / 1000, (ms % 1000) * 1000000L};
+
+	while (nanosleep(&ts, &ts) < 0 && errno == EINTR)
+		;
+}
+
+int main(int argc, char **argv)
+{
+	const TelemetryPage *page;
+	TelemetrySnapshot snap;
+	int follow = 0;
+	int opt;
+
+	static struct option long_options[] = {
+		{"follow", required_argument, 0, 'f'},
+		{0, 0, 0, 0}
+	};
+
+	while ((opt = getopt_long(argc, argv, "f:", long_options, NULL)) != -1)
+	{
+		switch (opt)
+		{
+		case 'f':
+			follow = atoi(optarg);
+			if (follow < 1)
+			{
+				printf(usage_buffer, argv[0]);
+				return 1;
+			}
+			break;
+		default:
+			printf(usage_buffer, argv[0]);
+			return 1;
+		}
+	}
+	if (argc - optind != 1)
+	{
+		printf(usage_buffer, argv[0]);
+		return 1;
+	}
+
+	if (!(page = Telemetry_attach(argv[optind])))
+	{
+		printf("No simulation publishes %s\n", argv[optind]);
+		return 1;
+	}
+	if (Telemetry_read(page, &snap) < 0)
+	{
+		printf("Could not read %s\n", argv[optind]);
+		Telemetry_detach(page);
+		return 1;
+	}
+	if (!follow)
+	{
+		Telemetry_print(&snap, stdout);
+		Telemetry_detach(page);
+		return 0;
+	}
+
+	// the segment outlives a simulation killed by SIGKILL: stop when its pid is gone
+	for (int rows = 0;; rows++)
+	{
+		Telemetry_printRow(&snap, stdout, rows % MAX_FOLLOW_ROWS == 0);
+		fflush(stdout);
+		if (snap.finished || (kill(snap.pid, 0) < 0 && errno == ESRCH))
+			break;
+		sleepMs(follow);
+		if (Telemetry_read(page, &snap) < 0)
+		{
+			printf("Could not read %s\n", argv[optind]);
+			Telemetry_detach(page);
+			return 1;
+		}
+	}
+	Telemetry_detach(page);
+	return 0;
+}